@@ -4,7 +4,7 @@
 #include <cmath>
 #include <cstring>
 
-#include "Oscillator.h"
+#include "WavetableOscillator.h"
 
 using namespace iplug;
 
@@ -21,37 +21,34 @@ public:
       std::memset(outputs[i], 0, nFrames * sizeof(T));
     }
 
-    if (!HasActiveVoices())
+    if (nOutputs < 1)
       return;
 
+    // Released voices ramp down over the next block, and silent voices are skipped
+    mOscBank.ProcessBlock(outputs[0], nFrames);
+
     const T gain = mGain;
 
     for (int s = 0; s < nFrames; ++s)
     {
-      T sample = static_cast<T>(0.0);
-
-      for (auto& voice : mVoices)
-      {
-        if (!voice.active)
-          continue;
-
-        sample += static_cast<T>(voice.osc.Process(voice.frequency)) * voice.level;
-      }
-
-      sample *= gain;
+      outputs[0][s] *= gain;
+    }
 
-      for (int ch = 0; ch < nOutputs; ++ch)
-      {
-        outputs[ch][s] += sample;
-      }
+    for (int ch = 1; ch < nOutputs; ++ch)
+    {
+      std::memcpy(outputs[ch], outputs[0], nFrames * sizeof(T));
     }
   }
 
   void Reset(double sampleRate, int /*blockSize*/)
   {
-    for (auto& voice : mVoices)
+    mOscBank.SetSampleRate(sampleRate);
+
+    for (int i = 0; i < kMaxVoices; ++i)
     {
-      voice.Reset(sampleRate);
+      mVoices[i].Reset();
+      mOscBank.SetGain(i, static_cast<T>(0.0));
+      mOscBank.Reset(i);
     }
 
     mGain = static_cast<T>(0.8);
@@ -102,16 +99,13 @@ private:
 
   struct Voice
   {
-    FastSinOscillator<T> osc;
     T level = static_cast<T>(0.0);
     double frequency = 0.0;
     bool active = false;
     int noteNumber = -1;
 
-    void Reset(double sampleRate)
+    void Reset()
     {
-      osc.SetSampleRate(sampleRate);
-      osc.Reset();
       level = static_cast<T>(0.0);
       frequency = 0.0;
       active = false;
@@ -120,20 +114,10 @@ private:
   };
 
   std::array<Voice, kMaxVoices> mVoices;
+  WavetableOscillatorBank<T> mOscBank {kMaxVoices}; // one sine oscillator per voice
   T mGain = static_cast<T>(0.8);
   int mNextVoice = 0;
 
-  bool HasActiveVoices() const
-  {
-    for (const auto& voice : mVoices)
-    {
-      if (voice.active)
-        return true;
-    }
-
-    return false;
-  }
-
   int FindVoiceByNote(int noteNumber) const
   {
     for (int i = 0; i < kMaxVoices; ++i)
@@ -172,7 +156,9 @@ private:
     voice.level = level;
     voice.noteNumber = noteNumber;
     voice.active = true;
-    voice.osc.Reset();
+    mOscBank.SetFreqCPS(voiceIndex, frequency);
+    mOscBank.SetGain(voiceIndex, level);
+    mOscBank.Reset(voiceIndex);
   }
 
   void ReleaseVoice(int noteNumber)
@@ -186,5 +172,6 @@ private:
     voice.active = false;
     voice.level = static_cast<T>(0.0);
     voice.noteNumber = -1;
+    mOscBank.SetGain(voiceIndex, static_cast<T>(0.0));
   }
 };
@@ -13,32 +13,27 @@ void IPlugConvoEngine::ProcessBlock(sample** inputs, sample** outputs, int nFram
 {
   sample* inputL = inputs[0];
   sample* outputL = outputs[0];
-  
-  mEngine.Add(inputs, nFrames, 1);
-
-  int nAvailableSamples = std::min(mEngine.Avail(nFrames), nFrames);
 
   const sample dryGain = GetParam(kParamDry)->Value();
   const sample wetGain = GetParam(kParamWet)->Value();
 
-  // If not enough samples are available yet, then only output the dry signal
-  for (auto i = 0; i < nFrames - nAvailableSamples; ++i)
-  {
-    *outputL++ = dryGain * *inputL++;
-  }
+  // mWet is allocated in OnReset(), so process in chunks of its size rather than resizing it here.
+  // The wet signal is silent until the first impulse has been loaded
+  const int wetSize = mWet.GetSize();
 
-  // Output samples from the convolution engine
-  if (nAvailableSamples > 0)
+  for (auto offset = 0; offset < nFrames && wetSize > 0; offset += wetSize)
   {
+    const int n = std::min(nFrames - offset, wetSize);
+    sample* pIn = inputL + offset;
+    sample* pWet = mWet.Get();
+
+    mLoader.ProcessBlock(&pIn, &pWet, 1, n);
+
     // Apply the dry/wet mix
-    WDL_FFT_REAL* pWetSignal = mEngine.Get()[0];
-    for (auto i = 0; i < nAvailableSamples; ++i)
+    for (auto i = 0; i < n; ++i)
     {
-      *outputL++ = dryGain * *inputL++ + wetGain * *pWetSignal++;
+      *outputL++ = dryGain * *pIn++ + wetGain * *pWet++;
     }
-
-    // Remove the sample block from the convolution engine's buffer
-    mEngine.Advance(nAvailableSamples);
   }
 }
 
@@ -66,11 +61,18 @@ void IPlugConvoEngine::OnReset()
       Resample(mIR, irLength, irSampleRate, mImpulse.impulses[0].Get(), len, mSampleRate);
     }
     
-    // Tie the impulse response to the convolution engine.
-    mEngine.SetImpulse(&mImpulse);
-    
-    SetLatency(mEngine.GetLatency());
+    // Prepare a convolution engine for the impulse response on the loader's thread. The audio thread crossfades to it once it is ready,
+    // and the latency is reported in OnIdle(). The loader keeps the latency of the previous engine if the new one needs less, so that the crossfade is aligned
+    mLoader.LoadImpulse(mImpulse, 1, GetBlockSize());
   }
+
+  mWet.Resize(GetBlockSize());
+}
+
+void IPlugConvoEngine::OnIdle()
+{
+  if (mLoader.GetLatency() != GetLatency())
+    SetLatency(mLoader.GetLatency());
 }
 
 template <class I, class O>
@@ -10,6 +10,7 @@
 #endif
 
 #include "convoengine.h"
+#include "ImpulseLoader.h"
 
 #if defined USE_WDL_RESAMPLER
   #include "resample.h"
@@ -37,6 +38,7 @@ public:
 #if IPLUG_DSP // http://bit.ly/2S64BDd
   void ProcessBlock(sample** inputs, sample** outputs, int nFrames) override;
   void OnReset() override;
+  void OnIdle() override;
 private:
   // Returns destination length
   inline int ResampleLength(int srcLength, double srcRate, double destRate) const
@@ -49,8 +51,10 @@ private:
   static const float mIR[512];
 
   WDL_ImpulseBuffer mImpulse;
-//  WDL_ConvolutionEngine_Div mEngine; // < low latency version
-  WDL_ConvolutionEngine mEngine;
+  // Prepares the engine on a worker thread, and crossfades to it when the impulse changes
+//  ImpulseLoader<WDL_ConvolutionEngine_Div> mLoader; // < low latency version
+  ImpulseLoader<WDL_ConvolutionEngine> mLoader;
+  WDL_TypedBuf<sample> mWet;
   
   static constexpr int mBlockLength = 64;
 
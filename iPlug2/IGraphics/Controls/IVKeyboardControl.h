@@ -437,7 +437,7 @@ public:
     float r = h / mRECT.H();
     mRECT.B = mRECT.T + mRECT.H() * r;
 
-    mTargetRECT = mRECT;
+    SetTargetRECT(mRECT);
 
     if (keepAspectRatio)
       SetWidth(mRECT.W() * r);
@@ -457,7 +457,7 @@ public:
       *pKeyL = mRECT.L + d * r;
     }
 
-    mTargetRECT = mRECT;
+    SetTargetRECT(mRECT);
 
     if (keepAspectRatio)
       SetHeight(mRECT.H() * r);
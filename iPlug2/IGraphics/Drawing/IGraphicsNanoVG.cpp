@@ -277,7 +277,7 @@ IBitmap IGraphicsNanoVG::LoadBitmap(const char* name, int nStates, bool framesAr
 
   // NanoVG does not use the global static cache, since bitmaps are textures linked to a context
   StaticStorage<APIBitmap>::Accessor storage(mBitmapCache);
-  APIBitmap* pAPIBitmap = storage.Find(name, targetScale);
+  APIBitmap* pAPIBitmap = storage.FindUnretained(name, targetScale);
   
   // If the bitmap is not already cached at the targetScale
   if (!pAPIBitmap)
@@ -349,7 +349,7 @@ APIBitmap* IGraphicsNanoVG::LoadAPIBitmap(const char* fileNameOrResID, int scale
 APIBitmap* IGraphicsNanoVG::LoadAPIBitmap(const char* name, const void* pData, int dataSize, int scale)
 {
   StaticStorage<APIBitmap>::Accessor storage(mBitmapCache);
-  APIBitmap* pBitmap = storage.Find(name, scale);
+  APIBitmap* pBitmap = storage.FindUnretained(name, scale);
 
   if (!pBitmap)
   {
@@ -741,7 +741,7 @@ void IGraphicsNanoVG::PathFill(const IPattern& pattern, const IFillOptions& opti
 bool IGraphicsNanoVG::LoadAPIFont(const char* fontID, const PlatformFontPtr& font)
 {
   StaticStorage<IFontData>::Accessor storage(sFontCache);
-  IFontData* cached = storage.Find(fontID);
+  IFontData* cached = storage.FindUnretained(fontID);
     
   if (cached)
   {
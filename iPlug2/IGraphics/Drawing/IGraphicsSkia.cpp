@@ -63,7 +63,8 @@
     #pragma comment(lib, "skunicode_icu.lib")
   #endif
 
-
+#elif defined OS_LINUX
+  #include "include/ports/SkFontMgr_fontconfig.h"
 #endif
 
 #if defined IGRAPHICS_GL
@@ -301,6 +302,8 @@ static sk_sp<SkFontMgr> SFontMgrFactory()
   return SkFontMgr_New_CoreText(nullptr);
 #elif defined OS_WIN
   return SkFontMgr_New_DirectWrite();
+#elif defined OS_LINUX
+  return SkFontMgr_New_FontConfig(nullptr);
 #else
   #error "Not supported"
 #endif
@@ -567,6 +570,8 @@ void IGraphicsSkia::EndFrame()
     StretchDIBits(hdc, 0, 0, w, h, 0, 0, w, h, bmpInfo->bmiColors, bmpInfo, DIB_RGB_COLORS, SRCCOPY);
     ReleaseDC(hWnd, hdc);
     EndPaint(hWnd, &ps);
+  #elif defined OS_LINUX
+    // Headless, the frame stays in mSurface until it is read back
   #else
     #error NOT IMPLEMENTED
   #endif
@@ -663,7 +668,7 @@ IColor IGraphicsSkia::GetPoint(int x, int y)
 bool IGraphicsSkia::LoadAPIFont(const char* fontID, const PlatformFontPtr& font)
 {
   StaticStorage<Font>::Accessor storage(sFontCache);
-  Font* cached = storage.Find(fontID);
+  Font* cached = storage.FindUnretained(fontID);
   
   if (cached)
     return true;
@@ -691,7 +696,7 @@ void IGraphicsSkia::PrepareAndMeasureText(const IText& text, const char* str, IR
   //SkRect bounds;
   
   StaticStorage<Font>::Accessor storage(sFontCache);
-  Font* pFont = storage.Find(text.mFont);
+  Font* pFont = storage.FindUnretained(text.mFont);
   
   assert(pFont && "No font found - did you forget to load it?");
 
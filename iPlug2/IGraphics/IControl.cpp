@@ -202,6 +202,10 @@ void IControl::SetDirty(bool triggerAction, int valIdx)
   auto setValue = [this](int v) { SetValue(Clip(GetValue(v), 0.0, 1.0), v); };
   ForValIdx(valIdx, setValue);
   
+  // N.B. a tracked control that is already dirty has already been registered
+  if (mTracked && !mDirty)
+    mGraphics->AddDirtyControl(this);
+  
   mDirty = true;
   
   if (triggerAction)
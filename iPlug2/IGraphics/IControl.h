@@ -317,7 +317,7 @@ public:
 
   /** Set the rectangular draw area for this control, within the graphics context
    * @param bounds The control's bounds */
-  void SetRECT(const IRECT& bounds) { mRECT = bounds; mMouseIsOver = false; OnResize(); }
+  void SetRECT(const IRECT& bounds) { mRECT = bounds; mMouseIsOver = false; OnBoundsChanged(); OnResize(); }
   
   /** Get the rectangular mouse tracking target area, within the graphics context for this control
    * @return The control's target bounds within the graphics context */
@@ -325,11 +325,11 @@ public:
 
   /** Set the rectangular mouse tracking target area, within the graphics context for this control
    * @param bounds The control's new target bounds within the graphics context */
-  void SetTargetRECT(const IRECT& bounds) { mTargetRECT = bounds; mMouseIsOver = false; }
+  void SetTargetRECT(const IRECT& bounds) { mTargetRECT = bounds; mMouseIsOver = false; OnBoundsChanged(); }
   
   /** Set BOTH the draw rect and the target area, within the graphics context for this control
    * @param bounds The control's new draw and target bounds within the graphics context */
-  void SetTargetAndDrawRECTs(const IRECT& bounds) { mRECT = mTargetRECT = bounds; mMouseIsOver = false; OnResize(); }
+  void SetTargetAndDrawRECTs(const IRECT& bounds) { mRECT = mTargetRECT = bounds; mMouseIsOver = false; OnBoundsChanged(); OnResize(); }
 
   /** Set the position of the control, preserving the width and height. This may need to be overriden if you maintain custom positioning data in your control
    * @param x the new x coordinate of the top left corner of the control
@@ -396,7 +396,7 @@ public:
   /** Hit test the control. Override this method if you want the control to be hit only if a visible part of it is hit, or whatever.
    * @param x The X coordinate within the control to test 
    * @param y The y coordinate within the control to test
-   * @return \c Return true if the control was hit. */
+   * @return \c Return true if the control was hit. N.B. IGraphics only hit tests controls whose draw or target area is near the point, so this must not return true outside them */
   virtual bool IsHit(float x, float y) const { return mTargetRECT.Contains(x, y); }
 
   /** Mark the control as dirty, i.e. it should be redrawn on the next display refresh
@@ -437,6 +437,16 @@ public:
   /** @return /c true if this control supports multiple touches */
   bool GetWantsMultiTouch() const { return mWantsMultiTouch; }
   
+  /** Specify whether this control reports itself dirty by overriding IsDirty(), rather than by calling SetDirty().
+   * Such controls are polled at each display refresh when IGraphics::EnableDirtyTracking() is on. Call this before the control is attached */
+  void SetWantsDirtyPolling(bool enable = true) { mWantsDirtyPolling = enable; }
+  
+  /** @return /c true if this control needs to be polled for IsDirty() when dirty tracking is enabled */
+  bool GetWantsDirtyPolling() const { return mWantsDirtyPolling; }
+  
+  /** Used internally by IGraphics when dirty tracking is enabled, to make a standard control register itself when it becomes dirty or starts animating */
+  void SetTracked(bool tracked) { mTracked = tracked; }
+  
   /** Add a IGestureFunc that should be triggered in response to a certain type of gesture
    * @param type The type of gesture to recognize on this control
    * @param func the function to trigger */
@@ -494,12 +504,12 @@ public:
   
   /** Set the animation function
    * @param func A std::function conforming to IAnimationFunction */
-  void SetAnimation(IAnimationFunction func) { mAnimationFunc = func;}
+  void SetAnimation(IAnimationFunction func) { mAnimationFunc = func; OnAnimationChanged(); }
   
   /** Set the animation function and starts it
    * @param func A std::function conforming to IAnimationFunction
    * @param duration Duration in milliseconds for the animation */
-  void SetAnimation(IAnimationFunction func, int duration) { mAnimationFunc = func; StartAnimation(duration); }
+  void SetAnimation(IAnimationFunction func, int duration) { mAnimationFunc = func; OnAnimationChanged(); StartAnimation(duration); }
 
   /** Get the control's animation function, if it exists */
   IAnimationFunction GetAnimationFunction() { return mAnimationFunc; }
@@ -560,6 +570,7 @@ protected:
   bool mIgnoreMouse = false;
   bool mWantsMidi = false;
   bool mWantsMultiTouch = false;
+  bool mWantsDirtyPolling = false;
   bool mPromptShowsParamLabel = false;
   /** if mGraphics::mHandleMouseOver = true, this will be true when the mouse is over control. If you need finer grained control of mouseovers, you can override OnMouseOver() and OnMouseOut() */
   bool mMouseIsOver = false;
@@ -583,6 +594,18 @@ protected:
 #endif
   
 private:
+  void OnBoundsChanged()
+  {
+    if (mGraphics)
+      mGraphics->InvalidateControlIndex();
+  }
+  
+  void OnAnimationChanged()
+  {
+    if (mTracked && mAnimationFunc)
+      mGraphics->AddAnimatingControl(this);
+  }
+  
   IContainerBase* mParent = nullptr;
   IGEditorDelegate* mDelegate = nullptr;
   IGraphics* mGraphics = nullptr;
@@ -594,6 +617,7 @@ private:
   std::vector<ParamTuple> mVals { {kNoParameter, 0.} };
   std::unordered_map<EGestureType, IGestureFunc> mGestureFuncs;
   EGestureType mLastGesture = EGestureType::Unknown;
+  bool mTracked = false;
 };
 
 #pragma mark - Base Controls
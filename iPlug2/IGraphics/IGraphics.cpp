@@ -67,11 +67,56 @@ IGraphics::~IGraphics()
   RemoveAllControls();
     
   StaticStorage<APIBitmap>::Accessor bitmapStorage(sBitmapCache);
+  for (auto* pBitmap : mUsedBitmaps)
+    bitmapStorage.ReleaseData(pBitmap);
   bitmapStorage.Release();
   StaticStorage<SVGHolder>::Accessor svgStorage(sSVGCache);
+  for (auto* pHolder : mUsedSVGs)
+    svgStorage.ReleaseData(pHolder);
   svgStorage.Release();
 }
 
+//static
+void IGraphics::GetImageCacheStats(StaticStorageStats& bitmapStats, StaticStorageStats& svgStats)
+{
+  bitmapStats = StaticStorage<APIBitmap>::Accessor(sBitmapCache).GetStats();
+  svgStats = StaticStorage<SVGHolder>::Accessor(sSVGCache).GetStats();
+}
+
+//static
+void IGraphics::SetMaxUnusedImageCacheEntries(int maxUnused)
+{
+  StaticStorage<APIBitmap>::Accessor(sBitmapCache).SetMaxUnused(maxUnused);
+  StaticStorage<SVGHolder>::Accessor(sSVGCache).SetMaxUnused(maxUnused);
+}
+
+void IGraphics::UseCachedBitmap(APIBitmap* pBitmap, bool retained)
+{
+  if (!pBitmap)
+    return;
+  
+  // This editor holds one reference to each bitmap it uses
+  const bool firstUse = mUsedBitmaps.insert(pBitmap).second;
+  
+  if (firstUse && !retained)
+    StaticStorage<APIBitmap>::Accessor(sBitmapCache).RetainData(pBitmap);
+  else if (!firstUse && retained)
+    StaticStorage<APIBitmap>::Accessor(sBitmapCache).ReleaseData(pBitmap);
+}
+
+void IGraphics::UseCachedSVG(SVGHolder* pHolder, bool retained)
+{
+  if (!pHolder)
+    return;
+  
+  const bool firstUse = mUsedSVGs.insert(pHolder).second;
+  
+  if (firstUse && !retained)
+    StaticStorage<SVGHolder>::Accessor(sSVGCache).RetainData(pHolder);
+  else if (!firstUse && retained)
+    StaticStorage<SVGHolder>::Accessor(sSVGCache).ReleaseData(pHolder);
+}
+
 void IGraphics::SetScreenScale(float scale)
 {
   mScreenScale = scale;
@@ -101,6 +146,7 @@ void IGraphics::Resize(int w, int h, float scale, bool needsPlatformResize)
   mDrawScale = scale;
   mWidth = w;
   mHeight = h;
+  mControlIndexStale = true;
   
   if (mCornerResizer)
     mCornerResizer->OnRescale();
@@ -131,7 +177,12 @@ void IGraphics::SetScaleConstraints(float lo, float hi)
 
 void IGraphics::RemoveControlWithTag(int ctrlTag)
 {
-  mControls.DeletePtr(GetControlWithTag(ctrlTag), true);
+  IControl* pControl = GetControlWithTag(ctrlTag);
+  
+  if (pControl)
+    UntrackControl(pControl);
+  
+  mControls.DeletePtr(pControl, true);
   mCtrlTags.erase(ctrlTag);
   SetAllControlsDirty();
 }
@@ -158,6 +209,7 @@ void IGraphics::RemoveControls(int fromIdx)
     if(pControl->GetTag() > kNoTag)
       mCtrlTags.erase(pControl->GetTag());
     
+    UntrackControl(pControl);
     mControls.Delete(idx--, true);
   }
   
@@ -186,6 +238,7 @@ void IGraphics::RemoveControl(IControl* pControl)
   if(pControl->GetTag() > kNoTag)
     mCtrlTags.erase(pControl->GetTag());
   
+  UntrackControl(pControl);
   mControls.DeletePtr(pControl, true);
   
   SetAllControlsDirty();
@@ -208,6 +261,10 @@ void IGraphics::RemoveAllControls()
   mBubbleControls.Empty(true);
   
   mCtrlTags.clear();
+  mDirtyControls.clear();
+  mAnimatingControls.clear();
+  mPolledControls.clear();
+  mControlIndexStale = true;
   mControls.Empty(true);
 }
 
@@ -290,6 +347,7 @@ void IGraphics::AttachBackground(const char* fileName)
   IControl* pBG = new IBitmapControl(0, 0, LoadBitmap(fileName, 1, false), kNoParameter, EBlend::Default);
   pBG->SetDelegate(*GetDelegate());
   mControls.Insert(0, pBG);
+  TrackControl(pBG);
 }
 
 void IGraphics::AttachSVGBackground(const char* fileName)
@@ -297,6 +355,7 @@ void IGraphics::AttachSVGBackground(const char* fileName)
   IControl* pBG = new ISVGControl(GetBounds(), LoadSVG(fileName), true);
   pBG->SetDelegate(*GetDelegate());
   mControls.Insert(0, pBG);
+  TrackControl(pBG);
 }
 
 void IGraphics::AttachPanelBackground(const IPattern& color)
@@ -304,6 +363,7 @@ void IGraphics::AttachPanelBackground(const IPattern& color)
   IControl* pBG = new IPanelControl(GetBounds(), color);
   pBG->SetDelegate(*GetDelegate());
   mControls.Insert(0, pBG);
+  TrackControl(pBG);
 }
 
 IControl* IGraphics::AttachControl(IControl* pControl, int ctrlTag, const char* group)
@@ -320,6 +380,7 @@ IControl* IGraphics::AttachControl(IControl* pControl, int ctrlTag, const char*
   pControl->SetDelegate(*GetDelegate());
   pControl->SetGroup(group);
   mControls.Add(pControl);
+  TrackControl(pControl);
     
   pControl->OnAttached();
   return pControl;
@@ -553,7 +614,11 @@ void IGraphics::ForStandardControlsFunc(IControlFunction func)
 void IGraphics::ForAllControlsFunc(IControlFunction func)
 {
   ForStandardControlsFunc(func);
-  
+  ForSpecialControlsFunc(func);
+}
+
+void IGraphics::ForSpecialControlsFunc(IControlFunction func)
+{
   if (mPerfDisplay)
     func(mPerfDisplay.get());
   
@@ -599,7 +664,95 @@ void IGraphics::SetAllControlsDirty()
 
 void IGraphics::SetAllControlsClean()
 {
-  ForAllControls(&IControl::SetClean);
+  if (mDirtyTracking)
+  {
+    for (auto* pControl : mDirtyControls)
+      pControl->SetClean();
+    
+    for (auto* pControl : mAnimatingControls)
+      pControl->SetClean();
+    
+    for (auto* pControl : mPolledControls)
+      pControl->SetClean();
+    
+    ForSpecialControlsFunc([](IControl* pControl) { pControl->SetClean(); });
+    mDirtyControls.clear();
+  }
+  else
+    ForAllControls(&IControl::SetClean);
+}
+
+void IGraphics::EnableDirtyTracking(bool enable)
+{
+  mDirtyTracking = enable;
+  mDirtyControls.clear();
+  mAnimatingControls.clear();
+  mPolledControls.clear();
+  mControlIndexStale = true;
+  
+  ForStandardControlsFunc([this](IControl* pControl) {
+    pControl->SetTracked(false);
+    TrackControl(pControl);
+  });
+}
+
+void IGraphics::AddAnimatingControl(IControl* pControl)
+{
+  if (std::find(mAnimatingControls.begin(), mAnimatingControls.end(), pControl) == mAnimatingControls.end())
+    mAnimatingControls.push_back(pControl);
+}
+
+void IGraphics::TrackControl(IControl* pControl)
+{
+  mControlIndexStale = true;
+  
+  if (!mDirtyTracking)
+    return;
+  
+  pControl->SetTracked(true);
+  
+  // N.B. controls are dirty when they are attached, and may have been marked dirty before tracking was enabled
+  mDirtyControls.push_back(pControl);
+  
+  if (pControl->GetWantsDirtyPolling())
+    mPolledControls.push_back(pControl);
+  
+  if (pControl->GetAnimationFunction())
+    AddAnimatingControl(pControl);
+}
+
+void IGraphics::UntrackControl(IControl* pControl)
+{
+  mControlIndexStale = true;
+  
+  if (!mDirtyTracking)
+    return;
+  
+  auto erase = [pControl](std::vector<IControl*>& list) {
+    list.erase(std::remove(list.begin(), list.end(), pControl), list.end());
+  };
+  
+  erase(mDirtyControls);
+  erase(mAnimatingControls);
+  erase(mPolledControls);
+}
+
+void IGraphics::UpdateControlIndex()
+{
+  if (!mControlIndexStale)
+    return;
+  
+  mControlIndex.Reset(GetBounds(), NControls());
+  
+  for (auto c = 0; c < NControls(); c++)
+  {
+    const IControl* pControl = GetControl(c);
+    
+    // N.B. padding covers the outline padding and pixel alignment in DrawControl()
+    mControlIndex.Add(c, pControl->GetRECT().Union(pControl->GetTargetRECT()).GetPadded(2.f));
+  }
+  
+  mControlIndexStale = false;
 }
 
 void IGraphics::AssignParamNameToolTips()
@@ -840,7 +993,19 @@ bool IGraphics::IsDirty(IRECTList& rects)
   if (mDisplayTickFunc)
     mDisplayTickFunc();
 
-  ForAllControlsFunc([](IControl* pControl) { pControl->Animate(); } );
+  if (mDirtyTracking)
+  {
+    // N.B. animations can start or end other animations, so the list may change while it is iterated
+    for (size_t i = 0; i < mAnimatingControls.size(); i++)
+      mAnimatingControls[i]->Animate();
+    
+    mAnimatingControls.erase(std::remove_if(mAnimatingControls.begin(), mAnimatingControls.end(),
+                                            [](IControl* pControl) { return !pControl->GetAnimationFunction(); }), mAnimatingControls.end());
+    
+    ForSpecialControlsFunc([](IControl* pControl) { pControl->Animate(); } );
+  }
+  else
+    ForAllControlsFunc([](IControl* pControl) { pControl->Animate(); } );
 
   bool dirty = false;
     
@@ -860,7 +1025,21 @@ bool IGraphics::IsDirty(IRECTList& rects)
     }
   };
     
-  ForAllControlsFunc(func);
+  if (mDirtyTracking)
+  {
+    for (auto* pControl : mDirtyControls)
+      func(pControl);
+    
+    for (auto* pControl : mAnimatingControls)
+      func(pControl);
+    
+    for (auto* pControl : mPolledControls)
+      func(pControl);
+    
+    ForSpecialControlsFunc(func);
+  }
+  else
+    ForAllControlsFunc(func);
 
 #ifdef USE_IDLE_CALLS
   if (dirty)
@@ -914,6 +1093,7 @@ void IGraphics::DrawControl(IControl* pControl, const IRECT& bounds, float scale
       pParent = pParent->GetParent();
     }
     
+    IPLUG_PROFILE_SCOPE("DrawControl");
     PrepareRegion(clipBounds);
     pControl->Draw(*this);
 #ifdef AAX_API
@@ -934,7 +1114,18 @@ void IGraphics::DrawControl(IControl* pControl, const IRECT& bounds, float scale
 
 void IGraphics::Draw(const IRECT& bounds, float scale)
 {
-  ForAllControlsFunc([this, bounds, scale](IControl* pControl) { DrawControl(pControl, bounds, scale); });
+  if (mDirtyTracking)
+  {
+    UpdateControlIndex();
+    mControlIndex.Query(bounds, mControlIndexQuery);
+    
+    for (auto c : mControlIndexQuery)
+      DrawControl(GetControl(c), bounds, scale);
+    
+    ForSpecialControlsFunc([this, bounds, scale](IControl* pControl) { DrawControl(pControl, bounds, scale); });
+  }
+  else
+    ForAllControlsFunc([this, bounds, scale](IControl* pControl) { DrawControl(pControl, bounds, scale); });
 
 #ifndef NDEBUG
   if (mShowAreaDrawn)
@@ -953,6 +1144,7 @@ void IGraphics::Draw(IRECTList& rects)
   if (!rects.Size())
     return;
   
+  IPLUG_PROFILE_SCOPE("Draw");
   float scale = GetBackingPixelScale();
     
   BeginFrame();
@@ -1302,9 +1494,15 @@ int IGraphics::GetMouseControlIdx(float x, float y, bool mouseOver)
 {
   if (!mouseOver || mEnableMouseOver)
   {
+    UpdateControlIndex();
+    
+    // Only the controls whose bounds overlap the cell under the point are candidates, and they are in z-order
+    const std::vector<int>& candidates = mControlIndex.Query(x, y);
+    
     // Search from front to back
-    for (auto c = NControls() - 1; c >= (mouseOver ? 1 : 0); --c)
+    for (auto i = static_cast<int>(candidates.size()) - 1; i >= 0 && candidates[i] >= (mouseOver ? 1 : 0); --i)
     {
+      const int c = candidates[i];
       IControl* pControl = GetControl(c);
 
 #ifndef NDEBUG
@@ -1589,6 +1787,7 @@ ISVG IGraphics::LoadSVG(const char* fileName, const char* units, float dpi)
     }
   }
   
+  UseCachedSVG(pHolder, true);
   return ISVG(pHolder->mSVGDom);
 }
 
@@ -1625,10 +1824,11 @@ ISVG IGraphics::LoadSVG(const char* name, const void* pData, int dataSize, const
       nsvgDelete(pImage);
     }
 
-    pHolder = new SVGHolder(svgDOM);
-    storage.Add(pHolder, name);
+    // Another editor may have loaded the same SVG meanwhile, in which case that one is used
+    pHolder = storage.AddOrFind(new SVGHolder(svgDOM), name);
   }
 
+  UseCachedSVG(pHolder, true);
   return ISVG(pHolder->mSVGDom);
 }
 
@@ -1651,6 +1851,7 @@ ISVG IGraphics::LoadSVG(const char* fileName, const char* units, float dpi)
     }
   }
 
+  UseCachedSVG(pHolder, true);
   return ISVG(pHolder->mImage);
 }
 
@@ -1670,11 +1871,11 @@ ISVG IGraphics::LoadSVG(const char* name, const void* pData, int dataSize, const
     if (!pImage)
       return ISVG(nullptr);
     
-    pHolder = new SVGHolder(pImage);
-
-    storage.Add(pHolder, name);
+    // Another editor may have loaded the same SVG meanwhile, in which case that one is used
+    pHolder = storage.AddOrFind(new SVGHolder(pImage), name);
   }
 
+  UseCachedSVG(pHolder, true);
   return ISVG(pHolder->mImage);
 }
 #endif
@@ -1785,14 +1986,23 @@ IBitmap IGraphics::LoadBitmap(const char* name, int nStates, bool framesAreHoriz
     // Scale or retain if needed (N.B. - scaling retains in the cache)
     if (pAPIBitmap->GetScale() != targetScale)
     {
-      return ScaleBitmap(IBitmap(pAPIBitmap, nStates, framesAreHorizontal, name), name, targetScale);
+      IBitmap scaledBitmap = ScaleBitmap(IBitmap(pAPIBitmap, nStates, framesAreHorizontal, name), name, targetScale);
+      UseCachedBitmap(scaledBitmap.GetAPIBitmap());
+      
+      // The source is not used by this editor, unless it was found in the cache for itself
+      if (!loadedBitmap)
+        storage.ReleaseData(pAPIBitmap);
+      
+      return scaledBitmap;
     }
     else if (loadedBitmap)
     {
-      RetainBitmap(IBitmap(loadedBitmap.release(), nStates, framesAreHorizontal, name), name);
+      // Another editor may have loaded the same bitmap meanwhile, in which case that one is used
+      pAPIBitmap = storage.AddOrFind(loadedBitmap.release(), name, targetScale);
     }
   }
 
+  UseCachedBitmap(pAPIBitmap, true);
   return IBitmap(pAPIBitmap, nStates, framesAreHorizontal, name);
 }
 
@@ -1836,19 +2046,29 @@ IBitmap IGraphics::LoadBitmap(const char *name, const void *pData, int dataSize,
     // Scale or retain if needed (N.B. - scaling retains in the cache)
     if (pAPIBitmap->GetScale() != targetScale)
     {
-      return ScaleBitmap(IBitmap(pAPIBitmap, nStates, framesAreHorizontal, name), name, targetScale);
+      IBitmap scaledBitmap = ScaleBitmap(IBitmap(pAPIBitmap, nStates, framesAreHorizontal, name), name, targetScale);
+      UseCachedBitmap(scaledBitmap.GetAPIBitmap());
+      
+      // The source is not used by this editor, unless it was found in the cache for itself
+      if (!loadedBitmap)
+        storage.ReleaseData(pAPIBitmap);
+      
+      return scaledBitmap;
     }
     else if (loadedBitmap)
     {
-      RetainBitmap(IBitmap(loadedBitmap.release(), nStates, framesAreHorizontal, name), name);
+      // Another editor may have loaded the same bitmap meanwhile, in which case that one is used
+      pAPIBitmap = storage.AddOrFind(loadedBitmap.release(), name, targetScale);
     }
   }
 
+  UseCachedBitmap(pAPIBitmap, true);
   return IBitmap(pAPIBitmap, nStates, framesAreHorizontal, name);
 }
 
 void IGraphics::ReleaseBitmap(const IBitmap &bitmap)
 {
+  mUsedBitmaps.erase(bitmap.GetAPIBitmap());
   StaticStorage<APIBitmap>::Accessor storage(sBitmapCache);
   storage.Remove(bitmap.GetAPIBitmap());
 }
@@ -1914,7 +2134,8 @@ EResourceLocation IGraphics::SearchImageResource(const char* name, const char* t
 APIBitmap* IGraphics::SearchBitmapInCache(const char* name, int targetScale, int& sourceScale)
 {
   StaticStorage<APIBitmap>::Accessor storage(sBitmapCache);
-    
+  
+  // Find() retains the bitmap it returns
   for (sourceScale = targetScale; sourceScale > 0; SearchNextScale(sourceScale, targetScale))
   {
     APIBitmap* pBitmap = storage.Find(name, sourceScale);
@@ -2090,102 +2311,297 @@ void IGraphics::DrawRotatedLayer(const ILayerPtr& layer, double angle)
   PathTransformRestore();
 }
 
-void IGraphics::ApplyLayerDropShadow(ILayerPtr& layer, const IShadow& shadow)
+/** Blur each row of an 8-bit plane with a box of 2 * radius + 1 pixels, treating pixels outside the plane as zero. O(1) per pixel for any radius */
+static void BoxBlurRows(uint8_t* out, const uint8_t* in, int width, int height, int radius)
 {
-  auto GaussianBlurSwap = [](uint8_t* out, uint8_t* in, uint8_t* kernel, int width, int height,
-                             int outStride, int inStride, int kernelSize, uint32_t norm)
+  const uint64_t mul = ((1ull << 32) + radius) / (2 * radius + 1); // replaces the division by the box size
+  const uint64_t half = 1ull << 31;
+  const int rampEnd = std::min(radius, width); // the window for pixel j is [j - radius, j + radius]
+  const int steadyEnd = std::max(rampEnd, width - radius);
+
+  for (int i = 0; i < height; i++, in += width, out += width)
   {
-    int repeats = 0;
-    int fullKernelSize = kernelSize * 2 + 1;
-    uint32_t last = 0;
+    uint32_t sum = 0;
+    int j = 0;
+
+    for (int k = 0; k < rampEnd; k++)
+      sum += in[k];
 
-    auto RepeatCheck = [&](int idx)
+    for (; j < rampEnd; j++)
     {
-      repeats = last == in[idx * 4] ? std::min(repeats + 1, fullKernelSize) : 1;
-      last = in[idx * 4];
-        
-      return repeats == fullKernelSize;
-    };
-      
-    for (int i = 0; i < height; i++, in += inStride)
+      if (j + radius < width)
+        sum += in[j + radius];
+      out[j] = static_cast<uint8_t>((sum * mul + half) >> 32);
+    }
+
+    for (; j < steadyEnd; j++)
     {
-      for (int j = 0; j < kernelSize - 1; j++)
-      {
-        uint32_t accum = in[j * 4] * kernel[0];
-        for (int k = 1; k < j + 1; k++)
-          accum += kernel[k] * in[(j - k) * 4];
-        for (int k = 1; k < kernelSize; k++)
-          accum += kernel[k] * in[(j + k) * 4];
-        out[j * outStride + (i * 4)] = static_cast<uint8_t>(std::min(static_cast<uint32_t>(255), accum / norm));
-      }
-      for (int j = 0; j < kernelSize * 2 - 2; j++)
-        RepeatCheck(j);
-      for (int j = kernelSize - 1; j < (width - kernelSize) + 1; j++)
+      sum += in[j + radius];
+      out[j] = static_cast<uint8_t>((sum * mul + half) >> 32);
+      sum -= in[j - radius];
+    }
+
+    for (; j < width; j++)
+    {
+      if (j + radius < width)
+        sum += in[j + radius];
+      out[j] = static_cast<uint8_t>((sum * mul + half) >> 32);
+      if (j >= radius)
+        sum -= in[j - radius];
+    }
+  }
+}
+
+/** Blur the columns of an 8-bit plane with a box of 2 * radius + 1 pixels, a row at a time with one running sum per column */
+static void BoxBlurColumns(uint8_t* out, const uint8_t* in, int width, int height, int radius, uint32_t* sums)
+{
+  const uint32_t mul = static_cast<uint32_t>(((1ull << 24) + radius) / (2 * radius + 1)); // sums are < 2^8 * the box size, so this fits 32 bits
+  const uint32_t half = 1u << 23;
+
+  std::fill_n(sums, width, 0u);
+
+  for (int k = 0; k < std::min(radius, height); k++)
+    for (int j = 0; j < width; j++)
+      sums[j] += in[k * width + j];
+
+  for (int i = 0; i < height; i++, out += width)
+  {
+    if (i + radius < height)
+    {
+      const uint8_t* add = in + (i + radius) * width;
+      for (int j = 0; j < width; j++)
+        sums[j] += add[j];
+    }
+
+    for (int j = 0; j < width; j++)
+      out[j] = static_cast<uint8_t>((sums[j] * mul + half) >> 24);
+
+    if (i >= radius)
+    {
+      const uint8_t* sub = in + (i - radius) * width;
+      for (int j = 0; j < width; j++)
+        sums[j] -= sub[j];
+    }
+  }
+}
+
+/** Blur each row of an 8-bit plane with a symmetric kernel of 2 * kernelSize - 1 taps, treating pixels outside the plane as zero
+ * @param recip ceil(2^32 / the sum of the taps), which divides exactly for the small kernels this is used for */
+static void KernelBlurRows(uint8_t* out, const uint8_t* in, int width, int height, const uint32_t* kernel, int kernelSize, uint64_t recip)
+{
+  const int steadyStart = std::min(kernelSize, width);
+  const int steadyEnd = std::max(steadyStart, width - kernelSize);
+
+  auto EdgePixel = [&](const uint8_t* row, int j) {
+    uint32_t accum = row[j] * kernel[0];
+    for (int k = 1; k < kernelSize; k++)
+      accum += kernel[k] * ((j >= k ? row[j - k] : 0) + (j + k < width ? row[j + k] : 0));
+    return static_cast<uint8_t>(std::min<uint64_t>(255, (accum * recip) >> 32));
+  };
+
+  for (int i = 0; i < height; i++, in += width, out += width)
+  {
+    for (int j = 0; j < steadyStart; j++)
+      out[j] = EdgePixel(in, j);
+
+    for (int j = steadyStart; j < steadyEnd; j++)
+    {
+      uint32_t accum = in[j] * kernel[0];
+      for (int k = 1; k < kernelSize; k++)
+        accum += kernel[k] * (in[j - k] + in[j + k]);
+      out[j] = static_cast<uint8_t>(std::min<uint64_t>(255, (accum * recip) >> 32));
+    }
+
+    for (int j = steadyEnd; j < width; j++)
+      out[j] = EdgePixel(in, j);
+  }
+}
+
+/** Blur the columns of an 8-bit plane with a symmetric kernel, a row at a time */
+static void KernelBlurColumns(uint8_t* out, const uint8_t* in, int width, int height, const uint32_t* kernel, int kernelSize, uint64_t recip, uint32_t* sums)
+{
+  for (int i = 0; i < height; i++, out += width)
+  {
+    const uint8_t* row = in + i * width;
+
+    for (int j = 0; j < width; j++)
+      sums[j] = row[j] * kernel[0];
+
+    for (int k = 1; k < kernelSize; k++)
+    {
+      if (i >= k)
       {
-        if (RepeatCheck(j + kernelSize - 1))
-        {
-            out[j * outStride + (i * 4)] = static_cast<uint8_t>(last);
-            continue;
-        }
-          
-        uint32_t accum = in[j * 4] * kernel[0];
-        for (int k = 1; k < kernelSize; k++)
-          accum += kernel[k] * (in[(j - k) * 4] + in[(j + k) * 4]);
-        out[j * outStride + (i * 4)] = static_cast<uint8_t>(std::min(static_cast<uint32_t>(255), accum / norm));
+        const uint8_t* above = in + (i - k) * width;
+        for (int j = 0; j < width; j++)
+          sums[j] += kernel[k] * above[j];
       }
-      for (int j = (width - kernelSize) + 1; j < width; j++)
+
+      if (i + k < height)
       {
-        uint32_t accum = in[j * 4] * kernel[0];
-        for (int k = 1; k < kernelSize; k++)
-          accum += kernel[k] * in[(j - k) * 4];
-        for (int k = 1; k < width - j; k++)
-          accum += kernel[k] * in[(j + k) * 4];
-        out[j * outStride + (i * 4)] = static_cast<uint8_t>(std::min(static_cast<uint32_t>(255), accum / norm));
+        const uint8_t* below = in + (i + k) * width;
+        for (int j = 0; j < width; j++)
+          sums[j] += kernel[k] * below[j];
       }
     }
-  };
-  
+
+    for (int j = 0; j < width; j++)
+      out[j] = static_cast<uint8_t>(std::min<uint64_t>(255, (sums[j] * recip) >> 32));
+  }
+}
+
+/** Blur an 8-bit plane in place with a gaussian that is truncated at 3 standard deviations, or for larger blurs with three box blurs that approximate it,
+ * which cost the same for any size
+ * @param temp Scratch space the size of the plane
+ * @param sums Scratch space for width sums */
+static void ShadowBlur(uint8_t* plane, uint8_t* temp, uint32_t* sums, int width, int height, float blurSize)
+{
+  constexpr int kMaxKernelSize = 8;
+  constexpr int kNumBoxes = 3;
+  const int kernelSize = static_cast<int>(std::ceil(blurSize));
+
+  if (kernelSize <= 1)
+    return;
+
+  if (kernelSize <= kMaxKernelSize)
+  {
+    const float blurConst = 4.5f / (blurSize * blurSize);
+    uint32_t kernel[kMaxKernelSize];
+    uint32_t norm = 0;
+
+    for (int i = 0; i < kernelSize; i++)
+    {
+      kernel[i] = static_cast<uint32_t>(std::round(255.f * std::exp(-(i * i) * blurConst)));
+      norm += i ? kernel[i] * 2 : kernel[i];
+    }
+
+    // The sums are at most 255 * norm, and norm < 2^12, so that multiplying by the rounded up reciprocal gives the same result as dividing
+    const uint64_t recip = ((1ull << 32) + norm - 1) / norm;
+    KernelBlurRows(temp, plane, width, height, kernel, kernelSize, recip);
+    KernelBlurColumns(plane, temp, width, height, kernel, kernelSize, recip, sums);
+  }
+  else
+  {
+    // Box widths whose three convolutions have the same variance as the gaussian (P. Kovesi, "Fast almost-gaussian filtering")
+    const float variance = blurSize * blurSize / 9.f;
+    const float idealWidth = std::sqrt((12.f * variance / kNumBoxes) + 1.f);
+    int lowerWidth = static_cast<int>(std::floor(idealWidth));
+    if (!(lowerWidth & 1)) lowerWidth--;
+    const float idealNumLower = (12.f * variance - kNumBoxes * lowerWidth * lowerWidth - 4.f * kNumBoxes * lowerWidth - 3.f * kNumBoxes) / (-4.f * lowerWidth - 4.f);
+    const int numLower = static_cast<int>(std::round(idealNumLower));
+    int radii[kNumBoxes];
+
+    for (int i = 0; i < kNumBoxes; i++)
+      radii[i] = ((i < numLower ? lowerWidth : lowerWidth + 2) - 1) / 2;
+
+    // Passes alternate between the two buffers, ending in the plane
+    BoxBlurRows(temp, plane, width, height, radii[0]);
+    BoxBlurRows(plane, temp, width, height, radii[1]);
+    BoxBlurRows(temp, plane, width, height, radii[2]);
+    BoxBlurColumns(plane, temp, width, height, radii[0], sums);
+    BoxBlurColumns(temp, plane, width, height, radii[1], sums);
+    BoxBlurColumns(plane, temp, width, height, radii[2], sums);
+  }
+}
+
+void IGraphics::ApplyLayerDropShadow(ILayerPtr& layer, const IShadow& shadow)
+{
   RawBitmapData temp1;
-  RawBitmapData temp2;
-  RawBitmapData kernel;
     
   // Get bitmap in 32-bit form
   GetLayerBitmapData(layer, temp1);
     
   if (!temp1.GetSize())
       return;
-  temp2.Resize(temp1.GetSize());
     
-  // Form kernel (reference blurSize from zero (which will be no blur))
+  // Reference blurSize from zero (which will be no blur)
   bool flipped = FlippedBitmap();
   float scale = layer->GetAPIBitmap()->GetScale() * layer->GetAPIBitmap()->GetDrawScale();
   float blurSize = std::max(1.f, (shadow.mBlurSize * scale) + 1.f);
-  float blurConst = 4.5f / (blurSize * blurSize);
-  int iSize = static_cast<int>(ceil(blurSize));
   int width = layer->GetAPIBitmap()->GetWidth();
   int height = layer->GetAPIBitmap()->GetHeight();
-  int stride1 = temp1.GetSize() / width;
-  int stride2 = flipped ? -temp1.GetSize() / height : temp1.GetSize() / height;
-  int stride3 = flipped ? -stride2 : stride2;
-
-  kernel.Resize(iSize);
-        
-  for (int i = 0; i < iSize; i++)
-    kernel.Get()[i] = static_cast<uint8_t>(std::round(255.f * std::expf(-(i * i) * blurConst)));
+  int rowBytes = temp1.GetSize() / height;
+  int planeSize = width * height;
+  
+  // Extract the alphas top row first, since flipped bitmaps are read bottom row first
+  const int sumsOffset = (planeSize * 2 + 3) & ~3;
+  uint8_t* pPlane = mShadowScratch.ResizeOK(sumsOffset + width * static_cast<int>(sizeof(uint32_t)), false);
+  
+  if (!pPlane)
+    return;
+  
+  uint8_t* pTemp = pPlane + planeSize;
+  uint32_t* pSums = reinterpret_cast<uint32_t*>(pPlane + sumsOffset);
+  
+  const uint8_t* alphas = temp1.Get() + AlphaChannel();
   
-  // Kernel normalisation
-  int normFactor = kernel.Get()[0];
+  for (int i = 0; i < height; i++)
+  {
+    const uint8_t* row = alphas + (flipped ? height - 1 - i : i) * rowBytes;
+    uint8_t* planeRow = pPlane + i * width;
+    
+    for (int j = 0; j < width; j++)
+      planeRow[j] = row[j * 4];
+  }
+  
+  // An entry holds the alphas as well as the mask, so that a hash collision can't return the wrong mask
+  const int entryBytes = planeSize * 2;
+  
+  if (blurSize < SHADOW_MASK_CACHE_MIN_BLUR || entryBytes > SHADOW_MASK_CACHE_BYTES)
+  {
+    ShadowBlur(pPlane, pTemp, pSums, width, height, blurSize);
+  }
+  else
+  {
+    uint64_t hash = 0;
+    
+    for (int i = 0; i < planeSize; i += 8)
+    {
+      uint64_t word = 0;
+      memcpy(&word, pPlane + i, std::min(8, planeSize - i));
+      hash = (hash ^ word) * 0x9E3779B97F4A7C15ull;
+      hash ^= hash >> 29;
+    }
+    
+    // The mask only depends on the alphas and the blur, so identical layers share the same mask
+    auto it = std::find_if(mShadowMaskCache.begin(), mShadowMaskCache.end(), [&](const ShadowMask& mask) {
+      return mask.mHash == hash && mask.mWidth == width && mask.mHeight == height && mask.mBlurSize == blurSize
+        && !memcmp(mask.mAlphas.data(), pPlane, planeSize);
+    });
     
-  for (int i = 1; i < iSize; i++)
-    normFactor += kernel.Get()[i] + kernel.Get()[i];
+    if (it != mShadowMaskCache.end())
+    {
+      memcpy(pPlane, it->mAlphas.data() + planeSize, planeSize);
+      std::rotate(it, it + 1, mShadowMaskCache.end()); // most recently used last
+    }
+    else
+    {
+      std::vector<uint8_t> entryAlphas(entryBytes);
+      memcpy(entryAlphas.data(), pPlane, planeSize);
+      ShadowBlur(pPlane, pTemp, pSums, width, height, blurSize);
+      memcpy(entryAlphas.data() + planeSize, pPlane, planeSize);
+      
+      while (!mShadowMaskCache.empty() && mShadowMaskCacheBytes + entryBytes > SHADOW_MASK_CACHE_BYTES)
+      {
+        mShadowMaskCacheBytes -= static_cast<int>(mShadowMaskCache.front().mAlphas.size());
+        mShadowMaskCache.erase(mShadowMaskCache.begin());
+      }
+      
+      mShadowMaskCache.push_back({hash, width, height, blurSize, std::move(entryAlphas)});
+      mShadowMaskCacheBytes += entryBytes;
+    }
+  }
   
-  // Do blur
-  uint8_t* asRows = temp1.Get() + AlphaChannel();
-  uint8_t* inRows = flipped ? asRows + stride3 * (height - 1) : asRows;
-  uint8_t* asCols = temp2.Get() + AlphaChannel();
+  // Write the mask top row first
+  uint8_t* outAlphas = temp1.Get() + AlphaChannel();
   
-  GaussianBlurSwap(asCols, inRows, kernel.Get(), width, height, stride1, stride2, iSize, normFactor);
-  GaussianBlurSwap(asRows, asCols, kernel.Get(), height, width, stride3, stride1, iSize, normFactor);
+  for (int i = 0; i < height; i++)
+  {
+    const uint8_t* planeRow = pPlane + i * width;
+    uint8_t* row = outAlphas + i * rowBytes;
+    
+    for (int j = 0; j < width; j++)
+      row[j * 4] = planeRow[j];
+  }
   
   // Apply alphas to the pattern and recombine/replace the image
   ApplyShadowMask(layer, temp1, shadow);
@@ -55,6 +55,7 @@
 #include <memory>
 #include <vector>
 #include <unordered_map>
+#include <unordered_set>
 
 #ifdef FillRect
 #undef FillRect
@@ -397,6 +398,15 @@ public:
    * @return IBitmap The scaled bitmap */
   IBitmap GetScaledBitmap(IBitmap& inBitmap);
   
+  /** Get the usage of the bitmap and SVG caches, which are shared by all the editors in the process
+   * @param bitmapStats Filled with the bitmap cache statistics
+   * @param svgStats Filled with the SVG cache statistics */
+  static void GetImageCacheStats(StaticStorageStats& bitmapStats, StaticStorageStats& svgStats);
+  
+  /** Set how many bitmaps and SVGs that are no longer used by any editor are kept in the caches for reuse, before the oldest are deleted
+   * @param maxUnused The maximum number of unused entries in each cache, or -1 to keep all of them until the last editor closes */
+  static void SetMaxUnusedImageCacheEntries(int maxUnused);
+  
   /** Checks a file extension and reports whether this drawing API supports loading that extension */
   virtual bool BitmapExtSupported(const char* ext) = 0;
   
@@ -1284,6 +1294,10 @@ public:
    * @param func A std::function to perform on each control */
   void ForStandardControlsFunc(IControlFunction func);
   
+  /** For all special controls (corner resizer, text entry, popup menu etc.) perform a function
+   * @param func A std::function to perform on each control */
+  void ForSpecialControlsFunc(IControlFunction func);
+  
   /** For all standard controls in the main control stack that are linked to a specific parameter, call a method
    * @param method The method to call
    * @param paramIdx The parameter index to match
@@ -1485,6 +1499,25 @@ public:
   
   /** Calls SetClean() on every control */
   void SetAllControlsClean();
+  
+  /** Enable or disable dirty tracking. When enabled, controls that are marked dirty or are animating register themselves with IGraphics,
+   * so that IsDirty() does not have to poll every control at each display refresh. IGraphics also keeps a spatial index of the control bounds,
+   * so that drawing a region only visits the controls that intersect it.
+   * Controls that report themselves dirty by overriding IControl::IsDirty() must call IControl::SetWantsDirtyPolling() before they are attached.
+   * @param enable \c true to enable dirty tracking */
+  void EnableDirtyTracking(bool enable);
+  
+  /** @return \c true if dirty tracking is enabled. @see EnableDirtyTracking() */
+  bool DirtyTrackingEnabled() const { return mDirtyTracking; }
+  
+  /** Used internally by IControl::SetDirty() to register a tracked control that has become dirty */
+  void AddDirtyControl(IControl* pControl) { mDirtyControls.push_back(pControl); }
+  
+  /** Used internally by IControl::SetAnimation() to register a tracked control that has started animating */
+  void AddAnimatingControl(IControl* pControl);
+  
+  /** Used internally by IControl when the bounds of a control change, so that the spatial index is rebuilt before it is next used */
+  void InvalidateControlIndex() { mControlIndexStale = true; }
     
   /** Reposition a control, redrawing the interface correctly
    * @param pControl The control
@@ -1760,7 +1793,7 @@ protected:
    * @param fileName \todo
    * @param targetScale \todo
    * @param sourceScale \todo
-   * @return  pointer to the bitmap in the cache,  or null pointer if not found */
+   * @return  pointer to the bitmap in the cache, retained so that it is not evicted, or null pointer if not found */
   APIBitmap* SearchBitmapInCache(const char* fileName, int targetScale, int& sourceScale);
 
   /** \todo
@@ -1804,6 +1837,25 @@ private:
     mMouseOverIdx = -1;
   }
   
+  /** Register a standard control for dirty tracking, if it is enabled */
+  void TrackControl(IControl* pControl);
+  
+  /** Remove a standard control that is about to be deleted from the dirty tracking lists */
+  void UntrackControl(IControl* pControl);
+  
+  /** Retain a cached bitmap for the lifetime of this editor, so that it is not evicted from the cache
+   * @param pBitmap The bitmap
+   * @param retained \c true if the caller holds a reference from StaticStorage::Find() or AddOrFind(), which this editor takes over */
+  void UseCachedBitmap(APIBitmap* pBitmap, bool retained = false);
+  
+  /** Retain a cached SVG for the lifetime of this editor, so that it is not evicted from the cache
+   * @param pHolder The SVG
+   * @param retained \c true if the caller holds a reference from StaticStorage::Find() or AddOrFind(), which this editor takes over */
+  void UseCachedSVG(SVGHolder* pHolder, bool retained = false);
+  
+  /** Rebuild the spatial index of the standard controls, if it is stale */
+  void UpdateControlIndex();
+  
   WDL_PtrList<IControl> mControls;
   std::unordered_map<int, IControl*> mCtrlTags;
 
@@ -1855,6 +1907,28 @@ private:
   bool mResizingInProcess = false;
   bool mLayoutOnResize = false;
   bool mEnableMultiTouch = false;
+  bool mDirtyTracking = false;
+  bool mControlIndexStale = true;
+  std::vector<IControl*> mDirtyControls; // Tracked controls that have been marked dirty since the last SetAllControlsClean(), may contain duplicates
+  std::vector<IControl*> mAnimatingControls; // Tracked controls with an animation function
+  std::vector<IControl*> mPolledControls; // Tracked controls that override IsDirty()
+  /** A blurred shadow alpha mask, see ApplyLayerDropShadow() */
+  struct ShadowMask
+  {
+    uint64_t mHash; // hash of the unblurred alphas
+    int mWidth;
+    int mHeight;
+    float mBlurSize;
+    std::vector<uint8_t> mAlphas; // the unblurred alphas followed by the mask
+  };
+  
+  std::vector<ShadowMask> mShadowMaskCache; // Least recently used first
+  int mShadowMaskCacheBytes = 0;
+  WDL_TypedBuf<uint8_t> mShadowScratch; // Scratch space for blurring shadows
+  std::unordered_set<APIBitmap*> mUsedBitmaps; // Cached bitmaps retained by this editor
+  std::unordered_set<SVGHolder*> mUsedSVGs; // Cached SVGs retained by this editor
+  IRECTGrid mControlIndex; // Spatial index of the standard controls by index in mControls, used for drawing when dirty tracking is enabled and for hit testing
+  std::vector<int> mControlIndexQuery;
   EUIResizerMode mGUISizeMode = EUIResizerMode::Scale;
   double mPrevTimestamp = 0.;
   IKeyHandlerFunc mKeyHandlerFunc = nullptr;
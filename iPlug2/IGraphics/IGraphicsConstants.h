@@ -58,6 +58,14 @@ static const char* DEFAULT_PATH = "~/Desktop";
 const char* const DEFAULT_FONT = "Roboto-Regular";
 #endif
 
+#ifndef SHADOW_MASK_CACHE_BYTES
+static constexpr int SHADOW_MASK_CACHE_BYTES = 4 * 1024 * 1024; // Memory for the blurred layer shadow masks kept by each IGraphics, so that unchanged shadows are not recomputed
+#endif
+
+#ifndef SHADOW_MASK_CACHE_MIN_BLUR
+static constexpr float SHADOW_MASK_CACHE_MIN_BLUR = 16.f; // Shadows with a smaller blur (in pixels at the layer's scale) are cheaper to recompute than to look up, so are not cached
+#endif
+
 static constexpr float DEFAULT_TEXT_SIZE = 14.f;
 static constexpr int FONT_LEN = 64;
 
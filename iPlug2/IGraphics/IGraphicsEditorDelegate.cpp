@@ -111,6 +111,13 @@ void IGEditorDelegate::SendParameterValueFromDelegate(int paramIdx, double value
     if (!normalized)
       value = GetParam(paramIdx)->ToNormalized(value);
 
+    if (mStageParamValues)
+    {
+      mStagedParamValues.Get()[paramIdx] = value;
+      IEditorDelegate::SendParameterValueFromDelegate(paramIdx, value, normalized);
+      return;
+    }
+
     for (int c = 0; c < mGraphics->NControls(); c++)
     {
       IControl* pControl = mGraphics->GetControl(c);
@@ -132,6 +139,46 @@ void IGEditorDelegate::SendParameterValueFromDelegate(int paramIdx, double value
   IEditorDelegate::SendParameterValueFromDelegate(paramIdx, value, normalized);
 }
 
+void IGEditorDelegate::SendParameterValuesFromDelegate(const int* pParamIdx, int nParams)
+{
+  if(!mGraphics)
+  {
+    IEditorDelegate::SendParameterValuesFromDelegate(pParamIdx, nParams);
+    return;
+  }
+
+  // Stage the values, then update the controls in one pass, rather than searching all the controls for each parameter
+  const int n = NParams();
+  mStagedParamValues.Resize(n, false);
+  std::fill_n(mStagedParamValues.Get(), n, -1.);
+
+  mStageParamValues = true;
+  mCoalesceParamChangeUI = true;
+
+  for (int i = 0; i < nParams; i++)
+    SendParameterValueFromDelegate(pParamIdx[i], GetParam(pParamIdx[i])->GetNormalized(), true);
+
+  mStageParamValues = false;
+  mCoalesceParamChangeUI = false;
+
+  const double* pValues = mStagedParamValues.Get();
+
+  for (int c = 0; c < mGraphics->NControls(); c++)
+  {
+    IControl* pControl = mGraphics->GetControl(c);
+
+    for(int v = 0; v < pControl->NVals(); v++)
+    {
+      const int paramIdx = pControl->GetParamIdx(v);
+
+      if (paramIdx > kNoParameter && paramIdx < n && pValues[paramIdx] >= 0.)
+        pControl->SetValueFromDelegate(pValues[paramIdx], v);
+    }
+  }
+
+  OnParamsChangeUI(pParamIdx, nParams, EParamSource::kDelegate);
+}
+
 void IGEditorDelegate::SendMidiMsgFromDelegate(const IMidiMsg& msg)
 {
   if(mGraphics)
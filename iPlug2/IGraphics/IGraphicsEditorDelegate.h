@@ -56,6 +56,7 @@ public:
   void SendControlMsgFromDelegate(int ctrlTag, int msgTag, int dataSize = 0, const void* pData = nullptr) override;
   void SendMidiMsgFromDelegate(const IMidiMsg& msg) override;
   void SendParameterValueFromDelegate(int paramIdx, double value, bool normalized) override;
+  void SendParameterValuesFromDelegate(const int* pParamIdx, int nParams) override;
 
   /** Called to create the IGraphics instance for this editor. Default impl calls  mMakeGraphicsFunc */
   virtual IGraphics* CreateGraphics()
@@ -95,6 +96,10 @@ protected:
   std::function<void(IGraphics* pGraphics)> mLayoutFunc = nullptr;
 private:
   std::unique_ptr<IGraphics> mGraphics;
+  /** Normalized values staged by SendParameterValuesFromDelegate(), indexed by parameter, or -1 for parameters that aren't being sent */
+  WDL_TypedBuf<double> mStagedParamValues;
+  /** \c true while SendParameterValuesFromDelegate() is staging values */
+  bool mStageParamValues = false;
   int mLastWidth = 0;
   int mLastHeight = 0;
   float mLastScale = 0.f;
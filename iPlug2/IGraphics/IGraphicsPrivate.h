@@ -15,9 +15,13 @@
  * @{
  */
 
+#include <atomic>
 #include <codecvt>
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <memory>
+#include <unordered_map>
 
 #include "mutex.h"
 #include "wdlstring.h"
@@ -73,7 +77,7 @@
 #elif defined OS_WIN
   #include "wingdi.h"
   #define FONT_DESCRIPTOR_TYPE HFONT
-#elif defined OS_WEB
+#elif defined OS_WEB || defined OS_LINUX
   #define FONT_DESCRIPTOR_TYPE std::pair<WDL_String, WDL_String>*
 #else 
   // NO_IGRAPHICS
@@ -488,26 +492,51 @@ struct SVGHolder
 };
 #endif
 
-/** Used internally to store data statically, making sure memory is not wasted when there are multiple plug-in instances loaded */
+/** Hit, miss and eviction counts of a StaticStorage, to help size it */
+struct StaticStorageStats
+{
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+  uint64_t evictions = 0;
+  int entries = 0;
+  int unused = 0; // entries that were in use and are now kept for reuse, which can be evicted
+};
+
+/** Used internally to store data statically, making sure memory is not wasted when there are multiple plug-in instances loaded.
+ * Entries are found by (name, scale) in a hash map that is split into shards, each with a reader/writer lock, so that lookups from many instances do not contend.
+ * Entries that are retained, by Find(), AddOrFind() or RetainData(), are reference counted, and once released by all their users are kept for reuse until there are more than
+ * SetMaxUnused() of them, after which the oldest are deleted. Find() and AddOrFind() take their reference under the shard lock, so an entry cannot be evicted
+ * between being found and being retained. */
 template <class T>
 class StaticStorage
 {
 public:
-  /** Accessor class that mantains thread safety when using static storage via RAII */
-  class Accessor : private WDL_MutexLock
+  /** The number of independently locked parts of the map. Must be a power of two */
+  static constexpr int kNumShards = 16;
+  /** The default number of entries that are no longer retained, but are kept for reuse */
+  static constexpr int kDefaultMaxUnused = 64;
+
+  /** Accessor class for using static storage. Each call is thread safe on its own, and does not hold a lock for the lifetime of the accessor.
+   * Data returned by Find() and AddOrFind() is retained, so it stays valid until it is released with ReleaseData() */
+  class Accessor
   {
   public:
     Accessor(StaticStorage& storage) 
-    : WDL_MutexLock(&storage.mMutex)
-    , mStorage(storage) 
+    : mStorage(storage) 
     {}
     
     T* Find(const char* str, double scale = 1.)               { return mStorage.Find(str, scale); }
+    T* FindUnretained(const char* str, double scale = 1.)     { return mStorage.FindUnretained(str, scale); }
     void Add(T* pData, const char* str, double scale = 1.)    { return mStorage.Add(pData, str, scale); }
+    T* AddOrFind(T* pData, const char* str, double scale = 1.) { return mStorage.AddOrFind(pData, str, scale); }
     void Remove(T* pData)                                     { return mStorage.Remove(pData); }
     void Clear()                                              { return mStorage.Clear(); }
     void Retain()                                             { return mStorage.Retain(); }
     void Release()                                            { return mStorage.Release(); }
+    void RetainData(T* pData)                                 { return mStorage.RetainData(pData); }
+    void ReleaseData(T* pData)                                { return mStorage.ReleaseData(pData); }
+    void SetMaxUnused(int maxUnused)                          { return mStorage.SetMaxUnused(maxUnused); }
+    StaticStorageStats GetStats()                             { return mStorage.GetStats(); }
       
   private:
     StaticStorage& mStorage;
@@ -524,102 +553,347 @@ public:
   StaticStorage& operator=(const StaticStorage&) = delete;
     
 private:
-  /** \todo */
+  /** The map key, which views the name owned by the entry, or the string passed to Find() */
   struct DataKey
   {
-    // N.B. - hashID is not guaranteed to be unique
+    std::string_view name;
+    double scale;
     size_t hashID;
-    WDL_String name;
+
+    bool operator==(const DataKey& other) const { return scale == other.scale && name == other.name; }
+  };
+
+  struct KeyHash
+  {
+    size_t operator()(const DataKey& key) const { return key.hashID; }
+  };
+
+  struct Entry
+  {
+    std::string name;
     double scale;
+    size_t hashID;
     std::unique_ptr<T> data;
+    std::atomic<int> refs {0}; // the number of references taken and not yet released by ReleaseData(). Only decremented with mMutex locked
+    std::atomic<bool> retained {false}; // only entries that have been retained can be evicted
+    bool unused = false; // in mUnused, guarded by mMutex
   };
-  
-  /** \todo 
-   * @param str \todo
-   * @return size_t \todo */
-  size_t Hash(const char* str)
+
+  using EntryMap = std::unordered_multimap<DataKey, std::unique_ptr<Entry>, KeyHash>;
+
+  struct Shard
+  {
+    WDL_SharedMutex mMutex;
+    EntryMap mEntries;
+  };
+
+  static DataKey MakeKey(std::string_view name, double scale)
   {
-    std::string string(str);
-    return std::hash<std::string>()(string);
+    const size_t hashID = std::hash<std::string_view>()(name) ^ (std::hash<double>()(scale) * 0x9E3779B97F4A7C15ull);
+    return { name, scale, hashID };
   }
 
-  /** \todo 
-   * @param str \todo
-   * @param scale \todo
-   * @return T* \todo */
+  Shard& GetShard(size_t hashID) { return mShards[(hashID ^ (hashID >> 17)) & (kNumShards - 1)]; }
+
+  /** Find data and retain it, as RetainData() does. Each call should be matched by a call to ReleaseData() once the data is no longer used
+   * @param str The name of the data
+   * @param scale The scale of the data
+   * @return The data, or nullptr if it is not stored */
   T* Find(const char* str, double scale = 1.)
   {
-    WDL_String cacheName(str);
-    cacheName.AppendFormatted((int) strlen(str) + 6, "-%.1fx", scale);
-    
-    size_t hashID = Hash(cacheName.Get());
-    
-    int i, n = mDatas.GetSize();
-    for (i = 0; i < n; ++i)
-    {
-      DataKey* pKey = mDatas.Get(i);
+    const DataKey key = MakeKey(str, scale);
+    Shard& shard = GetShard(key.hashID);
+    WDL_MutexLockShared lock(&shard.mMutex);
+
+    auto it = shard.mEntries.find(key);
 
-      // Use the hash id for a quick search and then confirm with the scale and identifier to ensure uniqueness
-      if (pKey->hashID == hashID && scale == pKey->scale && !strcmp(str, pKey->name.Get()))
-        return pKey->data.get();
+    if (it == shard.mEntries.end())
+    {
+      mMisses.fetch_add(1, std::memory_order_relaxed);
+      return nullptr;
     }
-    return nullptr;
+
+    // Eviction takes the shard lock exclusively and checks the count, so the entry stays until this reference is released.
+    // An entry that was unused stays in mUnused until eviction or RetainData() finds it is in use again
+    Entry* pEntry = it->second.get();
+    pEntry->refs.fetch_add(1, std::memory_order_relaxed);
+    pEntry->retained.store(true, std::memory_order_relaxed);
+    mHits.fetch_add(1, std::memory_order_relaxed);
+    return pEntry->data.get();
   }
 
-  /** \todo 
-   * @param pData \todo
-   * @param str \todo
-   * @param scale \todo scale where 2x = retina, omit if not needed */
-  void Add(T* pData, const char* str, double scale = 1.)
+  /** Find data without retaining it. Only use this for data that is never retained, so is never evicted, such as fonts
+   * @param str The name of the data
+   * @param scale The scale of the data
+   * @return The data, or nullptr if it is not stored */
+  T* FindUnretained(const char* str, double scale = 1.)
   {
-    DataKey* pKey = mDatas.Add(new DataKey);
+    const DataKey key = MakeKey(str, scale);
+    Shard& shard = GetShard(key.hashID);
+    WDL_MutexLockShared lock(&shard.mMutex);
 
-    WDL_String cacheName(str);
-    cacheName.AppendFormatted((int) strlen(str) + 6, "-%.1fx", scale);
-    
-    pKey->hashID = Hash(cacheName.Get());
-    pKey->data = std::unique_ptr<T>(pData);
-    pKey->scale = scale;
-    pKey->name.Set(str);
+    auto it = shard.mEntries.find(key);
 
-    //DBGMSG("adding %s to the static storage at %.1fx the original scale\n", str, scale);
+    if (it == shard.mEntries.end())
+    {
+      mMisses.fetch_add(1, std::memory_order_relaxed);
+      return nullptr;
+    }
+
+    mHits.fetch_add(1, std::memory_order_relaxed);
+    return it->second->data.get();
   }
 
-  /** \todo @param pData \todo */
-  void Remove(T* pData)
+  /** Add data to the storage and retain it, unless the name and scale are already stored, in which case the stored data is retained and pData is deleted.
+   * Use this after a Find() that missed, so that two users loading the same data at once end up sharing one entry
+   * @param pData The data to store, which the storage takes ownership of
+   * @param str The name of the data
+   * @param scale The scale of the data
+   * @return The stored data, which is pData or the data that was already stored. Match with a call to ReleaseData() */
+  T* AddOrFind(T* pData, const char* str, double scale = 1.)
   {
-    for (int i = 0; i < mDatas.GetSize(); ++i)
+    std::unique_ptr<Entry> pNewEntry(new Entry);
+    pNewEntry->name.assign(str);
+    pNewEntry->scale = scale;
+    pNewEntry->data = std::unique_ptr<T>(pData);
+    pNewEntry->refs.store(1, std::memory_order_relaxed);
+    pNewEntry->retained.store(true, std::memory_order_relaxed);
+    const DataKey key = MakeKey(pNewEntry->name, scale);
+    pNewEntry->hashID = key.hashID;
+
+    // pNewEntry is declared first, so an entry that is not needed is deleted after the locks are released
+    WDL_MutexLock lock(&mMutex);
+    Shard& shard = GetShard(key.hashID);
+    WDL_MutexLockExclusive shardLock(&shard.mMutex);
+    auto it = shard.mEntries.find(key);
+
+    if (it != shard.mEntries.end())
     {
-      if (mDatas.Get(i)->data.get() == pData)
+      Entry* pEntry = it->second.get();
+      pEntry->refs.fetch_add(1, std::memory_order_relaxed);
+      pEntry->retained.store(true, std::memory_order_relaxed);
+
+      if (pEntry->unused)
       {
-        mDatas.Delete(i, true);
-        break;
+        mUnused.DeletePtr(pEntry);
+        pEntry->unused = false;
       }
+
+      return pEntry->data.get();
     }
+
+    Entry* pEntry = pNewEntry.release();
+    mEntriesByData[pData] = pEntry;
+    shard.mEntries.emplace(key, std::unique_ptr<Entry>(pEntry));
+    return pData;
   }
 
-  /** \todo  */
+  /** Add data to the storage, which takes ownership of it, without retaining it. Adding a name and scale that is already stored keeps both, and Find() returns either.
+   * Use AddOrFind() for data that is loaded on demand
+   * @param pData The data to store
+   * @param str The name of the data
+   * @param scale The scale of the data, where 2x = retina, omit if not needed */
+  void Add(T* pData, const char* str, double scale = 1.)
+  {
+    Entry* pEntry = new Entry;
+    pEntry->name.assign(str);
+    pEntry->scale = scale;
+    pEntry->data = std::unique_ptr<T>(pData);
+    const DataKey key = MakeKey(pEntry->name, scale);
+    pEntry->hashID = key.hashID;
+
+    WDL_MutexLock lock(&mMutex);
+    mEntriesByData[pData] = pEntry;
+
+    Shard& shard = GetShard(key.hashID);
+    WDL_MutexLockExclusive shardLock(&shard.mMutex);
+    shard.mEntries.emplace(key, std::unique_ptr<Entry>(pEntry));
+  }
+
+  /** Delete data from the storage, whether or not it is retained
+   * @param pData The data to delete */
+  void Remove(T* pData)
+  {
+    WDL_MutexLock lock(&mMutex);
+    auto it = mEntriesByData.find(pData);
+
+    if (it != mEntriesByData.end())
+      Erase(it->second);
+  }
+
+  /** Delete all the data */
   void Clear()
   {
-    mDatas.Empty(true);
+    WDL_MutexLock lock(&mMutex);
+
+    for (auto& shard : mShards)
+    {
+      WDL_MutexLockExclusive shardLock(&shard.mMutex);
+      shard.mEntries.clear();
+    }
+
+    mEntriesByData.clear();
+    mUnused.Empty();
   };
 
-  /** \todo  */
+  /** Called by each user of the storage, e.g. a plug-in instance */
   void Retain()
   {
+    WDL_MutexLock lock(&mMutex);
     mCount++;
   }
   
-  /** \todo  */
+  /** Called by each user of the storage when it is done with it. Deletes all the data once all users have released it */
   void Release()
   {
+    WDL_MutexLock lock(&mMutex);
+
     if (--mCount == 0)
       Clear();
   }
-    
+
+  /** Mark data as in use, so that it is not evicted until a matching ReleaseData()
+   * @param pData Data that was added to the storage */
+  void RetainData(T* pData)
+  {
+    WDL_MutexLock lock(&mMutex);
+    auto it = mEntriesByData.find(pData);
+
+    if (it != mEntriesByData.end())
+    {
+      Entry* pEntry = it->second;
+      pEntry->refs.fetch_add(1, std::memory_order_relaxed);
+      pEntry->retained.store(true, std::memory_order_relaxed);
+
+      if (pEntry->unused)
+      {
+        mUnused.DeletePtr(pEntry);
+        pEntry->unused = false;
+      }
+    }
+  }
+
+  /** Mark data as no longer in use by one of its users. When no user is left it may be evicted, oldest first, see SetMaxUnused()
+   * @param pData Data that was retained with Find(), AddOrFind() or RetainData() */
+  void ReleaseData(T* pData)
+  {
+    WDL_MutexLock lock(&mMutex);
+    auto it = mEntriesByData.find(pData);
+
+    if (it == mEntriesByData.end())
+      return;
+
+    Entry* pEntry = it->second;
+
+    // Decrements only happen here with mMutex held, so the count cannot reach zero between the check and the decrement. Find() can increment it at any time
+    // under the shard's shared lock, even once it is zero and the entry is in mUnused, which is safe because EraseIfUnused() re-checks the count under the
+    // exclusive shard lock before deleting
+    if (pEntry->refs.load(std::memory_order_relaxed) > 0 && pEntry->refs.fetch_sub(1, std::memory_order_relaxed) == 1 && !pEntry->unused)
+    {
+      mUnused.Add(pEntry);
+      pEntry->unused = true;
+      EvictUnused();
+    }
+  }
+
+  /** Set how many entries that are no longer in use are kept for reuse
+   * @param maxUnused The maximum number of unused entries, or -1 to keep all of them */
+  void SetMaxUnused(int maxUnused)
+  {
+    WDL_MutexLock lock(&mMutex);
+    mMaxUnused = maxUnused;
+    EvictUnused();
+  }
+
+  StaticStorageStats GetStats()
+  {
+    WDL_MutexLock lock(&mMutex);
+    StaticStorageStats stats;
+    stats.hits = mHits.load(std::memory_order_relaxed);
+    stats.misses = mMisses.load(std::memory_order_relaxed);
+    stats.evictions = mEvictions;
+    stats.entries = static_cast<int>(mEntriesByData.size());
+
+    for (int i = 0; i < mUnused.GetSize(); i++)
+    {
+      if (mUnused.Get(i)->refs.load(std::memory_order_relaxed) == 0)
+        stats.unused++;
+    }
+
+    return stats;
+  }
+
+  /** Delete the oldest unused entries, until there are no more than mMaxUnused. Entries that Find() has retained again since they became unused are kept. Called with mMutex locked */
+  void EvictUnused()
+  {
+    while (mMaxUnused >= 0 && mUnused.GetSize() > mMaxUnused)
+    {
+      Entry* pEntry = mUnused.Get(0);
+      mUnused.Delete(0);
+      pEntry->unused = false;
+
+      if (EraseIfUnused(pEntry))
+        mEvictions++;
+    }
+  }
+
+  /** Delete an entry if it has no references, checked under the exclusive shard lock so that Find() cannot retain it meanwhile. Called with mMutex locked
+   * @return \c true if the entry was deleted */
+  bool EraseIfUnused(Entry* pEntry)
+  {
+    Shard& shard = GetShard(pEntry->hashID);
+    WDL_MutexLockExclusive shardLock(&shard.mMutex);
+
+    if (pEntry->refs.load(std::memory_order_relaxed) != 0)
+      return false;
+
+    auto range = shard.mEntries.equal_range(MakeKey(pEntry->name, pEntry->scale));
+
+    for (auto it = range.first; it != range.second; ++it)
+    {
+      if (it->second.get() == pEntry)
+      {
+        mEntriesByData.erase(pEntry->data.get());
+        shard.mEntries.erase(it);
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  /** Delete an entry, whatever its references. Called with mMutex locked */
+  void Erase(Entry* pEntry)
+  {
+    if (pEntry->unused)
+      mUnused.DeletePtr(pEntry);
+
+    mEntriesByData.erase(pEntry->data.get());
+
+    Shard& shard = GetShard(pEntry->hashID);
+    WDL_MutexLockExclusive shardLock(&shard.mMutex);
+    auto range = shard.mEntries.equal_range(MakeKey(pEntry->name, pEntry->scale));
+
+    for (auto it = range.first; it != range.second; ++it)
+    {
+      if (it->second.get() == pEntry)
+      {
+        shard.mEntries.erase(it);
+        break;
+      }
+    }
+  }
+
+  // Lock order is mMutex, then a shard. Find() only takes the shared lock of one shard, and increments the entry's atomic reference count under it
+  Shard mShards[kNumShards];
+  WDL_Mutex mMutex; // guards everything but the shards and the hit counts
+  std::unordered_map<const T*, Entry*> mEntriesByData;
+  WDL_PtrList<Entry> mUnused; // oldest first
   int mCount = 0;
-  WDL_Mutex mMutex;
-  WDL_PtrList<DataKey> mDatas;
+  int mMaxUnused = kDefaultMaxUnused;
+  uint64_t mEvictions = 0;
+  std::atomic<uint64_t> mHits {0};
+  std::atomic<uint64_t> mMisses {0};
 };
 
 /** Encapsulate an xy point in one struct */
@@ -19,6 +19,7 @@
 #include <functional>
 #include <chrono>
 #include <numeric>
+#include <vector>
 
 #include "IPlugUtilities.h"
 #include "IPlugLogger.h"
@@ -1994,6 +1995,141 @@ private:
   WDL_TypedBuf<IRECT> mRects;
 };
 
+/** A uniform grid of cells over a rectangular area, used to quickly find the items with rectangles that intersect a region or contain a point.
+ * Items are identified by an integer, which IGraphics uses to store the index (and thus the z-order) of a control.
+ * Items must be added in ascending order, so that queries return them in ascending order.
+ * Rectangles that extend beyond the grid's bounds are clamped to the edge cells, so queries return candidates that the caller must test exactly. */
+class IRECTGrid
+{
+public:
+  static constexpr int kMaxCellsPerSide = 32;
+  static constexpr int kItemsPerCell = 4;
+  
+  IRECTGrid()
+  {}
+  
+  IRECTGrid(const IRECTGrid&) = delete;
+  IRECTGrid& operator=(const IRECTGrid&) = delete;
+  
+  /** Remove all items and set the area covered by the grid
+   * @param bounds The area covered by the grid
+   * @param nItems The number of items that will be added, used to choose the number of cells */
+  void Reset(const IRECT& bounds, int nItems)
+  {
+    mBounds = bounds;
+    mCellsPerSide = Clip(static_cast<int>(std::ceil(std::sqrt(nItems / static_cast<double>(kItemsPerCell)))), 1, kMaxCellsPerSide);
+    mCellW = bounds.W() > 0.f ? bounds.W() / mCellsPerSide : 1.f;
+    mCellH = bounds.H() > 0.f ? bounds.H() / mCellsPerSide : 1.f;
+    mCells.resize(mCellsPerSide * mCellsPerSide);
+    
+    for (auto& cell : mCells)
+      cell.clear();
+    
+    mStamps.assign(nItems, 0);
+    mStamp = 0;
+  }
+  
+  /** Add an item to every cell that its rectangle overlaps. Items with empty rectangles are not added
+   * @param item The item, which must be greater than any item already added and less than the nItems passed to Reset()
+   * @param r The item's rectangle */
+  void Add(int item, const IRECT& r)
+  {
+    if (r.W() <= 0.f || r.H() <= 0.f)
+      return;
+    
+    int l, t, r2, b;
+    GetCellRange(r, l, t, r2, b);
+    
+    for (auto row = t; row <= b; row++)
+    {
+      for (auto col = l; col <= r2; col++)
+        mCells[row * mCellsPerSide + col].push_back(item);
+    }
+  }
+  
+  /** Find the items that may intersect a region
+   * @param r The region to query
+   * @param items Filled with the candidate items, in ascending order without duplicates */
+  void Query(const IRECT& r, std::vector<int>& items)
+  {
+    items.clear();
+    
+    if (r.W() <= 0.f || r.H() <= 0.f || mCells.empty())
+      return;
+    
+    int l, t, r2, b;
+    GetCellRange(r, l, t, r2, b);
+    
+    if (l == r2 && t == b)
+    {
+      const auto& cell = mCells[t * mCellsPerSide + l];
+      items.assign(cell.begin(), cell.end());
+      return;
+    }
+    
+    // Items spanning several cells are only collected once, using a stamp per item that changes with each query
+    if (++mStamp == 0)
+    {
+      std::fill(mStamps.begin(), mStamps.end(), 0);
+      mStamp = 1;
+    }
+    
+    for (auto row = t; row <= b; row++)
+    {
+      for (auto col = l; col <= r2; col++)
+      {
+        for (auto item : mCells[row * mCellsPerSide + col])
+        {
+          if (mStamps[item] != mStamp)
+          {
+            mStamps[item] = mStamp;
+            items.push_back(item);
+          }
+        }
+      }
+    }
+    
+    std::sort(items.begin(), items.end());
+  }
+  
+  /** Find the items that may contain a point
+   * @param x The x coordinate of the point
+   * @param y The y coordinate of the point
+   * @return The candidate items in ascending order, valid until the grid is next modified */
+  const std::vector<int>& Query(float x, float y) const
+  {
+    static const std::vector<int> sEmpty;
+    
+    if (mCells.empty())
+      return sEmpty;
+    
+    int col, row, unused;
+    GetCellRange(IRECT(x, y, x, y), col, row, unused, unused);
+    return mCells[row * mCellsPerSide + col];
+  }
+  
+private:
+  void GetCellRange(const IRECT& r, int& l, int& t, int& r2, int& b) const
+  {
+    auto cellIdx = [this](float pos, float origin, float cellSize) {
+      return Clip(static_cast<int>(std::floor((pos - origin) / cellSize)), 0, mCellsPerSide - 1);
+    };
+    
+    l = cellIdx(r.L, mBounds.L, mCellW);
+    r2 = cellIdx(r.R, mBounds.L, mCellW);
+    t = cellIdx(r.T, mBounds.T, mCellH);
+    b = cellIdx(r.B, mBounds.T, mCellH);
+  }
+  
+  IRECT mBounds;
+  int mCellsPerSide = 0;
+  float mCellW = 1.f;
+  float mCellH = 1.f;
+  std::vector<std::vector<int>> mCells;
+  std::vector<unsigned int> mStamps;
+  unsigned int mStamp = 0;
+};
+
 /** Used to store transformation matrices */
 struct IMatrix
 {
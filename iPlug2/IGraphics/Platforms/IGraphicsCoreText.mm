@@ -124,7 +124,7 @@ void CoreTextHelpers::CachePlatformFont(const char* fontID, const PlatformFontPt
   CTFontDescriptorRef descriptor = font->GetDescriptor();
   IFontDataPtr data = font->GetFontData();
     
-  if (!storage.Find(fontID))
+  if (!storage.FindUnretained(fontID))
     storage.Add(new CoreTextFontDescriptor(descriptor, data->GetHeightEMRatio()), fontID);
 }
 
@@ -132,7 +132,7 @@ CoreTextFontDescriptor* CoreTextHelpers::GetCTFontDescriptor(const IText& text,
 {
   StaticStorage<CoreTextFontDescriptor>::Accessor storage(cache);
   
-  CoreTextFontDescriptor* cachedFont = storage.Find(text.mFont);
+  CoreTextFontDescriptor* cachedFont = storage.FindUnretained(text.mFont);
   
   assert(cachedFont && "font not found - did you forget to load it?");
   
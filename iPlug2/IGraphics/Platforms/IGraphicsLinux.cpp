@@ -8,4 +8,277 @@
  ==============================================================================
 */
 
-/\todo
+#include <cstring>
+#include <cstdio>
+#include <cstdint>
+
+#include "IGraphicsLinux.h"
+
+#include "include/core/SkFontMgr.h"
+#include "include/core/SkFontStyle.h"
+#include "include/core/SkPixmap.h"
+#include "include/core/SkStream.h"
+#include "include/core/SkTypeface.h"
+#include "include/encode/SkPngEncoder.h"
+
+using namespace iplug;
+using namespace igraphics;
+
+// Defined in IGraphicsSkia.cpp
+sk_sp<SkFontMgr> SkFontMgrRefDefault();
+
+#pragma mark - Private Classes and Structs
+
+class IGraphicsLinux::Font : public PlatformFont
+{
+public:
+  Font(const char* fontName, const char* fontStyle, bool system)
+  : PlatformFont(system), mDescriptor{fontName, fontStyle}
+  {}
+
+  FontDescriptor GetDescriptor() override { return &mDescriptor; }
+
+protected:
+  std::pair<WDL_String, WDL_String> mDescriptor;
+};
+
+class IGraphicsLinux::FileFont : public Font
+{
+public:
+  FileFont(const char* fontName, const char* fontPath)
+  : Font(fontName, "", false), mPath(fontPath)
+  {}
+
+  IFontDataPtr GetFontData() override
+  {
+    IFontDataPtr fontData(new IFontData());
+    FILE* fp = fopen(mPath.Get(), "rb");
+
+    if (!fp)
+      return fontData;
+
+    fseek(fp, 0, SEEK_END);
+    fontData = std::make_unique<IFontData>((int) ftell(fp));
+    fseek(fp, 0, SEEK_SET);
+    size_t readSize = fontData->GetSize() ? fread(fontData->Get(), 1, fontData->GetSize(), fp) : 0;
+    fclose(fp);
+
+    if (readSize && readSize == fontData->GetSize())
+      fontData->SetFaceIdx(0);
+
+    return fontData;
+  }
+
+private:
+  WDL_String mPath;
+};
+
+class IGraphicsLinux::MemoryFont : public Font
+{
+public:
+  MemoryFont(const char* fontName, const void* pData, int dataSize)
+  : Font(fontName, "", false)
+  {
+    mData.Set((const uint8_t*) pData, dataSize);
+  }
+
+  IFontDataPtr GetFontData() override
+  {
+    return IFontDataPtr(new IFontData(mData.Get(), mData.GetSize(), 0));
+  }
+
+private:
+  WDL_TypedBuf<uint8_t> mData;
+};
+
+/** An installed font, matched by family and style using the Skia font manager (fontconfig) */
+class IGraphicsLinux::SystemFont : public Font
+{
+public:
+  SystemFont(const char* fontName, ETextStyle style)
+  : Font(fontName, "", true), mStyle(style)
+  {}
+
+  IFontDataPtr GetFontData() override
+  {
+    IFontDataPtr fontData(new IFontData());
+
+    SkFontStyle style = mStyle == ETextStyle::Bold ? SkFontStyle::Bold() : mStyle == ETextStyle::Italic ? SkFontStyle::Italic() : SkFontStyle::Normal();
+    sk_sp<SkTypeface> typeface = SkFontMgrRefDefault()->matchFamilyStyle(mDescriptor.first.Get(), style);
+
+    if (!typeface)
+      return fontData;
+
+    int faceIdx = 0;
+    std::unique_ptr<SkStreamAsset> stream = typeface->openStream(&faceIdx);
+
+    if (!stream || !stream->getLength())
+      return fontData;
+
+    fontData = std::make_unique<IFontData>((int) stream->getLength());
+
+    if (stream->read(fontData->Get(), fontData->GetSize()) == static_cast<size_t>(fontData->GetSize()))
+      fontData->SetFaceIdx(faceIdx);
+
+    return fontData;
+  }
+
+private:
+  ETextStyle mStyle;
+};
+
+#pragma mark -
+
+IGraphicsLinux::IGraphicsLinux(IGEditorDelegate& dlg, int w, int h, int fps, float scale)
+: IGRAPHICS_DRAW_CLASS(dlg, w, h, fps, scale)
+{
+}
+
+IGraphicsLinux::~IGraphicsLinux()
+{
+  CloseWindow();
+}
+
+void* IGraphicsLinux::OpenWindow(void* pParent)
+{
+  OnViewInitialized(nullptr);
+  SetScreenScale(1.f); // resizes draw context
+  GetDelegate()->LayoutUI(this);
+  SetAllControlsDirty();
+  GetDelegate()->OnUIOpen();
+  mWindowOpen = true;
+
+  return GetWindow();
+}
+
+void IGraphicsLinux::CloseWindow()
+{
+  if (mWindowOpen)
+  {
+    mWindowOpen = false;
+    OnViewDestroyed();
+  }
+}
+
+bool IGraphicsLinux::RenderFrame(bool drawAll)
+{
+  if (drawAll)
+    SetAllControlsDirty();
+
+  IRECTList rects;
+
+  if (!IsDirty(rects))
+    return false;
+
+  SetAllControlsClean();
+  Draw(rects);
+
+  return true;
+}
+
+void IGraphicsLinux::RenderRegion(const IRECT& bounds)
+{
+  IRECTList rects;
+  rects.Add(bounds);
+  Draw(rects);
+}
+
+bool IGraphicsLinux::GetFramePixels(RawBitmapData& data, int& width, int& height)
+{
+  SkCanvas* pCanvas = static_cast<SkCanvas*>(GetDrawContext());
+
+  if (!pCanvas)
+    return false;
+
+  const SkISize size = pCanvas->getBaseLayerSize();
+  width = size.width();
+  height = size.height();
+
+  const SkImageInfo info = SkImageInfo::Make(width, height, kRGBA_8888_SkColorType, kUnpremul_SkAlphaType);
+  data.Resize(static_cast<int>(info.computeMinByteSize()), false);
+
+  return pCanvas->readPixels(info, data.Get(), info.minRowBytes(), 0, 0);
+}
+
+bool IGraphicsLinux::WriteFrameToPNG(const char* path)
+{
+  RawBitmapData data;
+  int width, height;
+
+  if (!GetFramePixels(data, width, height))
+    return false;
+
+  const SkImageInfo info = SkImageInfo::Make(width, height, kRGBA_8888_SkColorType, kUnpremul_SkAlphaType);
+  SkPixmap pixmap(info, data.Get(), info.minRowBytes());
+  SkFILEWStream stream(path);
+
+  return stream.isValid() && SkPngEncoder::Encode(&stream, pixmap, {});
+}
+
+EMsgBoxResult IGraphicsLinux::ShowMessageBox(const char* str, const char* title, EMsgBoxType type, IMsgBoxCompletionHandlerFunc completionHandler)
+{
+  DBGMSG("%s: %s\n", title ? title : "", str);
+
+  // Headless, so answer as if the user dismissed the message box
+  EMsgBoxResult result = type == kMB_OK ? kOK : kCANCEL;
+
+  if (completionHandler)
+    completionHandler(result);
+
+  return result;
+}
+
+void IGraphicsLinux::PromptForFile(WDL_String& fileName, WDL_String& path, EFileAction action, const char* ext, IFileDialogCompletionHandlerFunc completionHandler)
+{
+  // Headless, so answer as if the user cancelled the dialog
+  fileName.Set("");
+
+  if (completionHandler)
+    completionHandler(fileName, path);
+}
+
+void IGraphicsLinux::PromptForDirectory(WDL_String& dir, IFileDialogCompletionHandlerFunc completionHandler)
+{
+  dir.Set("");
+
+  if (completionHandler)
+  {
+    WDL_String fileName; // not used
+    completionHandler(fileName, dir);
+  }
+}
+
+IPopupMenu* IGraphicsLinux::CreatePlatformPopupMenu(IPopupMenu& menu, const IRECT bounds, bool& isAsync)
+{
+  // There are no platform menus, attach an IPopupMenuControl to use popup menus
+  return nullptr;
+}
+
+PlatformFontPtr IGraphicsLinux::LoadPlatformFont(const char* fontID, const char* fileNameOrResID)
+{
+  WDL_String fullPath;
+  const EResourceLocation fontLocation = LocateResource(fileNameOrResID, "ttf", fullPath, GetBundleID(), nullptr, nullptr);
+
+  if (fontLocation == kNotFound)
+    return nullptr;
+
+  return PlatformFontPtr(new FileFont(fontID, fullPath.Get()));
+}
+
+PlatformFontPtr IGraphicsLinux::LoadPlatformFont(const char* fontID, const char* fontName, ETextStyle style)
+{
+  return PlatformFontPtr(new SystemFont(fontName, style));
+}
+
+PlatformFontPtr IGraphicsLinux::LoadPlatformFont(const char* fontID, void* pData, int dataSize)
+{
+  return PlatformFontPtr(new MemoryFont(fontID, pData, dataSize));
+}
+
+#ifndef NO_IGRAPHICS
+#if defined IGRAPHICS_SKIA
+  #include "IGraphicsSkia.cpp"
+#else
+  #error
+#endif
+#endif
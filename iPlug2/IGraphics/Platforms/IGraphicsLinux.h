@@ -12,47 +12,86 @@
 
 #include "IGraphics_select.h"
 
+#if !defined IGRAPHICS_SKIA || !defined IGRAPHICS_CPU
+  #error IGraphicsLinux is headless and requires IGRAPHICS_SKIA with IGRAPHICS_CPU
+#endif
+
 BEGIN_IPLUG_NAMESPACE
 BEGIN_IGRAPHICS_NAMESPACE
 
-/** IGraphics platform class for linux
+/** IGraphics platform class for linux.
+ * There is no window: the editor is drawn into an offscreen Skia raster surface, which can be read back into memory or written to a PNG file.
+ * This makes it possible to render editors on machines without a display server, e.g. to benchmark drawing or check for rendering regressions.
+ * Mouse and keyboard input can be simulated by calling the IGraphics OnMouseDown() etc. methods directly.
 *   @ingroup PlatformClasses
 */
 class IGraphicsLinux final : public IGRAPHICS_DRAW_CLASS
 {
+  class Font;
+  class FileFont;
+  class MemoryFont;
+  class SystemFont;
 public:
   IGraphicsLinux(IGEditorDelegate& dlg, int w, int h, int fps, float scale);
-  virtual ~IGraphicsLinux);
-
-  void* OpenWindow(void* pWindow) override;
-  void CloseWindow() override;
-  bool WindowIsOpen() override;
-  void PlatformResize(bool parentHasResized) override;
-
-  void HideMouseCursor() override;
-  void ShowMouseCursor() override;
+  ~IGraphicsLinux();
 
-  EMsgBoxResult ShowMessageBox(const char* str, const char* title, EMsgBoxType type, IMsgBoxCompletionHandlerFunc completionHandler) override;
-  void ForceEndUserEdit() override;
-
-  const char* GetPlatformAPIStr() override;
+  const char* GetPlatformAPIStr() override { return "linux"; }
 
-  void UpdateTooltips() override;
+  void* OpenWindow(void* pParent) override;
+  void CloseWindow() override;
+  void* GetWindow() override { return mWindowOpen ? this : nullptr; }
 
-  bool RevealPathInExplorerOrFinder(WDL_String& path, bool select) override;
-  void PromptForFile(WDL_String& fileName, WDL_String& path, EFileAction action,  const char* ext, IColorPickerHandlerFunc func) override;
-  bool PromptForColor(IColor& color, const char* str) override;
+  void HideMouseCursor(bool hide, bool lock) override { mCursorHidden = hide; mCursorLock = lock; }
+  void MoveMouseCursor(float x, float y) override { mCursorX = x; mCursorY = y; }
+  void GetMouseLocation(float& x, float&y) const override { x = mCursorX; y = mCursorY; }
 
-  bool OpenURL(const char* url, const char* msgWindowTitle, const char* confirmMsg, const char* errMsgOnFailure) override;
+  void ForceEndUserEdit() override {}
+  void UpdateTooltips() override {}
 
-  static int GetUserOSVersion();
-  bool GetTextFromClipboard(WDL_String& str) override;
-  bool SetTextInClipboard(const char* str) override { return false; } // TODO
+  EMsgBoxResult ShowMessageBox(const char* str, const char* title, EMsgBoxType type, IMsgBoxCompletionHandlerFunc completionHandler) override;
+  void PromptForFile(WDL_String& fileName, WDL_String& path, EFileAction action, const char* ext, IFileDialogCompletionHandlerFunc completionHandler) override;
+  void PromptForDirectory(WDL_String& dir, IFileDialogCompletionHandlerFunc completionHandler) override;
+  bool PromptForColor(IColor& color, const char* str, IColorPickerHandlerFunc func) override { return false; }
+  bool OpenURL(const char* url, const char* msgWindowTitle, const char* confirmMsg, const char* errMsgOnFailure) override { return false; }
+
+  bool GetTextFromClipboard(WDL_String& str) override { str.Set(mClipboardText.Get()); return true; }
+  bool SetTextInClipboard(const char* str) override { mClipboardText.Set(str); return true; }
+
+  //IGraphicsLinux
+  /** Draw a frame into the offscreen surface, in the same way as a platform draw loop: animate the controls, then draw the regions that are dirty
+   * @param drawAll Set \c true to mark every control dirty first, so that the whole editor is drawn
+   * @return \c true if anything was drawn */
+  bool RenderFrame(bool drawAll = false);
+
+  /** Draw a region of the offscreen surface, regardless of whether the controls in it are dirty. Useful for timing the drawing of individual controls
+   * @param bounds The region to draw, in the same coordinates as the control bounds */
+  void RenderRegion(const IRECT& bounds);
+
+  /** Copy the offscreen surface into memory as non-premultiplied 8-bit RGBA pixels, top row first
+   * @param data Resized to hold width * height * 4 bytes
+   * @param width Set to the width of the surface in pixels
+   * @param height Set to the height of the surface in pixels
+   * @return \c true on success */
+  bool GetFramePixels(RawBitmapData& data, int& width, int& height);
+
+  /** Write the offscreen surface to a PNG file
+   * @param path The full path of the file to write
+   * @return \c true on success */
+  bool WriteFrameToPNG(const char* path);
 
 protected:
-  IPopupMenu* CreatePlatformPopupMenu(const IPopupMenu& menu, IRECT& bounds) override;
-  void CreatePlatformTextEntry(int paramIdx, const IText& text, const IRECT& bounds, int length, const char* str) override;
-}
+  IPopupMenu* CreatePlatformPopupMenu(IPopupMenu& menu, const IRECT bounds, bool& isAsync) override;
+  void CreatePlatformTextEntry(int paramIdx, const IText& text, const IRECT& bounds, int length, const char* str) override {}
+
+private:
+  PlatformFontPtr LoadPlatformFont(const char* fontID, const char* fileNameOrResID) override;
+  PlatformFontPtr LoadPlatformFont(const char* fontID, const char* fontName, ETextStyle style) override;
+  PlatformFontPtr LoadPlatformFont(const char* fontID, void* pData, int dataSize) override;
+  void CachePlatformFont(const char* fontID, const PlatformFontPtr& font) override {}
+
+  WDL_String mClipboardText;
+  bool mWindowOpen = false;
+};
 
 END_IGRAPHICS_NAMESPACE
 END_IPLUG_NAMESPACE
@@ -1416,7 +1416,7 @@ void IGraphicsWin::CreatePlatformTextEntry(int paramIdx, const IText& text, cons
   StaticStorage<HFontHolder>::Accessor hfontStorage(sHFontCache);
 
   LOGFONTW lFont = { 0 };
-  HFontHolder* hfontHolder = hfontStorage.Find(text.mFont);
+  HFontHolder* hfontHolder = hfontStorage.FindUnretained(text.mFont);
   GetObjectW(hfontHolder->mHFont, sizeof(LOGFONTW), &lFont);
   lFont.lfHeight = text.mSize * scale;
   mEditFont = CreateFontIndirectW(&lFont);
@@ -2021,7 +2021,7 @@ void IGraphicsWin::CachePlatformFont(const char* fontID, const PlatformFontPtr&
 
   HFONT hfont = font->GetDescriptor();
 
-  if (!hfontStorage.Find(fontID))
+  if (!hfontStorage.FindUnretained(fontID))
     hfontStorage.Add(new HFontHolder(hfont), fontID);
 }
 
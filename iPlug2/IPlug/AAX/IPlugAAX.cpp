@@ -240,6 +240,7 @@ AAX_Result IPlugAAX::UpdateParameterNormalizedValue(AAX_CParamID paramID, double
     ENTER_PARAMS_MUTEX
     GetParam(paramIdx)->SetNormalized(iValue);
     SendParameterValueFromAPI(paramIdx, iValue, true);
+    IPLUG_PROFILE_SCOPE("OnParamChange");
     OnParamChange(paramIdx, kHost);
     LEAVE_PARAMS_MUTEX
   }
@@ -274,6 +275,7 @@ void IPlugAAX::RenderAudio(AAX_SIPlugRenderInfo* pRenderInfo, const TParamValPai
     for (auto i = 0; i<packets_count; i++, pMidiPacket++)
     {
       IMidiMsg msg(pMidiPacket->mTimestamp, pMidiPacket->mData[0], pMidiPacket->mData[1], pMidiPacket->mData[2]);
+      IPLUG_PROFILE_SCOPE("ProcessMidiMsg");
       ProcessMidiMsg(msg);
       mMidiMsgsFromProcessor.Push(msg);
     }
@@ -358,9 +360,11 @@ void IPlugAAX::RenderAudio(AAX_SIPlugRenderInfo* pRenderInfo, const TParamValPai
     
     while (mMidiMsgsFromEditor.Pop(msg))
     {
+      IPLUG_PROFILE_SCOPE("ProcessMidiMsg");
       ProcessMidiMsg(msg);
     }
     
+    ApplyRestoredParams();
     ENTER_PARAMS_MUTEX
     ProcessBuffers(0.0f, numSamples);
     LEAVE_PARAMS_MUTEX
@@ -402,23 +406,25 @@ void IPlugAAX::RenderAudio(AAX_SIPlugRenderInfo* pRenderInfo, const TParamValPai
       //Output SYSEX from the editor, which has bypassed ProcessSysEx()
       if(mSysExDataFromEditor.ElementsAvailable())
       {
-        while (mSysExDataFromEditor.Pop(mSysexBuf))
+        ISysEx smsg;
+
+        while (mSysExDataFromEditor.Read(smsg))
         {
-          int numPackets = (int) ceil((float) mSysexBuf.mSize/4.); // each packet can store 4 bytes of data
+          int numPackets = (int) ceil((float) smsg.mSize/4.); // each packet can store 4 bytes of data
           int bytesPos = 0;
           
           for (int p = 0; p < numPackets; p++)
           {
             AAX_CMidiPacket packet;
             
-            packet.mTimestamp = (uint32_t) mSysexBuf.mOffset;
+            packet.mTimestamp = (uint32_t) smsg.mOffset;
             packet.mIsImmediate = true;
             
             int b = 0;
             
-            while (b < 4 && bytesPos < mSysexBuf.mSize)
+            while (b < 4 && bytesPos < smsg.mSize)
             {
-              packet.mData[b++] = mSysexBuf.mData[bytesPos++];
+              packet.mData[b++] = smsg.mData[bytesPos++];
             }
             
             packet.mLength = (uint32_t) b;
@@ -426,6 +432,8 @@ void IPlugAAX::RenderAudio(AAX_SIPlugRenderInfo* pRenderInfo, const TParamValPai
             midiOut->PostMIDIPacket (&packet);
           }
         }
+
+        mSysExDataFromEditor.Release();
       }
     }
   }
@@ -137,6 +137,7 @@ void IPlugAPP::AppProcess(double** inputs, double** outputs, int nFrames)
     
     while (mMidiMsgsFromCallback.Pop(msg))
     {
+      IPLUG_PROFILE_SCOPE("ProcessMidiMsg");
       ProcessMidiMsg(msg);
       mMidiMsgsFromProcessor.Push(msg); // queue incoming MIDI for UI
     }
@@ -144,14 +145,15 @@ void IPlugAPP::AppProcess(double** inputs, double** outputs, int nFrames)
   
   if(mSysExMsgsFromCallback.ElementsAvailable())
   {
-    SysExData data;
+    ISysEx msg;
     
-    while (mSysExMsgsFromCallback.Pop(data))
+    while (mSysExMsgsFromCallback.Read(msg))
     {
-      ISysEx msg { data.mOffset, data.mData, data.mSize };
       ProcessSysEx(msg);
-      mSysExDataFromProcessor.Push(data); // queue incoming Sysex for UI
+      mSysExDataFromProcessor.Push(msg); // queue incoming Sysex for UI
     }
+    
+    mSysExMsgsFromCallback.Release();
   }
   
   if(mMidiMsgsFromEditor.ElementsAvailable())
@@ -160,12 +162,14 @@ void IPlugAPP::AppProcess(double** inputs, double** outputs, int nFrames)
 
     while (mMidiMsgsFromEditor.Pop(msg))
     {
+      IPLUG_PROFILE_SCOPE("ProcessMidiMsg");
       ProcessMidiMsg(msg);
     }
   }
 
   //Do not handle Sysex messages here - SendSysexMsgFromUI overridden
 
+  ApplyRestoredParams();
   ENTER_PARAMS_MUTEX
   ProcessBuffers(0.0, GetBlockSize());
   LEAVE_PARAMS_MUTEX
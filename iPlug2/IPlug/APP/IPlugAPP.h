@@ -58,7 +58,7 @@ public:
 private:
   IPlugAPPHost* mAppHost = nullptr;
   IPlugQueue<IMidiMsg> mMidiMsgsFromCallback {MIDI_TRANSFER_SIZE};
-  IPlugQueue<SysExData> mSysExMsgsFromCallback {SYSEX_TRANSFER_SIZE};
+  IPlugByteQueue mSysExMsgsFromCallback {SYSEX_QUEUE_SIZE};
 
   friend class IPlugAPPHost;
 };
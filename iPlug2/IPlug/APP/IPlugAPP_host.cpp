@@ -756,15 +756,9 @@ void IPlugAPPHost::MIDICallback(double deltatime, std::vector<uint8_t>* pMsg, vo
   
   if (pMsg->size() > 3)
   {
-    if(pMsg->size() > MAX_SYSEX_SIZE)
-    {
-      DBGMSG("SysEx message exceeds MAX_SYSEX_SIZE\n");
-      return;
-    }
-    
-    SysExData data { 0, static_cast<int>(pMsg->size()), pMsg->data() };
+    if (!_this->mIPlug->mSysExMsgsFromCallback.Push(0, static_cast<int>(pMsg->size()), pMsg->data()))
+      DBGMSG("SysEx message does not fit in the queue\n");
     
-    _this->mIPlug->mSysExMsgsFromCallback.Push(data);
     return;
   }
   else if (pMsg->size())
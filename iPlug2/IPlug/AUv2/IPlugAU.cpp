@@ -1576,6 +1576,7 @@ OSStatus IPlugAU::SetParamProc(void* pPlug, AudioUnitParameterID paramID, AudioU
   ENTER_PARAMS_MUTEX_STATIC
   _this->GetParam(paramID)->Set(value);
   _this->SendParameterValueFromAPI(paramID, value, false);
+  IPLUG_PROFILE_SCOPE("OnParamChange");
   _this->OnParamChange(paramID, kHost, offsetFrames);
   LEAVE_PARAMS_MUTEX_STATIC
   return noErr;
@@ -1749,11 +1750,13 @@ OSStatus IPlugAU::RenderProc(void* pPlug, AudioUnitRenderActionFlags* pFlags, co
         
         while (_this->mMidiMsgsFromEditor.Pop(msg))
         {
+          IPLUG_PROFILE_SCOPE("ProcessMidiMsg");
           _this->ProcessMidiMsg(msg);
         }
       }
       
       _this->PreProcess();
+      _this->ApplyRestoredParams();
       ENTER_PARAMS_MUTEX_STATIC
       _this->ProcessBuffers((AudioSampleType) 0, nFrames);
       LEAVE_PARAMS_MUTEX_STATIC
@@ -2109,11 +2112,14 @@ void IPlugAU::OutputSysexFromEditor()
   //Output SYSEX from the editor, which has bypassed ProcessSysEx()
   if(mSysExDataFromEditor.ElementsAvailable())
   {
-    while (mSysExDataFromEditor.Pop(mSysexBuf))
+    ISysEx smsg;
+
+    while (mSysExDataFromEditor.Read(smsg))
     {
-      ISysEx smsg {mSysexBuf.mOffset, mSysexBuf.mData, mSysexBuf.mSize};
       SendSysEx(smsg);
     }
+
+    mSysExDataFromEditor.Release();
   }
 }
 
@@ -2459,6 +2465,7 @@ OSStatus IPlugAU::DoMIDIEvent(IPlugAU* _this, UInt32 inStatus, UInt32 inData1, U
     msg.mData1 = inData1;
     msg.mData2 = inData2;
     msg.mOffset = inOffsetSampleFrame;
+    IPLUG_PROFILE_SCOPE("ProcessMidiMsg");
     _this->ProcessMidiMsg(msg);
     _this->mMidiMsgsFromProcessor.Push(msg);
     return noErr;
@@ -125,6 +125,7 @@ void IPlugAUv3::ProcessWithEvents(AudioTimeStamp const* pTimestamp, uint32_t fra
   IMidiMsg midiMsg;
   while (mMidiMsgsFromEditor.Pop(midiMsg))
   {
+    IPLUG_PROFILE_SCOPE("ProcessMidiMsg");
     ProcessMidiMsg(midiMsg);
   }
   
@@ -141,6 +142,7 @@ void IPlugAUv3::ProcessWithEvents(AudioTimeStamp const* pTimestamp, uint32_t fra
         const AUMIDIEvent& midiEvent = pEvent->MIDI;
 
         midiMsg = {static_cast<int>(midiEvent.eventSampleTime - now), midiEvent.data[0], midiEvent.data[1], midiEvent.data[2] };
+        IPLUG_PROFILE_SCOPE("ProcessMidiMsg");
         ProcessMidiMsg(midiMsg);
         mMidiMsgsFromProcessor.Push(midiMsg);
       }
@@ -160,6 +162,7 @@ void IPlugAUv3::ProcessWithEvents(AudioTimeStamp const* pTimestamp, uint32_t fra
           ENTER_PARAMS_MUTEX
           GetParam(paramIdx)->Set(value);
           LEAVE_PARAMS_MUTEX
+          IPLUG_PROFILE_SCOPE("OnParamChange");
           OnParamChange(paramIdx, EParamSource::kHost, sampleOffset);
         }
 
@@ -172,16 +175,20 @@ void IPlugAUv3::ProcessWithEvents(AudioTimeStamp const* pTimestamp, uint32_t fra
     }
   }
 
+  ApplyRestoredParams();
   ENTER_PARAMS_MUTEX;
   ProcessBuffers(0.f, framesRemaining); // what about bufferOffset
   LEAVE_PARAMS_MUTEX;
     
   //Output SYSEX from the editor, which has bypassed ProcessSysEx()
-  while (mSysExDataFromEditor.Pop(mSysexBuf))
+  ISysEx smsg;
+
+  while (mSysExDataFromEditor.Read(smsg))
   {
-    ISysEx smsg {mSysexBuf.mOffset, mSysexBuf.mData, mSysexBuf.mSize};
     SendSysEx(smsg);
   }
+
+  mSysExDataFromEditor.Release();
   
 
 //  while (framesRemaining > 0) {
@@ -228,6 +235,7 @@ void IPlugAUv3::SetParameterFromValueObserver(uint64_t address, float value)
     assert(pParam);
     pParam->Set((double) value);
     LEAVE_PARAMS_MUTEX
+    IPLUG_PROFILE_SCOPE("OnParamChange");
     OnParamChange(paramIdx, kHost, -1);
   }
 }
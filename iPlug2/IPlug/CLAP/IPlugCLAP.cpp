@@ -53,6 +53,19 @@ IPlugCLAP::IPlugCLAP(const InstanceInfo& info, const Config& config)
   CreateTimer();
 }
 
+IPlugCLAP::~IPlugCLAP()
+{
+#if defined OS_LINUX
+  if (mTimerFDRegistered)
+  {
+    // Once detached, other instances' timers run on the timer thread again, so stop this one first
+    StopTimer();
+    GetClapHost().posixFdSupportUnregister(Timer_impl::GetEventFD());
+    Timer_impl::DetachRunLoop();
+  }
+#endif
+}
+
 uint32_t IPlugCLAP::tailGet() const noexcept
 {
   return GetTailIsInfinite() ? std::numeric_limits<uint32_t>::max() : GetTailSize();
@@ -137,16 +150,23 @@ bool IPlugCLAP::SendMidiMsg(const IMidiMsg& msg)
 
 bool IPlugCLAP::SendSysEx(const ISysEx& msg)
 {
-  // TODO - don't copy the data
-  SysExData data(msg.mOffset, msg.mSize, msg.mData);
-  mSysExToHost.Add(data);
-  return true;
+  // The caller's data may not outlive this call, so it is copied once into the queue and passed to the host from there
+  return mSysExToHost.Push(msg);
 }
 
 // clap_plugin
 bool IPlugCLAP::init() noexcept
 {
   SetDefaultConfig();
+
+#if defined OS_LINUX
+  // Call the timers from the host's main loop if it can watch the timer fd, otherwise they keep running on the timer thread
+  if (GetClapHost().canUsePosixFdSupport() && GetClapHost().posixFdSupportRegister(Timer_impl::GetEventFD(), CLAP_POSIX_FD_READ))
+  {
+    Timer_impl::AttachRunLoop();
+    mTimerFDRegistered = true;
+  }
+#endif
   
   return true;
 }
@@ -196,7 +216,10 @@ bool InputIsSilent(const T* data, int nFrames)
 clap_process_status IPlugCLAP::process(const clap_process* pProcess) noexcept
 {
   IMidiMsg msg;
-  SysExData sysEx;
+  ISysEx sysEx;
+  
+  // The host has consumed the output events of the previous block, which point into this queue
+  mSysExToHost.Release();
   
   // Transport Info
   if (pProcess->transport)
@@ -240,14 +263,17 @@ clap_process_status IPlugCLAP::process(const clap_process* pProcess) noexcept
   
   while (mMidiMsgsFromEditor.Pop(msg))
   {
+    IPLUG_PROFILE_SCOPE("ProcessMidiMsg");
     ProcessMidiMsg(msg);
   }
   
-  while (mSysExDataFromEditor.Pop(sysEx))
+  while (mSysExDataFromEditor.Read(sysEx))
   {
-    SendSysEx(ISysEx(sysEx.mOffset, sysEx.mData, sysEx.mSize));
+    SendSysEx(sysEx);
   }
   
+  mSysExDataFromEditor.Release();
+  
   // Do Audio Processing!
   int nIns = 0;
   int nOuts = 0;
@@ -362,6 +388,8 @@ clap_process_status IPlugCLAP::process(const clap_process* pProcess) noexcept
     }
   }
 
+  ApplyRestoredParams();
+
   if (format64)
     ProcessBuffers(0.0, nFrames);
   else
@@ -515,6 +543,9 @@ bool IPlugCLAP::paramsTextToValue(clap_id paramIdx, const char* display, double*
 void IPlugCLAP::paramsFlush(const clap_input_events* pInputParamChanges, const clap_output_events* pOutputParamChanges) noexcept
 {
   ProcessInputEvents(pInputParamChanges);
+  
+  // There is no audio to split when flushing, so apply any changes queued for sample accurate automation now
+  FlushParamChanges();
   ProcessOutputParams(pOutputParamChanges);
 }
 
@@ -539,6 +570,7 @@ void IPlugCLAP::ProcessInputEvents(const clap_input_events* pInputEvents) noexce
           auto pNote = ClapEventCast<clap_event_note>(pEvent);
           auto velocity = static_cast<int>(std::round(pNote->velocity * 127.0));
           msg.MakeNoteOnMsg(pNote->key, velocity, pEvent->time, pNote->channel);
+          IPLUG_PROFILE_SCOPE("ProcessMidiMsg");
           ProcessMidiMsg(msg);
           mMidiMsgsFromProcessor.Push(msg);
           break;
@@ -548,6 +580,7 @@ void IPlugCLAP::ProcessInputEvents(const clap_input_events* pInputEvents) noexce
         {
           auto pNote = ClapEventCast<clap_event_note>(pEvent);
           msg.MakeNoteOffMsg(pNote->key, pEvent->time, pNote->channel);
+          IPLUG_PROFILE_SCOPE("ProcessMidiMsg");
           ProcessMidiMsg(msg);
           mMidiMsgsFromProcessor.Push(msg);
           break;
@@ -557,6 +590,7 @@ void IPlugCLAP::ProcessInputEvents(const clap_input_events* pInputEvents) noexce
         {
           auto pMidiEvent = ClapEventCast<clap_event_midi>(pEvent);
           msg = IMidiMsg(pEvent->time, pMidiEvent->data[0], pMidiEvent->data[1], pMidiEvent->data[2]);
+          IPLUG_PROFILE_SCOPE("ProcessMidiMsg");
           ProcessMidiMsg(msg);
           mMidiMsgsFromProcessor.Push(msg);
           break;
@@ -567,7 +601,7 @@ void IPlugCLAP::ProcessInputEvents(const clap_input_events* pInputEvents) noexce
           auto pSysexEvent = ClapEventCast<clap_event_midi_sysex>(pEvent);
           ISysEx sysEx(pEvent->time, pSysexEvent->buffer, pSysexEvent->size);
           ProcessSysEx(sysEx);
-          mSysExDataFromProcessor.PushFromArgs(sysEx.mOffset, sysEx.mSize, sysEx.mData);
+          mSysExDataFromProcessor.Push(sysEx);
           break;
         }
           
@@ -578,16 +612,10 @@ void IPlugCLAP::ProcessInputEvents(const clap_input_events* pInputEvents) noexce
           int paramIdx = pParamValue->param_id;
           double value = pParamValue->value;
           
-          IParam* pParam = GetParam(paramIdx);
-          const bool isDoubleType = pParam->Type() == IParam::kTypeDouble;
-          
-          if (isDoubleType)
-            pParam->SetNormalized(value);
+          if (GetSampleAccurateAutomation())
+            EnqueueParamChange(paramIdx, value, pEvent->time);
           else
-            pParam->Set(value);
-          
-          SendParameterValueFromAPI(paramIdx, value, isDoubleType);
-          OnParamChange(paramIdx, EParamSource::kHost, pEvent->time);
+            ApplyParamChange(IParamChange(paramIdx, value, pEvent->time));
           break;
         }
           
@@ -598,6 +626,21 @@ void IPlugCLAP::ProcessInputEvents(const clap_input_events* pInputEvents) noexce
   }
 }
   
+void IPlugCLAP::ApplyParamChange(const IParamChange& change)
+{
+  IParam* pParam = GetParam(change.mIdx);
+  const bool isDoubleType = pParam->Type() == IParam::kTypeDouble;
+  
+  if (isDoubleType)
+    pParam->SetNormalized(change.mValue);
+  else
+    pParam->Set(change.mValue);
+  
+  SendParameterValueFromAPI(change.mIdx, change.mValue, isDoubleType);
+  IPLUG_PROFILE_SCOPE("OnParamChange");
+  OnParamChange(change.mIdx, EParamSource::kHost, change.mOffset);
+}
+
 void IPlugCLAP::ProcessOutputParams(const clap_output_events* pOutputParamChanges) noexcept
 {
   ParamToHost change;
@@ -643,7 +686,9 @@ void IPlugCLAP::ProcessOutputEvents(const clap_output_events* pOutputEvents, int
   {
     clap_event_header_t header;
 
-    while (mMidiToHost.ToDo() || mSysExToHost.ToDo())
+    ISysEx data;
+
+    while (mMidiToHost.ToDo() || mSysExToHost.ElementsAvailable())
     {
       int midiMsgOffset = nFrames;
       int sysExOffset = nFrames;
@@ -652,8 +697,8 @@ void IPlugCLAP::ProcessOutputEvents(const clap_output_events* pOutputEvents, int
       if (mMidiToHost.ToDo())
         midiMsgOffset = mMidiToHost.Peek().mOffset;
         
-      if (mSysExToHost.ToDo())
-        sysExOffset = mSysExToHost.Peek().mOffset;
+      if (mSysExToHost.Peek(data))
+        sysExOffset = data.mOffset;
         
       // Don't move beyond the current frame
       if (std::min(midiMsgOffset, sysExOffset) >= nFrames)
@@ -661,7 +706,7 @@ void IPlugCLAP::ProcessOutputEvents(const clap_output_events* pOutputEvents, int
       
       if (sysExOffset <= midiMsgOffset)
       {
-        auto data = mSysExToHost.Peek();
+        mSysExToHost.Read(data);
         
         uint32_t dataSize = static_cast<uint32_t>(data.mSize);
         
@@ -673,9 +718,8 @@ void IPlugCLAP::ProcessOutputEvents(const clap_output_events* pOutputEvents, int
         
         clap_event_midi_sysex sysex_event { header, 0, data.mData, dataSize };
         
+        // The host reads the buffer after process() returns, so the queue space is released at the start of the next block
         pOutputEvents->try_push(pOutputEvents, &sysex_event.header);
-        
-        mSysExToHost.Remove();
       }
       else
       {
@@ -846,6 +890,14 @@ bool IPlugCLAP::notePortsInfo(uint32_t index, bool isInput, clap_note_port_info*
   return true;
 }
 
+#if defined OS_LINUX
+void IPlugCLAP::onPosixFd(int fd, clap_posix_fd_flags_t flags) noexcept
+{
+  if (fd == Timer_impl::GetEventFD())
+    Timer_impl::RunPending();
+}
+#endif
+
 // clap_plugin_gui
 bool IPlugCLAP::guiIsApiSupported(const char* api, bool isFloating) noexcept
 {
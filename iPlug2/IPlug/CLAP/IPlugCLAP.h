@@ -84,6 +84,7 @@ class IPlugCLAP : public IPlugAPIBase
   
 public:
   IPlugCLAP(const InstanceInfo& info, const Config& config);
+  ~IPlugCLAP();
 
   // IPlugAPIBase
   void BeginInformHostOfParamChange(int idx) override;
@@ -97,6 +98,9 @@ public:
   bool SendMidiMsg(const IMidiMsg& msg) override;
   bool SendSysEx(const ISysEx& msg) override;
 
+protected:
+  void ApplyParamChange(const IParamChange& change) override;
+
 private:
   // clap_plugin
   bool init() noexcept override;
@@ -154,6 +158,12 @@ private:
   void paramsFlush(const clap_input_events* pInputParamChanges, const clap_output_events* pOutputParamChanges) noexcept override;
   bool isValidParamId(clap_id paramIdx) const noexcept override { return paramIdx < NParams(); }
 
+#if defined OS_LINUX
+  // clap_plugin_posix_fd_support, which runs the timers on the host's main thread
+  bool implementsPosixFdSupport() const noexcept override { return true; }
+  void onPosixFd(int fd, clap_posix_fd_flags_t flags) noexcept override;
+#endif
+
   // clap_plugin_gui
   bool implementsGui() const noexcept override;
   bool guiCreate(const char* api, bool isFloating) noexcept override;
@@ -195,7 +205,7 @@ private:
   uint32_t NChannels(ERoute direction, uint32_t bus, int configIdx) const;
   
   IPlugQueue<ParamToHost> mParamValuesToHost {PARAM_TRANSFER_SIZE};
-  IMidiQueueBase<SysExData> mSysExToHost;
+  IPlugByteQueue mSysExToHost {SYSEX_QUEUE_SIZE};
   IMidiQueue mMidiToHost;
   WDL_TypedBuf<float *> mAudioIO32;
   WDL_TypedBuf<double *> mAudioIO64;
@@ -207,6 +217,9 @@ private:
   
   void* mWindow = nullptr;
   bool mGUIOpen = false;
+#if defined OS_LINUX
+  bool mTimerFDRegistered = false;
+#endif
 };
 
 IPlugCLAP* MakePlug(const InstanceInfo& info);
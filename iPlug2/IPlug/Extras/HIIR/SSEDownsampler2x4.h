@@ -0,0 +1,184 @@
+/*
+
+SSEDownsampler2x4.h
+
+Downsamples by a factor 2 four channels at once, using SSE2.
+Samples are interleaved by channel: frame n of channel c is at [n * 4 + c].
+Each channel gives the same output as Downsampler2xFPU.
+
+Template parameters:
+  - NC: number of coefficients, > 0
+  - T: sample type, float or double
+
+--- Legal stuff ---
+
+This program is free software. It comes without any warranty, to
+the extent permitted by applicable law. You can redistribute it
+and/or modify it under the terms of the Do What The Fuck You Want
+To Public License, Version 2, as published by Sam Hocevar. See
+http://sam.zoy.org/wtfpl/COPYING for more details.
+
+*/
+
+#pragma once
+
+#include "SSEStageProc4.h"
+
+#if defined IPLUG_SIMDE
+
+#include <array>
+#include <cassert>
+
+namespace hiir
+{
+
+template <int NC, typename T>
+class Downsampler2x4SSE
+{
+public:
+  enum { NBR_COEFS = NC };
+  enum { NBR_CHANS = 4 };
+
+  typedef Vec4SSE <T> Vec;
+
+  Downsampler2x4SSE ();
+
+  /*
+  Name: set_coefs
+  Description:
+  Sets filter coefficients, for all channels. Generate them with the
+  PolyphaseIir2Designer class.
+  Call this function before doing any processing.
+  Input parameters:
+  - coef_arr: Array of coefficients. There should be as many coefficients as
+  mentioned in the class template parameter.
+  */
+  void set_coefs (const double coef_arr []);
+
+  /*
+  Name: process_sample
+  Description:
+  Downsamples (x2) one pair of frames, to generate one output frame.
+  Input parameters:
+  - in_ptr: pointer on the two frames to decimate, 8 samples.
+  Output parameters:
+  - out_ptr: the samplerate-reduced frame, 4 samples.
+  */
+  inline void process_sample (T out_ptr [4], const T in_ptr [8]);
+
+  /*
+  Name: process_block
+  Description:
+  Downsamples (x2) an interleaved block of frames.
+  Input and output blocks must not overlap.
+  Input parameters:
+  - in_ptr: Input array, containing nbr_spl * 2 frames.
+  - nbr_spl: Number of frames to output, > 0
+  Output parameters:
+  - out_ptr: Array for the output frames, capacity: nbr_spl frames.
+  */
+  void process_block (T out_ptr [], const T in_ptr [], long nbr_spl);
+
+  /*
+  Name: clear_buffers
+  Description:
+  Clears filter memory, as if it processed silence since an infinite amount
+  of time.
+  */
+  void clear_buffers ();
+
+private:
+  std::array<Vec, NBR_COEFS> _coef;
+  std::array<Vec, NBR_COEFS> _x;
+  std::array<Vec, NBR_COEFS> _y;
+
+private:
+  bool operator == (const Downsampler2x4SSE &other);
+  bool operator != (const Downsampler2x4SSE &other);
+};  // class Downsampler2x4SSE
+
+template <int NC, typename T>
+Downsampler2x4SSE <NC, T>::Downsampler2x4SSE ()
+{
+  for (int i = 0; i < NBR_COEFS; ++i)
+  {
+    _coef [i] = Vec::zero ();
+  }
+
+  clear_buffers ();
+}
+
+template <int NC, typename T>
+void Downsampler2x4SSE <NC, T>::set_coefs (const double coef_arr [])
+{
+  assert (coef_arr != 0);
+
+  for (int i = 0; i < NBR_COEFS; ++i)
+  {
+    _coef [i] = Vec::set1 (static_cast <T> (coef_arr [i]));
+  }
+}
+
+template <int NC, typename T>
+void Downsampler2x4SSE <NC, T>::process_sample (T out_ptr [4], const T in_ptr [8])
+{
+  Vec spl_0 = Vec::load (in_ptr + NBR_CHANS);
+  Vec spl_1 = Vec::load (in_ptr);
+
+  StageProc4SSE <NBR_COEFS, T>::process_sample_pos (
+    spl_0,
+    spl_1,
+    &_coef [0],
+    &_x [0],
+    &_y [0]
+  );
+
+  ((spl_0 + spl_1) * Vec::set1 (static_cast <T> (0.5))).store (out_ptr);
+}
+
+template <int NC, typename T>
+void Downsampler2x4SSE <NC, T>::process_block (T out_ptr [], const T in_ptr [], long nbr_spl)
+{
+  assert (in_ptr != 0);
+  assert (out_ptr != 0);
+  assert (out_ptr >= in_ptr + nbr_spl * NBR_CHANS * 2 || in_ptr >= out_ptr + nbr_spl * NBR_CHANS);
+  assert (nbr_spl > 0);
+
+  // Keep the filter state in registers for the whole block
+  std::array<Vec, NBR_COEFS> x = _x;
+  std::array<Vec, NBR_COEFS> y = _y;
+  const Vec half = Vec::set1 (static_cast <T> (0.5));
+
+  for (long pos = 0; pos < nbr_spl; ++pos)
+  {
+    Vec spl_0 = Vec::load (in_ptr + pos * NBR_CHANS * 2 + NBR_CHANS);
+    Vec spl_1 = Vec::load (in_ptr + pos * NBR_CHANS * 2);
+
+    StageProc4SSE <NBR_COEFS, T>::process_sample_pos (
+      spl_0,
+      spl_1,
+      &_coef [0],
+      &x [0],
+      &y [0]
+    );
+
+    ((spl_0 + spl_1) * half).store (out_ptr + pos * NBR_CHANS);
+  }
+
+  _x = x;
+  _y = y;
+}
+
+template <int NC, typename T>
+void Downsampler2x4SSE <NC, T>::clear_buffers ()
+{
+  for (int i = 0; i < NBR_COEFS; ++i)
+  {
+    _x [i] = Vec::zero ();
+    _y [i] = Vec::zero ();
+  }
+}
+
+} // namespace hiir
+
+#endif // IPLUG_SIMDE
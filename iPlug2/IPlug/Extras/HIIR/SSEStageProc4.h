@@ -0,0 +1,132 @@
+/*
+
+        SSEStageProc4.h
+
+        Processes four channels in parallel SSE2 lanes. Float channels are
+        held in one __m128, double channels in a pair of __m128d.
+
+        Only compiled when IPLUG_SIMDE is defined. On non-x86_64 include the
+        SIMDE library in your search paths to translate the intrinsics.
+
+Template parameters:
+  - NBR_COEFS: number of coefficients, > 0
+  - T: sample type, float or double
+
+--- Legal stuff ---
+
+This program is free software. It comes without any warranty, to
+the extent permitted by applicable law. You can redistribute it
+and/or modify it under the terms of the Do What The Fuck You Want
+To Public License, Version 2, as published by Sam Hocevar. See
+http://sam.zoy.org/wtfpl/COPYING for more details.
+
+*/
+
+#pragma once
+
+#if defined IPLUG_SIMDE
+
+#if defined(__arm64__)
+  #define SIMDE_ENABLE_NATIVE_ALIASES
+  #include "simde/x86/sse2.h"
+#else
+  #include <emmintrin.h>
+#endif
+
+namespace hiir
+{
+
+/*
+Four samples of type T, one per channel, in SSE2 registers.
+Loads and stores are unaligned, so interleaved buffers need no special
+alignment.
+*/
+template <typename T>
+struct Vec4SSE;
+
+template <>
+struct Vec4SSE <float>
+{
+  __m128 v;
+
+  static inline Vec4SSE zero () { return { _mm_setzero_ps () }; }
+  static inline Vec4SSE set1 (float a) { return { _mm_set1_ps (a) }; }
+  static inline Vec4SSE load (const float ptr [4]) { return { _mm_loadu_ps (ptr) }; }
+  inline void store (float ptr [4]) const { _mm_storeu_ps (ptr, v); }
+
+  friend inline Vec4SSE operator + (Vec4SSE a, Vec4SSE b) { return { _mm_add_ps (a.v, b.v) }; }
+  friend inline Vec4SSE operator - (Vec4SSE a, Vec4SSE b) { return { _mm_sub_ps (a.v, b.v) }; }
+  friend inline Vec4SSE operator * (Vec4SSE a, Vec4SSE b) { return { _mm_mul_ps (a.v, b.v) }; }
+};
+
+template <>
+struct Vec4SSE <double>
+{
+  __m128d lo;
+  __m128d hi;
+
+  static inline Vec4SSE zero () { return { _mm_setzero_pd (), _mm_setzero_pd () }; }
+  static inline Vec4SSE set1 (double a) { return { _mm_set1_pd (a), _mm_set1_pd (a) }; }
+  static inline Vec4SSE load (const double ptr [4]) { return { _mm_loadu_pd (ptr), _mm_loadu_pd (ptr + 2) }; }
+  inline void store (double ptr [4]) const { _mm_storeu_pd (ptr, lo); _mm_storeu_pd (ptr + 2, hi); }
+
+  friend inline Vec4SSE operator + (Vec4SSE a, Vec4SSE b) { return { _mm_add_pd (a.lo, b.lo), _mm_add_pd (a.hi, b.hi) }; }
+  friend inline Vec4SSE operator - (Vec4SSE a, Vec4SSE b) { return { _mm_sub_pd (a.lo, b.lo), _mm_sub_pd (a.hi, b.hi) }; }
+  friend inline Vec4SSE operator * (Vec4SSE a, Vec4SSE b) { return { _mm_mul_pd (a.lo, b.lo), _mm_mul_pd (a.hi, b.hi) }; }
+};
+
+/*
+Same computation as StageProcFPU::process_sample_pos(), on four channels at
+once. The all-pass cells of the two polyphase paths alternate, so spl_0 goes
+through the even coefficients and spl_1 through the odd ones.
+The previous input of each cell is the previous output of the cell before it
+on the same path, so only x [0] and x [1] are stored, which halves the memory
+traffic of the filter state. The loop has a constant trip count and is
+unrolled by the compiler.
+*/
+template <int NBR_COEFS, typename T>
+class StageProc4SSE
+{
+public:
+  typedef Vec4SSE <T> Vec;
+
+  static inline void process_sample_pos (Vec &spl_0, Vec &spl_1, const Vec coef [], Vec x [], Vec y [])
+  {
+    Vec prev_0 = x [0];
+    Vec prev_1 = x [1];
+
+    x [0] = spl_0;
+    x [1] = spl_1;
+
+    for (int cnt = 0; cnt + 1 < NBR_COEFS; cnt += 2)
+    {
+      const Vec y_0 = y [cnt + 0];
+      const Vec y_1 = y [cnt + 1];
+
+      spl_0 = (spl_0 - y_0) * coef [cnt + 0] + prev_0;
+      spl_1 = (spl_1 - y_1) * coef [cnt + 1] + prev_1;
+
+      y [cnt + 0] = spl_0;
+      y [cnt + 1] = spl_1;
+
+      prev_0 = y_0;
+      prev_1 = y_1;
+    }
+
+    if (NBR_COEFS & 1)
+    {
+      const int last = NBR_COEFS - 1;
+      spl_0 = (spl_0 - y [last]) * coef [last] + prev_0;
+      y [last] = spl_0;
+    }
+  }
+
+private:
+  StageProc4SSE ();
+  StageProc4SSE (const StageProc4SSE &other);
+  StageProc4SSE& operator = (const StageProc4SSE &other);
+};  // class StageProc4SSE
+
+} // namespace hiir
+
+#endif // IPLUG_SIMDE
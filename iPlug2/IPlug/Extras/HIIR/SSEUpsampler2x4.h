@@ -0,0 +1,185 @@
+/*
+
+SSEUpsampler2x4.h
+
+Upsamples by a factor 2 four channels at once, using SSE2.
+Samples are interleaved by channel: frame n of channel c is at [n * 4 + c].
+Each channel gives the same output as Upsampler2xFPU.
+
+Template parameters:
+- NC: number of coefficients, > 0
+- T: sample type, float or double
+
+--- Legal stuff ---
+
+This program is free software. It comes without any warranty, to
+the extent permitted by applicable law. You can redistribute it
+and/or modify it under the terms of the Do What The Fuck You Want
+To Public License, Version 2, as published by Sam Hocevar. See
+http://sam.zoy.org/wtfpl/COPYING for more details.
+
+*/
+
+#pragma once
+
+#include "SSEStageProc4.h"
+
+#if defined IPLUG_SIMDE
+
+#include <array>
+#include <cassert>
+
+namespace hiir
+{
+
+template <int NC, typename T>
+class Upsampler2x4SSE
+{
+public:
+  enum { NBR_COEFS = NC };
+  enum { NBR_CHANS = 4 };
+
+  typedef Vec4SSE <T> Vec;
+
+  Upsampler2x4SSE ();
+
+  /*
+  Name: set_coefs
+  Description:
+  Sets filter coefficients, for all channels. Generate them with the
+  PolyphaseIir2Designer class.
+  Call this function before doing any processing.
+  Input parameters:
+  - coef_arr: Array of coefficients. There should be as many coefficients as
+  mentioned in the class template parameter.
+  */
+  void set_coefs (const double coef_arr [NBR_COEFS]);
+
+  /*
+  Name: process_sample
+  Description:
+    Upsamples (x2) one frame, generating two output frames.
+  Input parameters:
+    - in_ptr: The input frame, 4 samples.
+  Output parameters:
+    - out_ptr: The two output frames, 8 samples.
+  */
+  inline void process_sample (T out_ptr [8], const T in_ptr [4]);
+
+  /*
+  Name: process_block
+  Description:
+    Upsamples (x2) the interleaved input block.
+    Input and output blocks must not overlap.
+  Input parameters:
+    - in_ptr: Input array, containing nbr_spl frames (nbr_spl * 4 samples).
+    - nbr_spl: Number of input frames to process, > 0
+  Output parameters:
+    - out_ptr: Output array, capacity: nbr_spl * 2 frames.
+  */
+  void process_block (T out_ptr [], const T in_ptr [], long nbr_spl);
+
+  /*
+  Name: clear_buffers
+  Description:
+    Clears filter memory, as if it processed silence since an infinite amount
+    of time.
+  */
+  void clear_buffers ();
+
+private:
+  std::array<Vec, NBR_COEFS> _coef;
+  std::array<Vec, NBR_COEFS> _x;
+  std::array<Vec, NBR_COEFS> _y;
+
+private:
+  bool operator == (const Upsampler2x4SSE &other);
+  bool operator != (const Upsampler2x4SSE &other);
+};  // class Upsampler2x4SSE
+
+template <int NC, typename T>
+Upsampler2x4SSE <NC, T>::Upsampler2x4SSE ()
+{
+  for (int i = 0; i < NBR_COEFS; ++i)
+  {
+    _coef [i] = Vec::zero ();
+  }
+
+  clear_buffers ();
+}
+
+template <int NC, typename T>
+void Upsampler2x4SSE <NC, T>::set_coefs (const double coef_arr [NBR_COEFS])
+{
+  assert (coef_arr != 0);
+
+  for (int i = 0; i < NBR_COEFS; ++i)
+  {
+    _coef [i] = Vec::set1 (static_cast <T> (coef_arr [i]));
+  }
+}
+
+template <int NC, typename T>
+void Upsampler2x4SSE <NC, T>::process_sample (T out_ptr [8], const T in_ptr [4])
+{
+  Vec even = Vec::load (in_ptr);
+  Vec odd = even;
+
+  StageProc4SSE <NBR_COEFS, T>::process_sample_pos (
+    even,
+    odd,
+    &_coef [0],
+    &_x [0],
+    &_y [0]
+  );
+
+  even.store (out_ptr);
+  odd.store (out_ptr + NBR_CHANS);
+}
+
+template <int NC, typename T>
+void Upsampler2x4SSE <NC, T>::process_block (T out_ptr [], const T in_ptr [], long nbr_spl)
+{
+  assert (out_ptr != 0);
+  assert (in_ptr != 0);
+  assert (out_ptr >= in_ptr + nbr_spl * NBR_CHANS || in_ptr >= out_ptr + nbr_spl * NBR_CHANS * 2);
+  assert (nbr_spl > 0);
+
+  // Keep the filter state in registers for the whole block
+  std::array<Vec, NBR_COEFS> x = _x;
+  std::array<Vec, NBR_COEFS> y = _y;
+
+  for (long pos = 0; pos < nbr_spl; ++pos)
+  {
+    Vec even = Vec::load (in_ptr + pos * NBR_CHANS);
+    Vec odd = even;
+
+    StageProc4SSE <NBR_COEFS, T>::process_sample_pos (
+      even,
+      odd,
+      &_coef [0],
+      &x [0],
+      &y [0]
+    );
+
+    even.store (out_ptr + pos * NBR_CHANS * 2);
+    odd.store (out_ptr + pos * NBR_CHANS * 2 + NBR_CHANS);
+  }
+
+  _x = x;
+  _y = y;
+}
+
+template <int NC, typename T>
+void Upsampler2x4SSE <NC, T>::clear_buffers ()
+{
+  for (int i = 0; i < NBR_COEFS; ++i)
+  {
+    _x [i] = Vec::zero ();
+    _y [i] = Vec::zero ();
+  }
+}
+
+} // namespace hiir
+
+#endif // IPLUG_SIMDE
@@ -0,0 +1,320 @@
+/*
+ ==============================================================================
+
+ This file is part of the iPlug 2 library. Copyright (C) the iPlug 2 developers.
+
+ See LICENSE.txt for  more info.
+
+ ==============================================================================
+*/
+
+#pragma once
+
+/**
+ * @file
+ * @brief Prepares convolution engines for new impulse responses on a worker thread, and crossfades to them on the audio thread
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "convoengine.h"
+
+#include "IPlugQueue.h"
+
+BEGIN_IPLUG_NAMESPACE
+
+/** Loads impulse responses into a WDL convolution engine without stalling the audio thread.
+ * LoadImpulse() copies the impulse and returns. A worker thread creates a new engine, partitions and FFTs the impulse in SetImpulse(),
+ * and runs some silence through it so that its buffers are allocated. The audio thread picks the prepared engine up with an atomic exchange at the start
+ * of a block, and crossfades from the previous engine to it once the new engine's output has reached the latency. The previous engine is handed back to the worker thread through a lock-free queue to be deleted.
+ * Only the wet signal is output, so the dry/wet mix is left to the plug-in.
+ * Each engine is given a queue of silence as long as the loader's latency, so that its output is exactly that late at any block size. The latency is the
+ * largest latency of the engines prepared so far and does not decrease when a load needs less, so that the engines being crossfaded stay aligned.
+ * Only a load that raises the latency crossfades between differently delayed signals.
+ * @tparam Engine WDL_ConvolutionEngine, WDL_ConvolutionEngine_Div or WDL_ConvolutionEngine_Thread */
+template <class Engine = WDL_ConvolutionEngine>
+class ImpulseLoader final
+{
+public:
+  /** The number of replaced engines that can wait to be deleted by the worker thread */
+  static constexpr int kMaxRetiredEngines = 8;
+  /** How often the worker thread deletes replaced engines, when it is not loading */
+  static constexpr std::chrono::milliseconds kRetireInterval{50};
+
+  /** @param crossfadeLength The length of the crossfade between engines, in samples */
+  ImpulseLoader(int crossfadeLength = 1024)
+  : mCrossfadeLength(crossfadeLength)
+  {
+    mWorkerThread = std::thread([this]() { WorkerLoop(); });
+  }
+
+  ~ImpulseLoader()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mQuit = true;
+    }
+    mCondition.notify_one();
+    mWorkerThread.join();
+
+    DeleteRetiredEngines();
+    delete mPendingEngine.exchange(nullptr);
+    delete mPreviousEngine;
+    delete mCurrentEngine;
+  }
+
+  ImpulseLoader(const ImpulseLoader&) = delete;
+  ImpulseLoader& operator=(const ImpulseLoader&) = delete;
+
+  /** Load a new impulse response. The impulse is copied, so this allocates and should not be called on the audio thread.
+   * If a previous load has not reached the audio thread yet, it is replaced by this one
+   * @param impulse The impulse response, at the sample rate of the plug-in
+   * @param nChans The number of channels ProcessBlock() will be called with
+   * @param maxBlockSize The largest number of frames ProcessBlock() will be called with */
+  void LoadImpulse(WDL_ImpulseBuffer& impulse, int nChans, int maxBlockSize)
+  {
+    auto pRequest = std::make_unique<Request>();
+    const int nImpulseChans = impulse.GetNumChannels();
+    const int length = impulse.GetLength();
+
+    pRequest->mImpulse.samplerate = impulse.samplerate;
+    pRequest->mImpulse.SetNumChannels(nImpulseChans, false);
+
+    if (pRequest->mImpulse.SetLength(length) == length)
+    {
+      for (int c = 0; c < nImpulseChans; c++)
+        memcpy(pRequest->mImpulse.impulses[c].Get(), impulse.impulses[c].Get(), length * sizeof(WDL_FFT_REAL));
+    }
+
+    pRequest->mNChans = nChans;
+    pRequest->mMaxBlockSize = maxBlockSize;
+
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mRequest = std::move(pRequest);
+    }
+    mCondition.notify_one();
+  }
+
+  /** @return \c true if a load has been requested and the audio thread has not started crossfading to it yet */
+  bool IsLoading() const
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mRequest || mPreparing || mPendingEngine.load(std::memory_order_relaxed);
+  }
+
+  /** @return The latency of the wet signal with the most recently prepared engine, in samples. Report this to the host with SetLatency() */
+  int GetLatency() const { return mLatency.load(std::memory_order_relaxed); }
+
+  /** Set the length of the crossfade between engines, which applies from the next load
+   * @param crossfadeLength The length in samples */
+  void SetCrossfadeLength(int crossfadeLength) { mCrossfadeLength.store(crossfadeLength, std::memory_order_relaxed); }
+
+  /** Convolve a block, on the audio thread. Does not lock, allocate or free memory
+   * @param inputs The input channels
+   * @param outputs The output channels, which receive the wet signal, or silence until the first impulse has been loaded
+   * @param nChans The number of input and output channels
+   * @param nFrames The number of frames */
+  void ProcessBlock(WDL_FFT_REAL** inputs, WDL_FFT_REAL** outputs, int nChans, int nFrames)
+  {
+    if (mPreviousEngine && !mFadeRemaining && mRetiredEngines.Push(mPreviousEngine))
+      mPreviousEngine = nullptr;
+
+    if (!mPreviousEngine && !mFadeRemaining)
+    {
+      if (AlignedEngine* pEngine = mPendingEngine.exchange(nullptr, std::memory_order_acquire))
+      {
+        mPreviousEngine = mCurrentEngine; // nullptr for the first load, which fades in from silence
+        mCurrentEngine = pEngine;
+        mFadeLength = std::max(1, mCrossfadeLength.load(std::memory_order_relaxed));
+        mFadeDelay = pEngine->mLatency; // the new engine only outputs silence until it has seen its latency's worth of input
+        mFadeRemaining = mFadeDelay + mFadeLength;
+      }
+    }
+
+    for (int c = 0; c < nChans; c++)
+      memset(outputs[c], 0, nFrames * sizeof(WDL_FFT_REAL));
+
+    if (!mCurrentEngine)
+      return;
+
+    if (mFadeRemaining)
+    {
+      const WDL_FFT_REAL fadeStep = WDL_FFT_REAL(1) / WDL_FFT_REAL(mFadeLength);
+      const WDL_FFT_REAL fadeIn = WDL_FFT_REAL(mFadeLength - mFadeRemaining + 1) * fadeStep; // negative, and clamped to 0, during mFadeDelay
+
+      AddEngineOutput(*mCurrentEngine, inputs, outputs, nChans, nFrames, fadeIn, fadeStep);
+
+      if (mPreviousEngine)
+        AddEngineOutput(*mPreviousEngine, inputs, outputs, nChans, nFrames, WDL_FFT_REAL(1) - fadeIn, -fadeStep);
+
+      mFadeRemaining = std::max(0, mFadeRemaining - nFrames);
+    }
+    else
+      AddEngineOutput(*mCurrentEngine, inputs, outputs, nChans, nFrames, WDL_FFT_REAL(1), WDL_FFT_REAL(0));
+  }
+
+  /** Clear the engines' input and output, for example when the transport restarts. Any crossfade in progress is finished */
+  void Reset()
+  {
+    if (mCurrentEngine)
+      mCurrentEngine->ResetAligned();
+
+    mFadeRemaining = 0;
+  }
+
+private:
+  struct Request
+  {
+    WDL_ImpulseBuffer mImpulse;
+    int mNChans = 0;
+    int mMaxBlockSize = 0;
+  };
+
+  /** An engine that delays its output to the loader's latency, by queueing silence ahead of the input */
+  struct AlignedEngine : Engine
+  {
+    /** Clear the input and output, and queue mLatency samples of silence */
+    void ResetAligned()
+    {
+      Engine::Reset();
+
+      if (mLatency > 0)
+        Engine::Add(nullptr, mLatency, mNChans);
+    }
+
+    int mLatency = 0; // at least the engine's own GetLatency()
+    int mNChans = 0;
+  };
+
+  /** Add the engine's output for a block, scaled by a gain ramp that is clamped to [0, 1]. The silence queued by AlignedEngine::ResetAligned() means that
+   * a full block of output is available, but if it is not, the output is aligned to the end of the block */
+  static void AddEngineOutput(AlignedEngine& engine, WDL_FFT_REAL** inputs, WDL_FFT_REAL** outputs, int nChans, int nFrames, WDL_FFT_REAL gain, WDL_FFT_REAL gainStep)
+  {
+    engine.Add(inputs, nFrames, nChans);
+
+    const int nAvailable = std::min(engine.Avail(nFrames), nFrames);
+
+    if (nAvailable < 1)
+      return;
+
+    const int offset = nFrames - nAvailable;
+    WDL_FFT_REAL** ppWet = engine.Get();
+    gain += gainStep * WDL_FFT_REAL(offset);
+
+    for (int c = 0; c < nChans; c++)
+    {
+      const WDL_FFT_REAL* pWet = ppWet[c];
+      WDL_FFT_REAL* pOut = outputs[c] + offset;
+
+      if (gainStep == WDL_FFT_REAL(0))
+      {
+        for (int s = 0; s < nAvailable; s++)
+          pOut[s] += gain * pWet[s];
+      }
+      else
+      {
+        for (int s = 0; s < nAvailable; s++)
+          pOut[s] += std::min(std::max(gain + gainStep * WDL_FFT_REAL(s), WDL_FFT_REAL(0)), WDL_FFT_REAL(1)) * pWet[s];
+      }
+    }
+
+    engine.Advance(nAvailable);
+  }
+
+  void WorkerLoop()
+  {
+    std::unique_lock<std::mutex> lock(mMutex);
+
+    while (!mQuit)
+    {
+      mCondition.wait_for(lock, kRetireInterval, [this]() { return mQuit || mRequest; });
+
+      if (mQuit)
+        break;
+
+      std::unique_ptr<Request> pRequest = std::move(mRequest);
+      mPreparing = pRequest != nullptr;
+      lock.unlock();
+
+      DeleteRetiredEngines();
+
+      if (pRequest)
+      {
+        AlignedEngine* pEngine = PrepareEngine(*pRequest, mAlignedLatency);
+        mLatency.store(mAlignedLatency, std::memory_order_relaxed);
+        // a prepared engine that the audio thread has not picked up yet is superseded by this one
+        delete mPendingEngine.exchange(pEngine, std::memory_order_acq_rel);
+      }
+
+      lock.lock();
+      mPreparing = false;
+    }
+  }
+
+  /** Create an engine for the request, and run silence through it so that its buffers are allocated before it reaches the audio thread
+   * @param request The impulse and processing setup
+   * @param alignedLatency The latency of the previous engines, which is raised if this engine needs more */
+  static AlignedEngine* PrepareEngine(Request& request, int& alignedLatency)
+  {
+    AlignedEngine* pEngine = new AlignedEngine;
+    pEngine->SetImpulse(&request.mImpulse);
+
+    alignedLatency = std::max(alignedLatency, pEngine->GetLatency());
+    pEngine->mLatency = alignedLatency;
+    pEngine->mNChans = request.mNChans;
+
+    const int blockSize = std::max(1, request.mMaxBlockSize);
+    const int primeLength = 2 * std::max(alignedLatency, blockSize);
+
+    pEngine->ResetAligned();
+
+    for (int pos = 0; pos < primeLength; pos += blockSize)
+    {
+      pEngine->Add(nullptr, blockSize, request.mNChans);
+      pEngine->Advance(std::min(pEngine->Avail(blockSize), blockSize));
+    }
+
+    pEngine->ResetAligned();
+    return pEngine;
+  }
+
+  void DeleteRetiredEngines()
+  {
+    AlignedEngine* pEngine;
+
+    while (mRetiredEngines.Pop(pEngine))
+      delete pEngine;
+  }
+
+  // audio thread
+  AlignedEngine* mCurrentEngine = nullptr;
+  AlignedEngine* mPreviousEngine = nullptr; // fading out, or waiting to be retired
+  int mFadeLength = 0;
+  int mFadeDelay = 0;
+  int mFadeRemaining = 0; // including mFadeDelay
+
+  // shared
+  std::atomic<AlignedEngine*> mPendingEngine {nullptr}; // prepared by the worker thread, taken by the audio thread
+  IPlugQueue<AlignedEngine*> mRetiredEngines {kMaxRetiredEngines}; // replaced by the audio thread, deleted by the worker thread
+  std::atomic<int> mCrossfadeLength;
+  std::atomic<int> mLatency {0};
+
+  // worker thread
+  mutable std::mutex mMutex; // guards mRequest, mPreparing and mQuit
+  std::condition_variable mCondition;
+  std::unique_ptr<Request> mRequest;
+  bool mPreparing = false;
+  bool mQuit = false;
+  int mAlignedLatency = 0;
+  std::thread mWorkerThread;
+};
+
+END_IPLUG_NAMESPACE
@@ -1,11 +1,46 @@
+#include <new>
+
 #include "IPlugOSC.h"
 
+#ifndef OS_WIN
+#include <sys/select.h>
+#endif
+
 using namespace iplug;
 
 std::unique_ptr<Timer> OSCInterface::mTimer;
 int OSCInterface::sInstances = 0;
+WDL_PtrList<OSCInterface> OSCInterface::sInterfaces;
 WDL_PtrList<OSCDevice> gDevices;
 
+// How often a device input thread that is waiting for packets checks if it should stop
+static constexpr int kInputThreadWakeMs = 50;
+
+/** Call func(msg, len) for each message in a packet, which is either a single message or a bundle */
+template <typename F>
+static void ForEachMessage(const unsigned char* packet, int sz, F&& func)
+{
+  int rd_pos = 0;
+  int rd_sz = sz;
+  if (sz > 20 && !strcmp((const char*)packet, "#bundle"))
+  {
+    memcpy(&rd_sz, packet + 16, sizeof(int));
+    OSC_MAKEINTMEM4BE(&rd_sz);
+    rd_pos += 20;
+  }
+
+  while (rd_pos + rd_sz <= sz && rd_sz >= 0)
+  {
+    func((const char*)packet + rd_pos, rd_sz);
+
+    rd_pos += rd_sz + 4;
+    if (rd_pos >= sz) break;
+
+    memcpy(&rd_sz, packet + rd_pos - 4, sizeof(int));
+    OSC_MAKEINTMEM4BE(&rd_sz);
+  }
+}
+
 #ifdef OS_WIN
 #define XSleep Sleep
 #else
@@ -67,6 +102,8 @@ OSCDevice::OSCDevice(const char* dest, int maxpacket, int sendsleep, sockaddr_in
 
 OSCDevice::~OSCDevice()
 {
+  StopInputThread();
+
   if (mSendSocket != INVALID_SOCKET)
   {
     shutdown(mSendSocket, SHUT_RDWR);
@@ -169,14 +206,55 @@ void OSCDevice::RunOutput()
   mSendQueue.Clear();
 }
 
+void OSCDevice::StartInputThread()
+{
+  if (IsInputThreadRunning() || !mHasInput || mSendSocket == INVALID_SOCKET)
+    return;
+
+  mInputThreadRunning = true;
+  mInputThread = std::thread([this]() {
+    while (mInputThreadRunning.load())
+    {
+      fd_set readSet;
+      FD_ZERO(&readSet);
+      FD_SET(mSendSocket, &readSet);
+      struct timeval timeout = { 0, kInputThreadWakeMs * 1000 };
+
+      if (select((int) mSendSocket + 1, &readSet, nullptr, nullptr, &timeout) > 0)
+        RunInput();
+    }
+  });
+}
+
+void OSCDevice::StopInputThread()
+{
+  mInputThreadRunning = false;
+
+  if (mInputThread.joinable())
+    mInputThread.join();
+}
+
 void OSCDevice::AddInstance(void(*callback)(void* d1, int dev_idx, int msglen, void* msg), void* d1, int dev_idx)
 {
   const rec r = { callback, d1, dev_idx };
+  WDL_MutexLock lock(&mInstancesMutex);
   mInstances.Add(r);
 }
 
+void OSCDevice::RemoveInstance(void* d1)
+{
+  WDL_MutexLock lock(&mInstancesMutex);
+
+  for (int x = mInstances.GetSize() - 1; x >= 0; x--)
+  {
+    if (mInstances.Get()[x].data1 == d1)
+      mInstances.Delete(x);
+  }
+}
+
 void OSCDevice::OnMessage(char type, const unsigned char* msg, int len)
 {
+  WDL_MutexLock lock(&mInstancesMutex);
   const int n = mInstances.GetSize();
   const rec* r = mInstances.Get();
   for (int x = 0; x < n; x++)
@@ -199,7 +277,14 @@ void OSCInterface::MessageCallback(void* d1, int dev_idx, int len, void* msg)
 {
   OSCInterface* _this = (OSCInterface*)d1;
 
-  if (_this && msg)
+  if (_this && msg && _this->mLockFreeReceive.load())
+  {
+    const auto time = std::chrono::steady_clock::now();
+    ForEachMessage((const unsigned char*)msg, len, [&](const char* pMsg, int msgLen) {
+      _this->QueueMessage(pMsg, msgLen, time);
+    });
+  }
+  else if (_this && msg)
   {
     if (_this->mIncomingEvents.GetSize() < 65536 * 8)
     {
@@ -221,17 +306,53 @@ void OSCInterface::MessageCallback(void* d1, int dev_idx, int len, void* msg)
   }
 }
 
-void OSCInterface::OnTimer(Timer& timer)
+void OSCInterface::QueueMessage(const char* msg, int len, std::chrono::steady_clock::time_point time)
 {
-  const int nDevices = gDevices.GetSize();
+  const int prefixLen = mParamAddressPrefix.GetLength();
 
-  for (auto i = 0; i < nDevices; i++)
+  if (prefixLen && len <= MAX_OSC_MSG_LEN && !strncmp(msg, mParamAddressPrefix.Get(), prefixLen))
   {
-    auto* pDev = gDevices.Get(i);
-    if (pDev->mHasInput)
-      pDev->RunInput();
+    char buf[MAX_OSC_MSG_LEN];
+    memcpy(buf, msg, len);
+    OscMessageRead rmsg(buf, len);
+
+    const char* mstr = rmsg.GetMessage();
+    char* end = nullptr;
+    const long paramIdx = mstr ? strtol(mstr + prefixLen, &end, 10) : -1;
+    char type = 0;
+
+    if (end && end != mstr + prefixLen && !*end && paramIdx >= 0 && rmsg.GetIndexedArg(0, &type))
+    {
+      ParamMsg paramMsg;
+      paramMsg.mParamIdx = (int) paramIdx;
+      paramMsg.mTime = time;
+
+      if (type == 'f')
+        paramMsg.mValue = *rmsg.PopFloatArg(false);
+      else if (type == 'i')
+        paramMsg.mValue = *rmsg.PopIntArg(false);
+      else
+        return;
+
+      mParamQueue.Push(paramMsg); // dropped if the audio thread is not running
+      return;
+    }
   }
 
+  // Copy the message after an OscMessageRead that parses it in place, so that the main thread can use it without copying or parsing
+  uint8_t* pSlot = mReceiveQueue.Reserve((int) sizeof(OscMessageRead) + len);
+
+  if (!pSlot)
+    return; // dropped, the main thread is not keeping up
+
+  char* pData = (char*)pSlot + sizeof(OscMessageRead);
+  memcpy(pData, msg, len);
+  new (pSlot) OscMessageRead(pData, len);
+  mReceiveQueue.Commit();
+}
+
+void OSCInterface::ProcessIncomingEvents()
+{
   if (mIncomingEvents.GetSize())
   {
     static WDL_HeapBuf tmp;
@@ -252,33 +373,48 @@ void OSCInterface::OnTimer(Timer& timer)
       if (pos + this_sz > endpos) break;
       pos += this_sz;
 
-      int rd_pos = 0;
-      int rd_sz = evt->sz;
-      if (evt->sz > 20 && !strcmp((char*)evt->msg, "#bundle"))
-      {
-        rd_sz = *(int*)(evt->msg + 16);
-        OSC_MAKEINTMEM4BE(&rd_sz);
-        rd_pos += 20;
-      }
       //        if (m_var_msgs[3]) m_var_msgs[3][0] = evt->dev_ptr ? *evt->dev_ptr : -1.0;
 
-      while (rd_pos + rd_sz <= evt->sz && rd_sz >= 0)
-      {
-        OscMessageRead rmsg((char*)evt->msg + rd_pos, rd_sz);
+      ForEachMessage(evt->msg, evt->sz, [&](const char* pMsg, int msgLen) {
+        OscMessageRead rmsg((char*)pMsg, msgLen);
 
         const char* mstr = rmsg.GetMessage();
         if (mstr && *mstr)
           OnOSCMessage(rmsg);
+      });
+    }
+  }
 
-        rd_pos += rd_sz + 4;
-        if (rd_pos >= evt->sz) break;
+  // Messages from an input thread, which own their slot until Release()
+  ISysEx slot;
 
-        rd_sz = *(int*)(evt->msg + rd_pos - 4);
-        OSC_MAKEINTMEM4BE(&rd_sz);
-      }
-    }
+  while (mReceiveQueue.Read(slot))
+  {
+    OscMessageRead& rmsg = *reinterpret_cast<OscMessageRead*>(const_cast<uint8_t*>(slot.mData));
+
+    const char* mstr = rmsg.GetMessage();
+    if (mstr && *mstr)
+      OnOSCMessage(rmsg);
   }
 
+  mReceiveQueue.Release();
+}
+
+//static
+void OSCInterface::OnTimer(Timer& timer)
+{
+  const int nDevices = gDevices.GetSize();
+
+  for (auto i = 0; i < nDevices; i++)
+  {
+    auto* pDev = gDevices.Get(i);
+    if (pDev->mHasInput && !pDev->IsInputThreadRunning())
+      pDev->RunInput();
+  }
+
+  for (auto i = 0; i < sInterfaces.GetSize(); i++)
+    sInterfaces.Get(i)->ProcessIncomingEvents();
+
   for (auto i = 0; i < nDevices; i++)
   {
     auto* pDev = gDevices.Get(i);
@@ -287,19 +423,31 @@ void OSCInterface::OnTimer(Timer& timer)
   }
 }
 
+void OSCInterface::SetLockFreeReceive(bool enable, const char* paramAddressPrefix)
+{
+  mParamAddressPrefix.Set(enable && paramAddressPrefix ? paramAddressPrefix : "");
+  mLockFreeReceive = enable;
+}
+
 OSCInterface::OSCInterface(OSCLogFunc logFunc)
 : mLogFunc(logFunc)
 {
   JNL::open_socketlib();
 
   if (!mTimer)
-    mTimer = std::unique_ptr<Timer>(Timer::Create(std::bind(&OSCInterface::OnTimer, this, std::placeholders::_1), OSC_TIMER_RATE));
+    mTimer = std::unique_ptr<Timer>(Timer::Create(OnTimer, OSC_TIMER_RATE));
 
   sInstances++;
+  sInterfaces.Add(this);
 }
 
 OSCInterface::~OSCInterface()
 {
+  sInterfaces.DeletePtr(this);
+
+  for (auto i = 0; i < gDevices.GetSize(); i++)
+    gDevices.Get(i)->RemoveInstance(this);
+
   if (--sInstances == 0) {
     mTimer = nullptr;
     gDevices.Empty(true);
@@ -465,7 +613,34 @@ void OSCReceiver::SetReceivePort(int port)
     mDevice = CreateReceiver(log, port);
     mPort = port;
     
+    if (mDevice && mUseReceiveThread)
+      mDevice->StartInputThread();
+    
     if(mLogFunc)
       mLogFunc(log);
   }
 }
+
+void OSCReceiver::StartReceiveThread(const char* paramAddressPrefix)
+{
+  mUseReceiveThread = true;
+
+  // The device may already be read by a thread for another receiver, which must not run while the prefix changes
+  if (mDevice)
+    mDevice->StopInputThread();
+
+  SetLockFreeReceive(true, paramAddressPrefix);
+
+  if (mDevice)
+    mDevice->StartInputThread();
+}
+
+void OSCReceiver::StopReceiveThread()
+{
+  mUseReceiveThread = false;
+
+  if (mDevice)
+    mDevice->StopInputThread();
+
+  SetLockFreeReceive(false, nullptr);
+}
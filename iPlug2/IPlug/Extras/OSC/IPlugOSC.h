@@ -17,10 +17,13 @@
  *
  */
 
+#include <atomic>
+#include <chrono>
 #include <cstring>
 #include <ctime>
 #include <functional>
 #include <memory>
+#include <thread>
 
 #include "jnetlib/jnetlib.h"
 
@@ -28,6 +31,8 @@
 #include "IPlugLogger.h"
 #include "IPlugOSC_msg.h"
 #include "IPlugTimer.h"
+#include "IPlugByteQueue.h"
+#include "IPlugQueue.h"
 
 
 BEGIN_IPLUG_NAMESPACE
@@ -36,6 +41,14 @@ BEGIN_IPLUG_NAMESPACE
 static constexpr int OSC_TIMER_RATE = 100;
 #endif
 
+#ifndef OSC_RECEIVE_QUEUE_SIZE
+static constexpr int OSC_RECEIVE_QUEUE_SIZE = 65536; // bytes of messages waiting for OnOSCMessage(), when receiving on a thread
+#endif
+
+#ifndef OSC_PARAM_QUEUE_SIZE
+static constexpr int OSC_PARAM_QUEUE_SIZE = 1024; // parameter changes waiting for the audio thread
+#endif
+
 using OSCLogFunc = std::function<void(WDL_String& log)>;
 
 /** \todo */
@@ -57,8 +70,21 @@ public:
   /** \todo */
   void RunOutput();
   
+  /** Start a thread that waits on the socket and calls RunInput() as soon as packets arrive, instead of the OSCInterface timer */
+  void StartInputThread();
+  
+  /** Stop the input thread, after which the OSCInterface timer polls the socket again */
+  void StopInputThread();
+  
+  /** @return \c true if the input thread is running */
+  bool IsInputThreadRunning() const { return mInputThread.joinable(); }
+  
   /** \todo */
   void AddInstance(void (*callback)(void* d1, int dev_idx, int msglen, void* msg), void* d1, int dev_idx);
+  
+  /** Remove all the callbacks of an instance, after which it is safe to destroy it
+   * @param d1 The instance passed to AddInstance() */
+  void RemoveInstance(void* d1);
 
   /** \todo
    * @param type 
@@ -80,6 +106,9 @@ private:
   };
 
   WDL_TypedBuf<rec> mInstances;
+  WDL_Mutex mInstancesMutex; // mInstances is read on the input thread
+  std::thread mInputThread;
+  std::atomic<bool> mInputThreadRunning{false};
 public:
   double mLastOpenTime = 0;
   bool mHasInput = false;
@@ -93,6 +122,14 @@ public:
   WDL_Queue mSendQueue, mReceiveQueue;
 };
 
+/** A parameter change received by an OSCReceiver on its receive thread, for the audio thread */
+struct OSCParamChange
+{
+  int paramIdx;
+  double value; // the first argument of the message, as sent
+  int offset; // the sample offset in the block at which to apply the change
+};
+
 /** \todo */
 class OSCInterface
 {
@@ -103,6 +140,14 @@ class OSCInterface
     unsigned char msg[3];
   };
   
+  /** A parameter change as queued by the receive thread */
+  struct ParamMsg
+  {
+    int mParamIdx = 0;
+    double mValue = 0.;
+    std::chrono::steady_clock::time_point mTime;
+  };
+  
 public:
   /** Construct a new OSCInterface object
   * @param logFunc */
@@ -137,17 +182,60 @@ public:
 private:
   static void MessageCallback(void *d1, int dev_idx, int msglen, void *msg);
 
-  void OnTimer(Timer& timer);
+  static void OnTimer(Timer& timer);
+  
+  /** Pass the messages received since the last call to OnOSCMessage(). Called on the main thread */
+  void ProcessIncomingEvents();
+  
+  /** Queue a message received on a device input thread, either as a parameter change for the audio thread or parsed in place for ProcessIncomingEvents() */
+  void QueueMessage(const char* msg, int len, std::chrono::steady_clock::time_point time);
   
   // these are non-owned refs
   WDL_PtrList<OSCDevice> mDevices;
   
 protected:
+  /** Switch between receiving messages from the timer, under a mutex, and receiving them from a device input thread, through lock-free queues. Not thread safe.
+   * @param enable Set \c true when the devices of this interface are read on their input threads
+   * @param paramAddressPrefix See OSCReceiver::StartReceiveThread() */
+  void SetLockFreeReceive(bool enable, const char* paramAddressPrefix);
+  
+  /** Audio thread: get the parameter changes received since the last call, see OSCReceiver::StartReceiveThread() */
+  template <typename F>
+  void ProcessParamChangesImpl(int nFrames, F&& func)
+  {
+    const auto now = std::chrono::steady_clock::now();
+    const double period = std::chrono::duration<double>(now - mLastParamBlockTime).count();
+    ParamMsg msg;
+    
+    while (mParamQueue.Pop(msg))
+    {
+      // Apply the change at the same position in this block as the message arrived in the time since the previous call, one block late but without jitter
+      int offset = 0;
+      
+      if (mLastParamBlockTime.time_since_epoch().count() && period > 0.)
+      {
+        const double fraction = std::chrono::duration<double>(msg.mTime - mLastParamBlockTime).count() / period;
+        offset = static_cast<int>(std::min(std::max(fraction, 0.), 1.) * (nFrames - 1));
+      }
+      
+      func(OSCParamChange{msg.mParamIdx, msg.mValue, offset});
+    }
+    
+    mLastParamBlockTime = now;
+  }
+  
   OSCLogFunc mLogFunc;
   static std::unique_ptr<Timer> mTimer;
   static int sInstances;
+  static WDL_PtrList<OSCInterface> sInterfaces;
   WDL_HeapBuf mIncomingEvents;  // incomingEvent list, each is 8-byte aligned
   WDL_Mutex mIncomingEvents_mutex;
+  
+  std::atomic<bool> mLockFreeReceive{false};
+  IPlugByteQueue mReceiveQueue {OSC_RECEIVE_QUEUE_SIZE}; // OscMessageRead objects followed by the messages they parse, from the input thread to the main thread
+  IPlugQueue<ParamMsg> mParamQueue {OSC_PARAM_QUEUE_SIZE}; // from the input thread to the audio thread
+  WDL_String mParamAddressPrefix;
+  std::chrono::steady_clock::time_point mLastParamBlockTime; // audio thread only
 };
 
 /** \todo */
@@ -189,9 +277,31 @@ public:
   /** \todo */
   virtual void OnOSCMessage(OscMessageRead& msg) = 0;
   
+  /** Receive on a dedicated thread that waits on the socket, rather than polling it from the OSC timer.
+   * Messages are parsed in place into a lock-free queue as soon as they arrive, and OnOSCMessage() is still called on the main thread.
+   * Optionally, messages addressed to a parameter are queued for the audio thread instead, with their arrival time, see ProcessParamChanges().
+   * @param paramAddressPrefix If not nullptr, messages whose address is this prefix followed by a parameter index, e.g. "/param/" for "/param/3",
+   * and whose first argument is a float or an int, are not passed to OnOSCMessage() */
+  void StartReceiveThread(const char* paramAddressPrefix = nullptr);
+  
+  /** Go back to receiving on the OSC timer */
+  void StopReceiveThread();
+  
+  /** Audio thread: call once at the start of each block to get the parameter changes received since the previous block, if StartReceiveThread() was called with a prefix.
+   * Each change has the sample offset in this block at which to apply it, at the same position relative to the block as the message arrived in the time
+   * between the previous two calls. This delays changes by one block, but removes the jitter of the network and the receive thread.
+   * @param nFrames The number of frames in the block
+   * @param func A callable void(const OSCParamChange&), called for each change in the order they arrived */
+  template <typename F>
+  void ProcessParamChanges(int nFrames, F&& func)
+  {
+    ProcessParamChangesImpl(nFrames, std::forward<F>(func));
+  }
+  
 private:
   OSCDevice* mDevice = nullptr;
   int mPort = 0;
+  bool mUseReceiveThread = false;
   char mReadBuf[MAX_OSC_MSG_LEN] = {};
 };
 
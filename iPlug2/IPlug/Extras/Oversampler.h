@@ -14,9 +14,12 @@
 
 #include <functional>
 #include <cmath>
+#include <algorithm>
 
 #include "HIIR/FPUUpsampler2x.h"
 #include "HIIR/FPUDownsampler2x.h"
+#include "HIIR/SSEUpsampler2x4.h"
+#include "HIIR/SSEDownsampler2x4.h"
 
 #include "heapbuf.h"
 #include "ptrlist.h"
@@ -37,12 +40,37 @@ enum EFactor
   kNumFactors
 };
 
-template<typename T = double>
+/** Passed as the FACTOR template argument of OverSampler to choose the factor at runtime with SetOverSampling() */
+static constexpr EFactor kRuntimeFactor = kNumFactors;
+
+/** Up-samples, processes and down-samples audio with cascaded half-band filters.
+ * Define IPLUG_SIMDE at project level to filter groups of four channels in parallel SSE2 lanes in ProcessBlock()
+ * (on non-x86_64 include the SIMDE library in your search paths). A group with fewer than kMinSIMDChans channels, e.g. a mono signal, is filtered by the scalar stages.
+ * The process methods take any callable, which is inlined, so prefer lambdas to std::function on the audio thread.
+ * @tparam T the sampletype
+ * @tparam FACTOR A fixed oversampling factor, which removes the runtime branching on the rate so that per-sample functions can be vectorized,
+ * or kRuntimeFactor to choose the factor with SetOverSampling() */
+template<typename T = double, EFactor FACTOR = kRuntimeFactor>
 class OverSampler
 {
 public:
+  /** \c true if the factor is fixed at compile time */
+  static constexpr bool kFixedFactor = FACTOR != kRuntimeFactor;
+
+#if defined IPLUG_SIMDE
+  /** The number of channels filtered together in SIMD lanes */
+  static constexpr int kNLanes = 4;
+  /** The minimum number of channels in a group for it to use the SIMD lanes */
+  static constexpr int kMinSIMDChans = 2;
+#endif
+
   using BlockProcessFunc = std::function<void(T**, T**, int)>;
   
+  /** OverSampler constructor
+   * @param factor The initial oversampling factor. Ignored if the factor is fixed by the FACTOR template argument
+   * @param blockProcessing Set \c true to allocate buffers for ProcessBlock(), \c false when only using Process() or ProcessGen()
+   * @param nInChannels The maximum number of input channels
+   * @param nOutChannels The maximum number of output channels */
   OverSampler(EFactor factor = kNone, bool blockProcessing = true, int nInChannels = 1, int nOutChannels = 1)
   : mBlockProcessing(blockProcessing)
   , mNInChannels(nInChannels)
@@ -85,8 +113,36 @@ public:
       // ptr location doesn't matter at this stage
       mNextOutputPtrs.Add(mDown2x.Get());
     }
+    
+#if defined IPLUG_SIMDE
+    for (auto g = 0; g < NGroups(mNInChannels); g++)
+    {
+      mSIMDUpsampler2x.Add(new Upsampler2x4SSE<12, T>());
+      mSIMDUpsampler4x.Add(new Upsampler2x4SSE<4, T>());
+      mSIMDUpsampler8x.Add(new Upsampler2x4SSE<3, T>());
+      mSIMDUpsampler16x.Add(new Upsampler2x4SSE<2, T>());
+      
+      mSIMDUpsampler2x.Get(g)->set_coefs(coeffs2x);
+      mSIMDUpsampler4x.Get(g)->set_coefs(coeffs4x);
+      mSIMDUpsampler8x.Get(g)->set_coefs(coeffs8x);
+      mSIMDUpsampler16x.Get(g)->set_coefs(coeffs16x);
+    }
+    
+    for (auto g = 0; g < NGroups(mNOutChannels); g++)
+    {
+      mSIMDDownsampler2x.Add(new Downsampler2x4SSE<12, T>());
+      mSIMDDownsampler4x.Add(new Downsampler2x4SSE<4, T>());
+      mSIMDDownsampler8x.Add(new Downsampler2x4SSE<3, T>());
+      mSIMDDownsampler16x.Add(new Downsampler2x4SSE<2, T>());
+      
+      mSIMDDownsampler2x.Get(g)->set_coefs(coeffs2x);
+      mSIMDDownsampler4x.Get(g)->set_coefs(coeffs4x);
+      mSIMDDownsampler8x.Get(g)->set_coefs(coeffs8x);
+      mSIMDDownsampler16x.Get(g)->set_coefs(coeffs16x);
+    }
+#endif
         
-    SetOverSampling(factor);
+    SetOverSampling(kFixedFactor ? FACTOR : factor);
     
     Reset();
   }
@@ -101,6 +157,16 @@ public:
     mDownsampler8x.Empty(true);
     mUpsampler16x.Empty(true);
     mDownsampler16x.Empty(true);
+#if defined IPLUG_SIMDE
+    mSIMDUpsampler2x.Empty(true);
+    mSIMDDownsampler2x.Empty(true);
+    mSIMDUpsampler4x.Empty(true);
+    mSIMDDownsampler4x.Empty(true);
+    mSIMDUpsampler8x.Empty(true);
+    mSIMDDownsampler8x.Empty(true);
+    mSIMDUpsampler16x.Empty(true);
+    mSIMDDownsampler16x.Empty(true);
+#endif
   }
 
   OverSampler(const OverSampler&) = delete;
@@ -165,6 +231,29 @@ public:
       mDown8BufferPtrs.Add(mDown8x.Get() + (c * 8 * blockSize));
       mDown16BufferPtrs.Add(mDown16x.Get() + (c * 16 * blockSize));
     }
+    
+#if defined IPLUG_SIMDE
+    for (auto g = 0; g < NGroups(mNInChannels); g++)
+    {
+      mSIMDUpsampler2x.Get(g)->clear_buffers();
+      mSIMDUpsampler4x.Get(g)->clear_buffers();
+      mSIMDUpsampler8x.Get(g)->clear_buffers();
+      mSIMDUpsampler16x.Get(g)->clear_buffers();
+    }
+    
+    for (auto g = 0; g < NGroups(mNOutChannels); g++)
+    {
+      mSIMDDownsampler2x.Get(g)->clear_buffers();
+      mSIMDDownsampler4x.Get(g)->clear_buffers();
+      mSIMDDownsampler8x.Get(g)->clear_buffers();
+      mSIMDDownsampler16x.Get(g)->clear_buffers();
+    }
+    
+    for (auto f = 0; f < kNumFactors; f++)
+    {
+      mLanes[f].Resize(kNLanes * (1 << f) * blockSize);
+    }
+#endif
   }
 
   /** Over sample an input block with a per-block function (up sample input -> process with function -> down sample)
@@ -173,15 +262,17 @@ public:
    * @param nFrames The block size for this block: number of samples per channel.
    * @param nInChans The number of input channels to process. Must be less or equal to the number of channels passed to the constructor
    * @param nOutChans The number of output channels to process. Must be less or equal to the number of channels passed to the constructor
-   * @param func The function that processes the audio sample at the higher sampling rate. NOTE: std::function can call malloc if you pass in captures */
-  void ProcessBlock(T** inputs, T** outputs, int nFrames, int nInChans, int nOutChans, BlockProcessFunc func)
+   * @param func A callable with the signature of BlockProcessFunc, that processes the audio at the higher sampling rate. It is called GetRate() times with nFrames samples per channel.
+   * NOTE: a std::function can call malloc if you pass in captures, a lambda is inlined and does not */
+  template <typename F>
+  void ProcessBlock(T** inputs, T** outputs, int nFrames, int nInChans, int nOutChans, F&& func)
   {
     assert(nInChans <= mNInChannels);
     assert(nOutChans <= mNOutChannels);
     
-    if (mRate != mPrevRate)
+    if (GetRate() != mPrevRate)
     {
-      switch (mRate) {
+      switch (GetRate()) {
         case 2:
           mInPtrLoopSrc = &mUp2BufferPtrs;
           mOutPtrLoopSrc = &mDown2BufferPtrs;
@@ -202,28 +293,42 @@ public:
           break;
       }
       
-      mPrevRate = mRate;
+      mPrevRate = GetRate();
+    }
+
+    auto firstScalarInChan = 0;
+    auto firstScalarOutChan = 0;
+    
+#if defined IPLUG_SIMDE
+    if (GetRate() >= 2)
+    {
+      firstScalarInChan = NSIMDChans(nInChans);
+      firstScalarOutChan = NSIMDChans(nOutChans);
+      
+      for (auto c = 0; c < firstScalarInChan; c += kNLanes)
+        UpsampleLanes(c / kNLanes, inputs + c, std::min(nInChans - c, kNLanes), nFrames);
     }
+#endif
 
-    for (auto c = 0; c < nInChans; c++) {
-      if (mRate >= 2) {
+    for (auto c = firstScalarInChan; c < nInChans; c++) {
+      if (GetRate() >= 2) {
         mUpsampler2x.Get(c)->process_block(mUp2BufferPtrs.Get(c), inputs[c], nFrames);
       }
-      if (mRate >= 4) {
+      if (GetRate() >= 4) {
         mUpsampler4x.Get(c)->process_block(mUp4BufferPtrs.Get(c), mUp2BufferPtrs.Get(c), nFrames * 2);
       }
-      if (mRate >= 8) {
+      if (GetRate() >= 8) {
         mUpsampler8x.Get(c)->process_block(mUp8BufferPtrs.Get(c), mUp4BufferPtrs.Get(c), nFrames * 4);
       }
-      if (mRate == 16) {
+      if (GetRate() == 16) {
         mUpsampler16x.Get(c)->process_block(mUp16BufferPtrs.Get(c), mUp8BufferPtrs.Get(c), nFrames * 8);
       }
     }
     
-    if (mRate == 1) {
+    if (GetRate() == 1) {
       func(inputs, outputs, nFrames);
     } else {
-      for (auto i = 0; i < mRate; i++) {
+      for (auto i = 0; i < GetRate(); i++) {
         for (auto c = 0; c < nInChans; c++) {
           mNextInputPtrs.Set(c, mInPtrLoopSrc->Get(c) + (i * nFrames));
           mNextOutputPtrs.Set(c, mOutPtrLoopSrc->Get(c) + (i * nFrames));
@@ -232,17 +337,22 @@ public:
       }
     }
     
-    for (auto c = 0; c < nOutChans; c++) {
-      if (mRate == 16) {
+#if defined IPLUG_SIMDE
+    for (auto c = 0; c < firstScalarOutChan; c += kNLanes)
+      DownsampleLanes(c / kNLanes, outputs + c, std::min(nOutChans - c, kNLanes), nFrames);
+#endif
+
+    for (auto c = firstScalarOutChan; c < nOutChans; c++) {
+      if (GetRate() == 16) {
         mDownsampler16x.Get(c)->process_block(mDown8BufferPtrs.Get(c), mDown16BufferPtrs.Get(c), nFrames * 8);
       }
-      if (mRate >= 8) {
+      if (GetRate() >= 8) {
         mDownsampler8x.Get(c)->process_block(mDown4BufferPtrs.Get(c), mDown8BufferPtrs.Get(c), nFrames * 4);
       }
-      if (mRate >= 4) {
+      if (GetRate() >= 4) {
         mDownsampler4x.Get(c)->process_block(mDown2BufferPtrs.Get(c), mDown4BufferPtrs.Get(c), nFrames * 2);
       }
-      if (mRate >= 2) {
+      if (GetRate() >= 2) {
         mDownsampler2x.Get(c)->process_block(outputs[c], mDown2BufferPtrs.Get(c), nFrames);
       }
     }
@@ -250,13 +360,14 @@ public:
   
   /** Over sample an input sample with a per-sample function (up-sample input -> process with function -> down-sample)
    * @param input The audio sample to input
-   * @param std::function<double(double)> The function that processes the audio sample at the higher sampling rate. NOTE: std::function can call malloc if you pass in captures
+   * @param func A callable T(T) that processes the audio sample at the higher sampling rate. NOTE: a std::function can call malloc if you pass in captures, a lambda is inlined and does not
    * @return The audio sample output */
-  T Process(T input, std::function<T(T)> func)
+  template <typename F>
+  T Process(T input, F&& func)
   {
     T output;
 
-    if (mRate == 16)
+    if (GetRate() == 16)
     {
       mUpsampler2x.Get(0)->process_sample(mUp2x.Get()[0], mUp2x.Get()[1], input);
       mUpsampler4x.Get(0)->process_block(mUp4x.Get(), mUp2x.Get(), 2);
@@ -273,7 +384,7 @@ public:
       mDownsampler4x.Get(0)->process_block(mDown2x.Get(), mDown4x.Get(), 2);
       output = mDownsampler2x.Get(0)->process_sample(mDown2x.Get());
     }
-    else if (mRate == 8)
+    else if (GetRate() == 8)
     {
       mUpsampler2x.Get(0)->process_sample(mUp2x.Get()[0], mUp2x.Get()[1], input);
       mUpsampler4x.Get(0)->process_block(mUp4x.Get(), mUp2x.Get(), 2);
@@ -288,7 +399,7 @@ public:
       mDownsampler4x.Get(0)->process_block(mDown2x.Get(), mDown4x.Get(), 2);
       output = mDownsampler2x.Get(0)->process_sample(mDown2x.Get());
     }
-    else if (mRate == 4)
+    else if (GetRate() == 4)
     {
       mUpsampler2x.Get(0)->process_sample(mUp2x.Get()[0], mUp2x.Get()[1], input);
       mUpsampler4x.Get(0)->process_block(mUp4x.Get(), mUp2x.Get(), 2);
@@ -301,7 +412,7 @@ public:
       mDownsampler4x.Get(0)->process_block(mDown2x.Get(), mDown4x.Get(), 2);
       output = mDownsampler2x.Get(0)->process_sample(mDown2x.Get());
     }
-    else if (mRate == 2)
+    else if (GetRate() == 2)
     {
       mUpsampler2x.Get(0)->process_sample(mUp2x.Get()[0], mUp2x.Get()[1], input);
 
@@ -318,9 +429,10 @@ public:
   }
 
   /** Over-sample an per-sample synthesis function
-   * @param genFunc The function that generates the audio sample
+   * @param genFunc A callable T() that generates the audio sample
    * @return The audio sample output */
-  T ProcessGen(std::function<T()> genFunc)
+  template <typename F>
+  T ProcessGen(F&& genFunc)
   {
     auto ProcessDown16x = [&](T input)
     {
@@ -381,11 +493,11 @@ public:
 
     T output;
 
-    for (int j = 0; j < mRate; j++)
+    for (int j = 0; j < GetRate(); j++)
     {
       output = genFunc();
 
-      switch(mRate)
+      switch(GetRate())
       {
         case 2: ProcessDown2x(output); break;
         case 4: ProcessDown4x(output); break;
@@ -395,14 +507,17 @@ public:
       }
     }
 
-    if (mRate > 1)
+    if (GetRate() > 1)
       output = mDownSamplerOutput;
 
     return output;
   }
 
+  /** Set the oversampling factor. If the factor is fixed by the FACTOR template argument, it must match */
   void SetOverSampling(EFactor factor)
   {
+    assert(!kFixedFactor || factor == FACTOR);
+    
     if (factor != mFactor)
     {
       mFactor = factor;
@@ -427,10 +542,97 @@ public:
   
   int GetRate() const
   {
-    return mRate;
+    if constexpr (kFixedFactor)
+      return 1 << FACTOR;
+    else
+      return mRate;
+  }
+  
+  EFactor GetFactor() const
+  {
+    if constexpr (kFixedFactor)
+      return FACTOR;
+    else
+      return mFactor;
   }
 
 private:
+#if defined IPLUG_SIMDE
+  static int NGroups(int nChans)
+  {
+    return (nChans + kNLanes - 1) / kNLanes;
+  }
+  
+  /** @return The number of channels, starting from the first, that are filtered in SIMD lanes */
+  static int NSIMDChans(int nChans)
+  {
+    const int nLeftOver = nChans % kNLanes;
+    return nLeftOver >= kMinSIMDChans ? nChans : nChans - nLeftOver;
+  }
+  
+  /** Interleave up to kNLanes channels, cascade them through the SIMD up-samplers of a group and write the result to the per-channel buffers */
+  void UpsampleLanes(int group, T** inputs, int nChans, int nFrames)
+  {
+    T* pLanes = mLanes[kNone].Get();
+
+    for (auto s = 0; s < nFrames; s++)
+    {
+      for (auto l = 0; l < kNLanes; l++)
+        pLanes[s * kNLanes + l] = l < nChans ? inputs[l][s] : T(0);
+    }
+    
+    mSIMDUpsampler2x.Get(group)->process_block(mLanes[k2x].Get(), pLanes, nFrames);
+    if (GetRate() >= 4)
+      mSIMDUpsampler4x.Get(group)->process_block(mLanes[k4x].Get(), mLanes[k2x].Get(), nFrames * 2);
+    if (GetRate() >= 8)
+      mSIMDUpsampler8x.Get(group)->process_block(mLanes[k8x].Get(), mLanes[k4x].Get(), nFrames * 4);
+    if (GetRate() == 16)
+      mSIMDUpsampler16x.Get(group)->process_block(mLanes[k16x].Get(), mLanes[k8x].Get(), nFrames * 8);
+    
+    const T* pUp = mLanes[GetFactor()].Get();
+    const int nUpFrames = nFrames * GetRate();
+
+    for (auto l = 0; l < nChans; l++)
+    {
+      T* pDest = mInPtrLoopSrc->Get(group * kNLanes + l);
+      
+      for (auto s = 0; s < nUpFrames; s++)
+        pDest[s] = pUp[s * kNLanes + l];
+    }
+  }
+  
+  /** Interleave up to kNLanes channels from the per-channel buffers, cascade them through the SIMD down-samplers of a group and write the result to outputs */
+  void DownsampleLanes(int group, T** outputs, int nChans, int nFrames)
+  {
+    T* pDown = mLanes[GetFactor()].Get();
+    const int nUpFrames = nFrames * GetRate();
+
+    for (auto l = 0; l < kNLanes; l++)
+    {
+      const T* pSrc = l < nChans ? mOutPtrLoopSrc->Get(group * kNLanes + l) : nullptr;
+      
+      for (auto s = 0; s < nUpFrames; s++)
+        pDown[s * kNLanes + l] = pSrc ? pSrc[s] : T(0);
+    }
+    
+    if (GetRate() == 16)
+      mSIMDDownsampler16x.Get(group)->process_block(mLanes[k8x].Get(), mLanes[k16x].Get(), nFrames * 8);
+    if (GetRate() >= 8)
+      mSIMDDownsampler8x.Get(group)->process_block(mLanes[k4x].Get(), mLanes[k8x].Get(), nFrames * 4);
+    if (GetRate() >= 4)
+      mSIMDDownsampler4x.Get(group)->process_block(mLanes[k2x].Get(), mLanes[k4x].Get(), nFrames * 2);
+    mSIMDDownsampler2x.Get(group)->process_block(mLanes[kNone].Get(), mLanes[k2x].Get(), nFrames);
+    
+    const T* pLanes = mLanes[kNone].Get();
+
+    for (auto l = 0; l < nChans; l++)
+    {
+      for (auto s = 0; s < nFrames; s++)
+        outputs[l][s] = pLanes[s * kNLanes + l];
+    }
+  }
+#endif
+
   EFactor mFactor = kNone;
   int mPrevRate = 0;
   int mRate = 1;
@@ -479,6 +681,22 @@ private:
   WDL_PtrList<Downsampler2xFPU<4, T>> mDownsampler4x;  // decimator for 4x to 2x SR
   WDL_PtrList<Downsampler2xFPU<3, T>> mDownsampler8x;  // decimator for 8x to 4x SR
   WDL_PtrList<Downsampler2xFPU<2, T>> mDownsampler16x; // decimator for 16x to 8x SR
+  
+#if defined IPLUG_SIMDE
+  //Ptrs to oversamplers for each group of kNLanes channels
+  WDL_PtrList<Upsampler2x4SSE<12, T>> mSIMDUpsampler2x;
+  WDL_PtrList<Upsampler2x4SSE<4, T>> mSIMDUpsampler4x;
+  WDL_PtrList<Upsampler2x4SSE<3, T>> mSIMDUpsampler8x;
+  WDL_PtrList<Upsampler2x4SSE<2, T>> mSIMDUpsampler16x;
+
+  WDL_PtrList<Downsampler2x4SSE<12, T>> mSIMDDownsampler2x;
+  WDL_PtrList<Downsampler2x4SSE<4, T>> mSIMDDownsampler4x;
+  WDL_PtrList<Downsampler2x4SSE<3, T>> mSIMDDownsampler8x;
+  WDL_PtrList<Downsampler2x4SSE<2, T>> mSIMDDownsampler16x;
+  
+  // Interleaved scratch buffers for one group, indexed by EFactor. Shared by all groups, up- and down-sampling
+  WDL_TypedBuf<T> mLanes[kNumFactors];
+#endif
 };
 
 END_IPLUG_NAMESPACE
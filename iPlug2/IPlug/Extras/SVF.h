@@ -18,12 +18,25 @@
 
 #include <complex>
 
+#if defined IPLUG_SIMDE
+  #if defined(__arm64__)
+    #define SIMDE_ENABLE_NATIVE_ALIASES
+    #include "simde/x86/sse2.h"
+  #else
+    #include <emmintrin.h>
+  #endif
+#endif
+
 #include "IPlugPlatform.h"
 
 BEGIN_IPLUG_NAMESPACE
 
 #define SVFMODES_VALIST "LowPass", "HighPass", "BandPass", "Notch", "Peak", "Bell", "LowPassShelf", "HighPassShelf"
 
+/** A multi-channel state variable filter. All channels share the same settings.
+ * Define IPLUG_SIMDE at project level to process pairs of channels in SSE2 lanes (on non-x86_64 include the SIMDE library in your search paths).
+ * @tparam T the sampletype
+ * @tparam NC the maximum number of channels */
 template<typename T = double, int NC = 1>
 class SVF
 {
@@ -102,143 +115,279 @@ public:
     if(mState != mNewState)
       UpdateCoefficients();
 
-    for (auto c = 0; c < nChans; c++)
+    int c = 0;
+
+#ifdef IPLUG_SIMDE
+    for (; c + 1 < nChans; c += 2)
+      ProcessChannelPair(inputs, outputs, c, nFrames);
+#endif
+
+    for (; c < nChans; c++)
     {
       for (auto s = 0; s < nFrames; s++)
-      {
-        const double v0 = static_cast<double>(inputs[c][s]);
+        outputs[c][s] = Tick(c, inputs[c][s], mCoeffs);
+    }
+  }
 
-        mV3[c] = v0 - mIc2eq[c];
-        mV1[c] = m_a1 * mIc1eq[c] + m_a2*mV3[c];
-        mV2[c] = mIc2eq[c] + m_a2 * mIc1eq[c] + m_a3 * mV3[c];
-        mIc1eq[c] = 2.0 * mV1[c] - mIc1eq[c];
-        mIc2eq[c] = 2.0 * mV2[c] - mIc2eq[c];
+  /** Process a block with the cutoff frequency (and optionally Q) modulated at audio rate. The modulation is shared by all channels.
+   * The coefficients are recalculated for every sample, using FastTan() rather than std::tan(). The other settings are taken from the setters as usual
+   * @param inputs The input channel arrays
+   * @param outputs The output channel arrays
+   * @param nChans The number of channels to process
+   * @param nFrames The number of samples to process
+   * @param pFreqCPS nFrames cutoff frequencies in Hz, clipped in the same way as SetFreqCPS() and to below nyquist
+   * @param pQ nFrames Q values clipped in the same way as SetQ(), or nullptr to use the value from SetQ() */
+  void ProcessBlock(T** inputs, T** outputs, int nChans, int nFrames, const T* pFreqCPS, const T* pQ = nullptr)
+  {
+    assert(nChans <= NC);
 
-        outputs[c][s] = static_cast<T>(m_m0) * static_cast<T>(v0) + 
-                       static_cast<T>(m_m1) * static_cast<T>(mV1[c]) + 
-                       static_cast<T>(m_m2) * static_cast<T>(mV2[c]);
-      }
+    if(mState != mNewState)
+      UpdateCoefficients();
+
+    const EMode mode = mState.mode;
+    const double A = std::pow(10., mState.gain/40.);
+    const double sqrtA = std::sqrt(A);
+    const double piOverSampleRate = PI / mState.sampleRate;
+    const double maxFreq = std::min(20000., 0.499 * mState.sampleRate);
+    double k = 1. / mState.Q;
+
+    Coefficients coeffs;
+
+    for (auto s = 0; s < nFrames; s++)
+    {
+      const double freq = Clip(static_cast<double>(pFreqCPS[s]), 10., maxFreq);
+
+      if (pQ)
+        k = 1. / Clip(static_cast<double>(pQ[s]), 0.1, 100.);
+
+      CalculateCoefficients(mode, FastTan(piOverSampleRate * freq), k, A, sqrtA, coeffs);
+
+      int c = 0;
+
+#ifdef IPLUG_SIMDE
+      for (; c + 1 < nChans; c += 2)
+        TickPair(inputs, outputs, c, s, coeffs);
+#endif
+
+      for (; c < nChans; c++)
+        outputs[c][s] = Tick(c, inputs[c][s], coeffs);
     }
   }
 
+  /** A rational approximation of tan(x) for 0 <= x < pi/2, with a relative error below 2e-6. Larger arguments are reflected around pi/4 so that the approximation is only evaluated on [0, pi/4]
+   * @param x The argument in radians
+   * @return An approximation of tan(x) */
+  static inline double FastTan(double x)
+  {
+    const bool reflect = x > PI * 0.25;
+
+    if (reflect)
+      x = PI * 0.5 - x;
+
+    const double x2 = x * x;
+    const double t = x * (135135. - x2 * (17325. - x2 * 378.)) / (135135. - x2 * (62370. - x2 * (3150. - x2 * 28.)));
+
+    return reflect ? 1. / t : t;
+  }
+
   void Reset()
   {
     for (auto c = 0; c < NC; c++)
     {
-      mV1[c] = 0.;
-      mV2[c] = 0.;
-      mV3[c] = 0.;
       mIc1eq[c] = 0.;
       mIc2eq[c] = 0.;
     }
   }
 
 private:
+  struct Coefficients
+  {
+    double a1 = 0.;
+    double a2 = 0.;
+    double a3 = 0.;
+    double m0 = 0.;
+    double m1 = 0.;
+    double m2 = 0.;
+  };
+
+  inline T Tick(int c, T input, const Coefficients& co)
+  {
+    const double v0 = static_cast<double>(input);
+    const double v3 = v0 - mIc2eq[c];
+    const double v1 = co.a1 * mIc1eq[c] + co.a2 * v3;
+    const double v2 = mIc2eq[c] + co.a2 * mIc1eq[c] + co.a3 * v3;
+    mIc1eq[c] = 2.0 * v1 - mIc1eq[c];
+    mIc2eq[c] = 2.0 * v2 - mIc2eq[c];
+
+    return static_cast<T>(co.m0) * static_cast<T>(v0) +
+           static_cast<T>(co.m1) * static_cast<T>(v1) +
+           static_cast<T>(co.m2) * static_cast<T>(v2);
+  }
+
+#ifdef IPLUG_SIMDE
+  /** Process channels c and c + 1 for a block with fixed coefficients, keeping the filter state in registers */
+  void ProcessChannelPair(T** inputs, T** outputs, int c, int nFrames)
+  {
+    const __m128d a1 = _mm_set1_pd(mCoeffs.a1);
+    const __m128d a2 = _mm_set1_pd(mCoeffs.a2);
+    const __m128d a3 = _mm_set1_pd(mCoeffs.a3);
+    const __m128d m0 = _mm_set1_pd(mCoeffs.m0);
+    const __m128d m1 = _mm_set1_pd(mCoeffs.m1);
+    const __m128d m2 = _mm_set1_pd(mCoeffs.m2);
+
+    __m128d ic1eq = _mm_loadu_pd(mIc1eq + c);
+    __m128d ic2eq = _mm_loadu_pd(mIc2eq + c);
+
+    const T* pIn0 = inputs[c];
+    const T* pIn1 = inputs[c + 1];
+    T* pOut0 = outputs[c];
+    T* pOut1 = outputs[c + 1];
+
+    for (auto s = 0; s < nFrames; s++)
+    {
+      const __m128d v0 = _mm_set_pd(static_cast<double>(pIn1[s]), static_cast<double>(pIn0[s]));
+      const __m128d y = Tick(v0, ic1eq, ic2eq, a1, a2, a3, m0, m1, m2);
+
+      pOut0[s] = static_cast<T>(_mm_cvtsd_f64(y));
+      pOut1[s] = static_cast<T>(_mm_cvtsd_f64(_mm_unpackhi_pd(y, y)));
+    }
+
+    _mm_storeu_pd(mIc1eq + c, ic1eq);
+    _mm_storeu_pd(mIc2eq + c, ic2eq);
+  }
+
+  /** Process one sample of channels c and c + 1 */
+  inline void TickPair(T** inputs, T** outputs, int c, int s, const Coefficients& co)
+  {
+    __m128d ic1eq = _mm_loadu_pd(mIc1eq + c);
+    __m128d ic2eq = _mm_loadu_pd(mIc2eq + c);
+
+    const __m128d v0 = _mm_set_pd(static_cast<double>(inputs[c + 1][s]), static_cast<double>(inputs[c][s]));
+    const __m128d y = Tick(v0, ic1eq, ic2eq, _mm_set1_pd(co.a1), _mm_set1_pd(co.a2), _mm_set1_pd(co.a3), _mm_set1_pd(co.m0), _mm_set1_pd(co.m1), _mm_set1_pd(co.m2));
+
+    outputs[c][s] = static_cast<T>(_mm_cvtsd_f64(y));
+    outputs[c + 1][s] = static_cast<T>(_mm_cvtsd_f64(_mm_unpackhi_pd(y, y)));
+
+    _mm_storeu_pd(mIc1eq + c, ic1eq);
+    _mm_storeu_pd(mIc2eq + c, ic2eq);
+  }
+
+  static inline __m128d Tick(__m128d v0, __m128d& ic1eq, __m128d& ic2eq, __m128d a1, __m128d a2, __m128d a3, __m128d m0, __m128d m1, __m128d m2)
+  {
+    const __m128d v3 = _mm_sub_pd(v0, ic2eq);
+    const __m128d v1 = _mm_add_pd(_mm_mul_pd(a1, ic1eq), _mm_mul_pd(a2, v3));
+    const __m128d v2 = _mm_add_pd(ic2eq, _mm_add_pd(_mm_mul_pd(a2, ic1eq), _mm_mul_pd(a3, v3)));
+    ic1eq = _mm_sub_pd(_mm_add_pd(v1, v1), ic1eq);
+    ic2eq = _mm_sub_pd(_mm_add_pd(v2, v2), ic2eq);
+
+    return _mm_add_pd(_mm_mul_pd(m0, v0), _mm_add_pd(_mm_mul_pd(m1, v1), _mm_mul_pd(m2, v2)));
+  }
+#endif
+
   void UpdateCoefficients()
   {
     mState = mNewState;
 
-    const double w = std::tan(PI * mState.freq/mState.sampleRate);
+    const double A = std::pow(10., mState.gain/40.);
+    CalculateCoefficients(mState.mode, std::tan(PI * mState.freq/mState.sampleRate), 1. / mState.Q, A, std::sqrt(A), mCoeffs);
+  }
 
-    switch(mState.mode)
+  /** Calculate the coefficients for a mode
+   * @param mode The filter mode
+   * @param w The prewarped cutoff, tan(pi * freq / sampleRate)
+   * @param k The damping, 1 / Q
+   * @param A The shelf/bell gain, 10^(gain/40)
+   * @param sqrtA The square root of A */
+  static inline void CalculateCoefficients(EMode mode, double w, double k, double A, double sqrtA, Coefficients& co)
+  {
+    switch(mode)
     {
       case kLowPass:
       {
         const double g = w;
-        const double k = 1. / mState.Q;
-        m_a1 = 1./(1. + g * (g + k));
-        m_a2 = g * m_a1;
-        m_a3 = g * m_a2;
-        m_m0 = 0;
-        m_m1 = 0;
-        m_m2 = 1.;
+        co.a1 = 1./(1. + g * (g + k));
+        co.a2 = g * co.a1;
+        co.a3 = g * co.a2;
+        co.m0 = 0;
+        co.m1 = 0;
+        co.m2 = 1.;
         break;
       }
       case kHighPass:
       {
         const double g = w;
-        const double k = 1. / mState.Q;
-        m_a1 = 1./(1. + g * (g + k));
-        m_a2 = g * m_a1;
-        m_a3 = g * m_a2;
-        m_m0 = 1.;
-        m_m1 = -k;
-        m_m2 = -1.;
+        co.a1 = 1./(1. + g * (g + k));
+        co.a2 = g * co.a1;
+        co.a3 = g * co.a2;
+        co.m0 = 1.;
+        co.m1 = -k;
+        co.m2 = -1.;
         break;
       }
       case kBandPass:
       {
         const double g = w;
-        const double k = 1. / mState.Q;
-        m_a1 = 1./(1. + g * (g + k));
-        m_a2 = g * m_a1;
-        m_a3 = g * m_a2;
-        m_m0 = 0.;
-        m_m1 = 1.;
-        m_m2 = 0.;
+        co.a1 = 1./(1. + g * (g + k));
+        co.a2 = g * co.a1;
+        co.a3 = g * co.a2;
+        co.m0 = 0.;
+        co.m1 = 1.;
+        co.m2 = 0.;
         break;
       }
       case kNotch:
       {
         const double g = w;
-        const double k = 1. / mState.Q;
-        m_a1 = 1./(1. + g * (g + k));
-        m_a2 = g * m_a1;
-        m_a3 = g * m_a2;
-        m_m0 = 1.;
-        m_m1 = -k;
-        m_m2 = 0.;
+        co.a1 = 1./(1. + g * (g + k));
+        co.a2 = g * co.a1;
+        co.a3 = g * co.a2;
+        co.m0 = 1.;
+        co.m1 = -k;
+        co.m2 = 0.;
         break;
       }
       case kPeak:
       {
         const double g = w;
-        const double k = 1. / mState.Q;
-        m_a1 = 1./(1. + g * (g + k));
-        m_a2 = g * m_a1;
-        m_a3 = g * m_a2;
-        m_m0 = 1.;
-        m_m1 = -k;
-        m_m2 = -2.;
+        co.a1 = 1./(1. + g * (g + k));
+        co.a2 = g * co.a1;
+        co.a3 = g * co.a2;
+        co.m0 = 1.;
+        co.m1 = -k;
+        co.m2 = -2.;
         break;
       }
       case kBell:
       {
-        const double A = std::pow(10., mState.gain/40.);
         const double g = w;
-        const double k = 1 / mState.Q;
-        m_a1 = 1./(1. + g * (g + k));
-        m_a2 = g * m_a1;
-        m_a3 = g * m_a2;
-        m_m0 = 1.;
-        m_m1 = k * (A * A - 1.);
-        m_m2 = 0.;
+        co.a1 = 1./(1. + g * (g + k));
+        co.a2 = g * co.a1;
+        co.a3 = g * co.a2;
+        co.m0 = 1.;
+        co.m1 = k * (A * A - 1.);
+        co.m2 = 0.;
         break;
       }
       case kLowPassShelf:
       {
-        const double A = std::pow(10., mState.gain/40.);
-        const double g = w / std::sqrt(A);
-        const double k = 1. / mState.Q;
-        m_a1 = 1./(1. + g * (g + k));
-        m_a2 = g * m_a1;
-        m_a3 = g * m_a2;
-        m_m0 = 1.;
-        m_m1 = k * (A - 1.);
-        m_m2 = (A * A - 1.);
+        const double g = w / sqrtA;
+        co.a1 = 1./(1. + g * (g + k));
+        co.a2 = g * co.a1;
+        co.a3 = g * co.a2;
+        co.m0 = 1.;
+        co.m1 = k * (A - 1.);
+        co.m2 = (A * A - 1.);
         break;
       }
       case kHighPassShelf:
       {
-        const double A = std::pow(10., mState.gain/40.);
-        const double g = w / std::sqrt(A);
-        const double k = 1. / mState.Q;
-        m_a1 = 1./(1. + g * (g + k));
-        m_a2 = g * m_a1;
-        m_a3 = g * m_a2;
-        m_m0 = A*A;
-        m_m1 = k*(1. - A)*A;
-        m_m2 = (1. - A*A);
+        const double g = w / sqrtA;
+        co.a1 = 1./(1. + g * (g + k));
+        co.a2 = g * co.a1;
+        co.a3 = g * co.a2;
+        co.m0 = A*A;
+        co.m1 = k*(1. - A)*A;
+        co.m2 = (1. - A*A);
         break;
       }
       default:
@@ -247,17 +396,9 @@ private:
   }
 
 private:
-  double mV1[NC] = {};
-  double mV2[NC] = {};
-  double mV3[NC] = {};
   double mIc1eq[NC] = {};
   double mIc2eq[NC] = {};
-  double m_a1 = 0.;
-  double m_a2 = 0.;
-  double m_a3 = 0.;
-  double m_m0 = 0.;
-  double m_m1 = 0.;
-  double m_m2 = 0.;
+  Coefficients mCoeffs;
 
   struct Settings
   {
@@ -482,6 +482,20 @@ void MidiSynth::SetSampleRateAndBlockSize(double sampleRate, int blockSize)
   mMidiQueue.Resize(blockSize);
   mVoiceAllocator.SetSampleRateAndBlockSize(sampleRate, blockSize);
 
+  if(mNRenderThreads > 0)
+  {
+    if(!mRenderPool)
+      mRenderPool = std::make_unique<VoiceRenderPool>();
+
+    mRenderPool->Prepare(mNRenderThreads, static_cast<int>(NVoices()), mRenderMaxOutputChans, blockSize);
+    mVoiceAllocator.SetRenderPool(mRenderPool.get(), mMinVoicesForPool);
+  }
+  else
+  {
+    mVoiceAllocator.SetRenderPool(nullptr, 0);
+    mRenderPool = nullptr;
+  }
+
   for(int v = 0; v < NVoices(); v++)
   {
     GetVoice(v)->SetSampleRateAndBlockSize(sampleRate, blockSize);
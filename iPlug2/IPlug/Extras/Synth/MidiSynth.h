@@ -57,6 +57,18 @@ public:
 
   void SetSampleRateAndBlockSize(double sampleRate, int blockSize);
 
+  /** Render busy voices on worker threads as well as the audio thread. The pool is created in SetSampleRateAndBlockSize(), so call this before that.
+   * Your voices must not share mutable state if you use this.
+   * @param nThreads The number of worker threads in addition to the audio thread, 0 (the default) renders all voices serially on the audio thread
+   * @param maxOutputChans The maximum number of output channels that will be passed to ProcessBlock(). Blocks with more channels are rendered serially
+   * @param minVoicesForPool If fewer voices than this are busy, they are rendered serially, since waking the workers would cost more than it saves */
+  void SetRenderThreads(int nThreads, int maxOutputChans = 2, int minVoicesForPool = 8)
+  {
+    mNRenderThreads = nThreads;
+    mRenderMaxOutputChans = maxOutputChans;
+    mMinVoicesForPool = minVoicesForPool;
+  }
+
   /** If you are using this class in a non-traditional mode of polyphony (e.g.to stack loads of voices) you might want to manually SetVoicesActive()
    * usually this would happen when you trigger notes
    * @param active should the class report that voices are active */
@@ -194,6 +206,10 @@ private:
 
   // basic MIDI data
   VoiceAllocator mVoiceAllocator;
+  std::unique_ptr<VoiceRenderPool> mRenderPool;
+  int mNRenderThreads = 0;
+  int mRenderMaxOutputChans = 2;
+  int mMinVoicesForPool = 8;
   uint16_t mUnisonVoices{1};
   IMidiQueue mMidiQueue;
   float mVelocityLUT[128];
@@ -56,6 +56,7 @@ void VoiceAllocator::AddVoice(SynthVoice* pVoice, uint8_t zone)
   if(mVoicePtrs.size() + 1 < UCHAR_MAX)
   {
     mVoicePtrs.push_back(pVoice);
+    mBusyVoicePtrs.resize(mVoicePtrs.size());
     ClearVoiceInputs(pVoice);
     pVoice->mKey = -1;
     pVoice->mZone = zone;
@@ -529,9 +530,29 @@ void VoiceAllocator::NoteOff(VoiceInputEvent e, int64_t sampleTime)
 
 void VoiceAllocator::ProcessVoices(sample** inputs, sample** outputs, int nInputs, int nOutputs, int startIndex, int blockSize)
 {
+  if(mRenderPool)
+  {
+    int nBusy = 0;
+
+    for(auto pVoice : mVoicePtrs)
+    {
+      if(pVoice->GetBusy())
+        mBusyVoicePtrs[nBusy++] = pVoice;
+    }
+
+    if(nBusy >= mMinVoicesForPool && mRenderPool->ProcessVoices(mBusyVoicePtrs.data(), nBusy, inputs, outputs, nInputs, nOutputs, startIndex, blockSize))
+      return;
+
+    for(int i = 0; i < nBusy; i++)
+    {
+      mBusyVoicePtrs[i]->ProcessSamplesAccumulating(inputs, outputs, nInputs, nOutputs, startIndex, blockSize);
+    }
+
+    return;
+  }
+
   for(auto pVoice : mVoicePtrs)
   {
-    // TODO distribute voices across cores
     if(pVoice->GetBusy())
     {
       pVoice->ProcessSamplesAccumulating(inputs, outputs, nInputs, nOutputs, startIndex, blockSize);
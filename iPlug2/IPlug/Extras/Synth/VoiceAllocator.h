@@ -26,6 +26,7 @@
 #include "IPlugQueue.h"
 
 #include "SynthVoice.h"
+#include "VoiceRenderPool.h"
 
 BEGIN_IPLUG_NAMESPACE
 
@@ -137,6 +138,11 @@ public:
 
   void ProcessVoices(sample** inputs, sample** outputs, int nInputs, int nOutputs, int startIndex, int blockSize);
 
+  /** Render busy voices on a pool of worker threads. We do not take ownership of the pool.
+   @param pPool The pool to use, or nullptr to render serially
+   @param minVoicesForPool If fewer voices than this are busy, they are rendered serially on the calling thread */
+  void SetRenderPool(VoiceRenderPool* pPool, int minVoicesForPool) { mRenderPool = pPool; mMinVoicesForPool = minVoicesForPool; }
+
   size_t GetNVoices() const {return mVoicePtrs.size();}
   SynthVoice* GetVoice(int voiceIndex) const {return mVoicePtrs[voiceIndex];}
   void SetPitchOffset(float offset) { mPitchOffset = offset; }
@@ -167,6 +173,9 @@ private:
   IPlugQueue<VoiceInputEvent> mInputQueue{1024};
 
   std::vector<SynthVoice*> mVoicePtrs;
+  std::vector<SynthVoice*> mBusyVoicePtrs; // scratch list for ProcessVoices(), sized in AddVoice()
+  VoiceRenderPool* mRenderPool = nullptr;
+  int mMinVoicesForPool = 0;
   std::vector<std::unique_ptr<VoiceControlRamps>> mVoiceGlides;
   std::vector<int> mHeldKeys; // The currently physically held keys on the keyboard
   std::vector<int> mSustainedNotes; // Any notes that are sustained, including those that are physically held
@@ -0,0 +1,313 @@
+/*
+ ==============================================================================
+
+ This file is part of the iPlug 2 library. Copyright (C) the iPlug 2 developers.
+
+ See LICENSE.txt for  more info.
+
+ ==============================================================================
+ */
+
+#pragma once
+
+/**
+ * @file
+ * @copydoc VoiceRenderPool
+ */
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+  #include <xmmintrin.h>
+#endif
+
+#include "IPlugConstants.h"
+
+#include "SynthVoice.h"
+
+BEGIN_IPLUG_NAMESPACE
+
+/** A pool of worker threads used by VoiceAllocator to render busy voices in parallel.
+ * Each worker accumulates the voices it renders into its own buffers, which the audio thread sums into the outputs once all claimed voices are done.
+ * The audio thread takes part in rendering and voices are claimed with atomic work stealing, so the audio thread never waits for a worker that has not
+ * started a voice, and never blocks or allocates. Idle workers yield for kSpinTime after each job and then sleep on a condition variable,
+ * which the audio thread signals without blocking when a job arrives. A worker that misses the signal wakes after kMaxSleepTime and leaves its share
+ * of the job to the others. Workers flush denormals to zero, as hosts do for the audio thread.
+ * Voices rendered in parallel must not share mutable state. */
+class VoiceRenderPool final
+{
+public:
+  /** How long a worker keeps spinning after a job before it goes to sleep */
+  static constexpr std::chrono::microseconds kSpinTime{50};
+  /** The longest a sleeping worker waits before checking for a job, in case it missed a wake up */
+  static constexpr std::chrono::milliseconds kMaxSleepTime{5};
+
+  VoiceRenderPool() = default;
+
+  ~VoiceRenderPool()
+  {
+    Stop();
+  }
+
+  VoiceRenderPool(const VoiceRenderPool&) = delete;
+  VoiceRenderPool& operator=(const VoiceRenderPool&) = delete;
+
+  /** Allocate the worker buffers and (re)start the worker threads. Not realtime safe.
+   * @param nThreads The number of worker threads, in addition to the audio thread
+   * @param maxVoices The maximum number of voices in a single job
+   * @param maxOutputChans The maximum number of output channels. Blocks with more channels are not handled by the pool
+   * @param maxBlockSize The maximum host block size in samples */
+  void Prepare(int nThreads, int maxVoices, int maxOutputChans, int maxBlockSize)
+  {
+    Stop();
+
+    mNThreads = std::max(nThreads, 0);
+    mMaxVoices = maxVoices;
+    mMaxOutputChans = maxOutputChans;
+    mMaxBlockSize = maxBlockSize;
+
+    mRanges.reset(new Range[mNThreads + 1]);
+    mWorkers.reset(new Worker[mNThreads]);
+
+    for (int w = 0; w < mNThreads; w++)
+    {
+      Worker& worker = mWorkers[w];
+      worker.mData.assign(static_cast<size_t>(maxOutputChans) * maxBlockSize, 0.);
+      worker.mChans.resize(maxOutputChans);
+
+      for (int c = 0; c < maxOutputChans; c++)
+        worker.mChans[c] = worker.mData.data() + (static_cast<size_t>(c) * maxBlockSize);
+    }
+
+    mRunning.store(true);
+
+    for (int w = 0; w < mNThreads; w++)
+      mWorkers[w].mThread = std::thread([this, w]() { WorkerLoop(w); });
+  }
+
+  /** Stop and join the worker threads. Not realtime safe */
+  void Stop()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mWakeMutex);
+      mRunning.store(false);
+    }
+
+    mWakeCV.notify_all();
+
+    for (int w = 0; w < mNThreads; w++)
+    {
+      if (mWorkers[w].mThread.joinable())
+        mWorkers[w].mThread.join();
+    }
+
+    mNThreads = 0;
+  }
+
+  /** @return The number of worker threads, not counting the audio thread */
+  int NThreads() const { return mNThreads; }
+
+  /** Render a set of voices, accumulating into outputs. Called on the audio thread
+   * @param ppVoices The busy voices to render
+   * @param nVoices The number of voices in ppVoices
+   * @param inputs Passed on to SynthVoice::ProcessSamplesAccumulating()
+   * @param outputs Output channel arrays to accumulate into
+   * @param nInputs The number of input channels that contain valid data
+   * @param nOutputs The number of output channels that contain valid data
+   * @param startIdx The start index of the block of samples to process
+   * @param nFrames The number of samples to process
+   * @return \c false if the job does not fit the buffers allocated in Prepare(), in which case nothing is rendered and the caller should render serially */
+  bool ProcessVoices(SynthVoice* const* ppVoices, int nVoices, sample** inputs, sample** outputs, int nInputs, int nOutputs, int startIdx, int nFrames)
+  {
+    if (!mNThreads || nVoices > mMaxVoices || nOutputs > mMaxOutputChans || startIdx + nFrames > mMaxBlockSize)
+      return false;
+
+    mJob = { ppVoices, inputs, nInputs, nOutputs, startIdx, nFrames };
+
+    // Split the voices into one contiguous range per participant, the audio thread is participant 0
+    const int nParticipants = mNThreads + 1;
+
+    for (int p = 0; p < nParticipants; p++)
+    {
+      mRanges[p].mNext.store((nVoices * p) / nParticipants, std::memory_order_relaxed);
+      mRanges[p].mEnd = (nVoices * (p + 1)) / nParticipants;
+    }
+
+    for (int w = 0; w < mNThreads; w++)
+      mWorkers[w].mUsed = false;
+
+    mJobOpen.store(true);
+    mGeneration.fetch_add(1); // sequentially consistent with the worker's mSleepingWorkers increment, see WakeWorkers()
+    WakeWorkers();
+
+    RenderClaimedVoices(0, outputs);
+
+    // Once the job is closed, workers that have not yet joined will not claim anything, so only wait for those that have
+    mJobOpen.store(false);
+
+    while (mActiveWorkers.load() != 0)
+      std::this_thread::yield();
+
+    for (int w = 0; w < mNThreads; w++)
+    {
+      const Worker& worker = mWorkers[w];
+
+      if (!worker.mUsed)
+        continue;
+
+      for (int c = 0; c < nOutputs; c++)
+      {
+        const sample* pSrc = worker.mChans[c];
+        sample* pDst = outputs[c];
+
+        for (int s = startIdx; s < startIdx + nFrames; s++)
+          pDst[s] += pSrc[s];
+      }
+    }
+
+    return true;
+  }
+
+private:
+  struct Job
+  {
+    SynthVoice* const* mVoices;
+    sample** mInputs;
+    int mNInputs;
+    int mNOutputs;
+    int mStartIdx;
+    int mNFrames;
+  };
+
+  /** A range of the job's voice list, claimed from the front by its owner and stolen from by the others */
+  struct alignas(64) Range
+  {
+    std::atomic<int> mNext{0};
+    int mEnd = 0;
+  };
+
+  struct Worker
+  {
+    std::thread mThread;
+    std::vector<sample> mData;
+    std::vector<sample*> mChans;
+    bool mUsed = false; // set by the worker once it has cleared its buffers for the current job
+  };
+
+  void RenderClaimedVoices(int participant, sample** outputs)
+  {
+    const int nParticipants = mNThreads + 1;
+    Worker* pWorker = participant > 0 ? &mWorkers[participant - 1] : nullptr;
+
+    for (int r = 0; r < nParticipants; r++)
+    {
+      Range& range = mRanges[(participant + r) % nParticipants];
+      int voiceIdx;
+
+      while ((voiceIdx = range.mNext.fetch_add(1, std::memory_order_relaxed)) < range.mEnd)
+      {
+        if (pWorker && !pWorker->mUsed)
+        {
+          for (int c = 0; c < mJob.mNOutputs; c++)
+            memset(outputs[c] + mJob.mStartIdx, 0, mJob.mNFrames * sizeof(sample));
+
+          pWorker->mUsed = true;
+        }
+
+        mJob.mVoices[voiceIdx]->ProcessSamplesAccumulating(mJob.mInputs, outputs, mJob.mNInputs, mJob.mNOutputs, mJob.mStartIdx, mJob.mNFrames);
+      }
+    }
+  }
+
+  /** Wake sleeping workers without blocking. If a worker holds mWakeMutex it may be about to sleep without having seen the new generation,
+   * in which case it misses the job and wakes after kMaxSleepTime */
+  void WakeWorkers()
+  {
+    if (mSleepingWorkers.load() == 0)
+      return;
+
+    // Taking the mutex once means that any worker which checked the generation before the increment is now waiting on mWakeCV
+    if (mWakeMutex.try_lock())
+      mWakeMutex.unlock();
+
+    mWakeCV.notify_all();
+  }
+
+  /** Set flush to zero and denormals are zero for the calling thread */
+  static void SetDenormalsToZero()
+  {
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    _mm_setcsr(_mm_getcsr() | 0x8040);
+#elif defined(__aarch64__)
+    unsigned long fpcr;
+    asm volatile ("mrs %0, fpcr" : "=r" (fpcr));
+    asm volatile ("msr fpcr, %0" :: "r" (fpcr | (1UL << 24)));
+#endif
+  }
+
+  void WorkerLoop(int workerIdx)
+  {
+    using clock = std::chrono::steady_clock;
+
+    SetDenormalsToZero();
+
+    unsigned int lastGeneration = mGeneration.load(std::memory_order_acquire);
+    auto lastJobTime = clock::now();
+
+    while (mRunning.load(std::memory_order_acquire))
+    {
+      const unsigned int generation = mGeneration.load(std::memory_order_acquire);
+
+      if (generation != lastGeneration)
+      {
+        lastGeneration = generation;
+
+        mActiveWorkers.fetch_add(1);
+
+        if (mJobOpen.load())
+          RenderClaimedVoices(workerIdx + 1, mWorkers[workerIdx].mChans.data());
+
+        mActiveWorkers.fetch_sub(1);
+        lastJobTime = clock::now();
+      }
+      else if (clock::now() - lastJobTime < kSpinTime)
+      {
+        std::this_thread::yield();
+      }
+      else
+      {
+        std::unique_lock<std::mutex> lock(mWakeMutex);
+        mSleepingWorkers.fetch_add(1);
+
+        if (mRunning.load() && mGeneration.load() == lastGeneration)
+          mWakeCV.wait_for(lock, kMaxSleepTime);
+
+        mSleepingWorkers.fetch_sub(1);
+      }
+    }
+  }
+
+  Job mJob {};
+  std::unique_ptr<Range[]> mRanges;
+  std::unique_ptr<Worker[]> mWorkers;
+  std::atomic<unsigned int> mGeneration{0};
+  std::atomic<int> mActiveWorkers{0};
+  std::atomic<bool> mJobOpen{false};
+  std::atomic<bool> mRunning{false};
+  std::atomic<int> mSleepingWorkers{0};
+  std::mutex mWakeMutex;
+  std::condition_variable mWakeCV;
+  int mNThreads = 0;
+  int mMaxVoices = 0;
+  int mMaxOutputChans = 0;
+  int mMaxBlockSize = 0;
+};
+
+END_IPLUG_NAMESPACE
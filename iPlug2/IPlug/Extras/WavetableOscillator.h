@@ -0,0 +1,436 @@
+/*
+ ==============================================================================
+
+ This file is part of the iPlug 2 library. Copyright (C) the iPlug 2 developers.
+
+ See LICENSE.txt for  more info.
+
+ ==============================================================================
+*/
+
+#pragma once
+
+/**
+ * @file
+ * @brief Band-limited wavetables and a bank of wavetable oscillators that renders several voices per SIMD instruction
+ */
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#if defined IPLUG_SIMDE
+  #if defined(__arm64__)
+    #define SIMDE_ENABLE_NATIVE_ALIASES
+    #include "simde/x86/sse2.h"
+  #else
+    #include <emmintrin.h>
+  #endif
+#endif
+
+#include "IPlugConstants.h"
+
+BEGIN_IPLUG_NAMESPACE
+
+/** A single cycle waveform stored as a mipmap of band-limited tables, one per octave.
+ * Level 0 contains every harmonic that fits in the table, and each level above it half the harmonics of the one below.
+ * An oscillator reads the lowest level whose highest harmonic is below Nyquist at its frequency, so it never aliases.
+ * Tables are built once (which allocates and takes a few milliseconds) and are immutable, so they can be shared by any number of oscillators and threads */
+class Wavetable final
+{
+public:
+  /** The number of samples in one cycle of each level. Must be a power of two */
+  static constexpr int kTableSize = 2048;
+  static constexpr int kTableBits = 11;
+  /** The number of mipmap levels, from kTableSize / 2 harmonics down to a single harmonic */
+  static constexpr int kNumLevels = kTableBits;
+
+  enum EWaveform
+  {
+    kSine,
+    kTriangle,
+    kSaw,
+    kSquare,
+    kNumWaveforms
+  };
+
+  /** Build a wavetable from the amplitudes and phases of its harmonics
+   * @param pAmplitudes The amplitude of each harmonic, starting with the fundamental
+   * @param pPhases The phase of each harmonic in radians, relative to a sine, or nullptr for all zero
+   * @param nHarmonics The number of harmonics. Harmonics above kTableSize / 2 are ignored
+   * @param normalize Set \c true to scale all levels so that the peak of level 0 is 1 */
+  Wavetable(const double* pAmplitudes, const double* pPhases, int nHarmonics, bool normalize = true)
+  : mData(static_cast<size_t>(kNumLevels) * kLevelStride, 0.f)
+  {
+    nHarmonics = std::min(nHarmonics, kTableSize / 2);
+
+    std::vector<double> level(kTableSize);
+    double scale = 1.;
+
+    for (int l = 0; l < kNumLevels; l++)
+    {
+      std::fill(level.begin(), level.end(), 0.);
+
+      for (int h = 1; h <= std::min(nHarmonics, MaxHarmonic(l)); h++)
+      {
+        const double amp = pAmplitudes[h - 1];
+
+        if (amp == 0.)
+          continue;
+
+        // Rotate a phasor instead of calling sin() for every sample
+        const std::complex<double> rotation = std::polar(1., 2. * PI * h / kTableSize);
+        std::complex<double> phasor = std::polar(amp, pPhases ? pPhases[h - 1] : 0.);
+
+        for (int i = 0; i < kTableSize; i++)
+        {
+          level[i] += phasor.imag();
+          phasor *= rotation;
+        }
+      }
+
+      if (l == 0 && normalize)
+      {
+        double peak = 0.;
+
+        for (int i = 0; i < kTableSize; i++)
+          peak = std::max(peak, std::abs(level[i]));
+
+        scale = peak > 0. ? 1. / peak : 1.;
+      }
+
+      float* pLevel = mData.data() + static_cast<size_t>(l) * kLevelStride;
+
+      for (int i = 0; i < kTableSize; i++)
+        pLevel[i] = static_cast<float>(level[i] * scale);
+
+      pLevel[kTableSize] = pLevel[0]; // guard point for interpolation
+    }
+  }
+
+  Wavetable(const Wavetable&) = delete;
+  Wavetable& operator=(const Wavetable&) = delete;
+
+  /** Build a wavetable from one cycle of a waveform, e.g. drawn by the user or loaded from a file. Not real-time safe
+   * @param pSamples One cycle of the waveform
+   * @param nSamples The number of samples in pSamples
+   * @param normalize Set \c true to scale all levels so that the peak of level 0 is 1
+   * @return The new wavetable */
+  static std::shared_ptr<const Wavetable> FromSingleCycle(const float* pSamples, int nSamples, bool normalize = true)
+  {
+    const int nHarmonics = std::min(nSamples / 2, kTableSize / 2);
+    std::vector<double> amplitudes(nHarmonics), phases(nHarmonics);
+
+    for (int h = 1; h <= nHarmonics; h++)
+    {
+      const std::complex<double> rotation = std::polar(1., -2. * PI * h / nSamples);
+      std::complex<double> phasor = 1.;
+      std::complex<double> sum = 0.;
+
+      for (int i = 0; i < nSamples; i++)
+      {
+        sum += static_cast<double>(pSamples[i]) * phasor;
+        phasor *= rotation;
+      }
+
+      // sum = (n / 2) * amp * e^(i * (phase - pi / 2)) for a harmonic amp * sin(w * t + phase)
+      amplitudes[h - 1] = 2. * std::abs(sum) / nSamples;
+      phases[h - 1] = std::arg(sum) + PI * 0.5;
+    }
+
+    return std::make_shared<const Wavetable>(amplitudes.data(), phases.data(), nHarmonics, normalize);
+  }
+
+  /** Get one of the standard waveforms, which are built on the first call and shared by all callers in the binary
+   * @param waveform The waveform
+   * @return The wavetable */
+  static std::shared_ptr<const Wavetable> Get(EWaveform waveform)
+  {
+    static const std::array<std::shared_ptr<const Wavetable>, kNumWaveforms> sTables = {
+      Build(kSine), Build(kTriangle), Build(kSaw), Build(kSquare)
+    };
+
+    return sTables[waveform];
+  }
+
+  /** @param level The mipmap level, from 0 to kNumLevels - 1
+   * @return The samples of the level, kTableSize + 1 samples with the last equal to the first */
+  const float* GetLevel(int level) const
+  {
+    return mData.data() + static_cast<size_t>(level) * kLevelStride;
+  }
+
+  /** Find the level that is band-limited for a frequency
+   * @param phaseIncr The phase increment per sample as a fraction of 2^32, see WavetableOscillatorBank
+   * @return The mipmap level */
+  static int LevelForIncrement(uint32_t phaseIncr)
+  {
+    // Level l contains kTableSize / 2^(l + 1) harmonics, which are all below Nyquist if phaseIncr <= 2^(32 - kTableBits + l)
+    int level = 0;
+
+    while (level < kNumLevels - 1 && phaseIncr > (1u << (32 - kTableBits + level)))
+      level++;
+
+    return level;
+  }
+
+private:
+  static constexpr int kLevelStride = kTableSize + 4; // guard point, padded to keep the levels 16 byte aligned
+
+  static int MaxHarmonic(int level)
+  {
+    return (kTableSize / 2) >> level;
+  }
+
+  static std::shared_ptr<const Wavetable> Build(EWaveform waveform)
+  {
+    std::vector<double> amplitudes(kTableSize / 2, 0.);
+
+    for (int h = 1; h <= kTableSize / 2; h++)
+    {
+      const bool odd = h & 1;
+
+      switch (waveform)
+      {
+        case kSine: amplitudes[h - 1] = h == 1 ? 1. : 0.; break;
+        case kTriangle: amplitudes[h - 1] = odd ? ((h & 2) ? -1. : 1.) / (h * h) : 0.; break;
+        case kSaw: amplitudes[h - 1] = (odd ? 1. : -1.) / h; break;
+        case kSquare: amplitudes[h - 1] = odd ? 1. / h : 0.; break;
+        default: break;
+      }
+    }
+
+    return std::make_shared<const Wavetable>(amplitudes.data(), nullptr, kTableSize / 2);
+  }
+
+  std::vector<float> mData;
+};
+
+/** A bank of wavetable oscillators, one per voice, stored as a struct of arrays so that groups of voices are rendered together.
+ * The phase of each voice is a 32 bit fixed point fraction of a cycle, so it wraps for free and its frequency is exact.
+ * Each voice reads linearly interpolated samples from the mipmap level of its wavetable that is band-limited for its frequency, and has a gain that is
+ * ramped over each block, so that an envelope or velocity can be applied per block without zipper noise.
+ * Define IPLUG_SIMDE at project level to render kNLanes voices per SSE2 instruction (on non-x86_64 include the SIMDE library in your search paths).
+ * Frequencies and gains are set per block, on the audio thread. Nothing is allocated after construction, except by SetWavetable() if it releases the last
+ * reference to the previous wavetable.
+ * @tparam T the sampletype */
+template <typename T = double>
+class WavetableOscillatorBank final
+{
+public:
+  /** The number of voices rendered together */
+  static constexpr int kNLanes = 4;
+
+  /** WavetableOscillatorBank constructor. All voices start silent, with the sine wavetable
+   * @param maxVoices The number of voices */
+  WavetableOscillatorBank(int maxVoices)
+  : mNVoices(maxVoices)
+  , mNGroups((maxVoices + kNLanes - 1) / kNLanes)
+  {
+    const size_t size = static_cast<size_t>(mNGroups) * kNLanes;
+    mPhase.assign(size, 0);
+    mPhaseIncr.assign(size, 0);
+    mGain.assign(size, 0.f);
+    mTargetGain.assign(size, 0.f);
+    mGainStep.assign(size, 0.f);
+    mActiveGroups.assign(mNGroups, 0);
+    mFreqCPS.assign(size, 0.);
+    mTables.assign(size, Wavetable::Get(Wavetable::kSine));
+    mLevels.assign(size, mTables[0]->GetLevel(0));
+  }
+
+  WavetableOscillatorBank(const WavetableOscillatorBank&) = delete;
+  WavetableOscillatorBank& operator=(const WavetableOscillatorBank&) = delete;
+
+  /** @return The number of voices */
+  int NVoices() const { return mNVoices; }
+
+  void SetSampleRate(double sampleRate)
+  {
+    mSampleRate = sampleRate;
+
+    for (int v = 0; v < mNVoices; v++)
+      SetFreqCPS(v, mFreqCPS[v]);
+  }
+
+  /** @param voice The voice index
+   * @param pWavetable The wavetable to read. The bank keeps a reference to it */
+  void SetWavetable(int voice, std::shared_ptr<const Wavetable> pWavetable)
+  {
+    mTables[voice] = std::move(pWavetable);
+    mLevels[voice] = mTables[voice]->GetLevel(Wavetable::LevelForIncrement(mPhaseIncr[voice]));
+  }
+
+  /** @param voice The voice index
+   * @param freqCPS The frequency in Hz, from 0 to below Nyquist */
+  void SetFreqCPS(int voice, double freqCPS)
+  {
+    mFreqCPS[voice] = freqCPS;
+    mPhaseIncr[voice] = static_cast<uint32_t>(std::min(std::max(freqCPS / mSampleRate, 0.), 0.5) * 4294967296.);
+    mLevels[voice] = mTables[voice]->GetLevel(Wavetable::LevelForIncrement(mPhaseIncr[voice]));
+  }
+
+  /** Set the gain of a voice, which is reached at the end of the next rendered block
+   * @param voice The voice index
+   * @param gain The gain. A voice whose gain is 0 at both ends of a block is not rendered */
+  void SetGain(int voice, T gain)
+  {
+    mTargetGain[voice] = static_cast<float>(gain);
+  }
+
+  /** Reset the phase of a voice and jump straight to its target gain, e.g. on a note on
+   * @param voice The voice index
+   * @param phase The start phase, from 0 to 1 */
+  void Reset(int voice, double phase = 0.)
+  {
+    mPhase[voice] = static_cast<uint32_t>((phase - std::floor(phase)) * 4294967296.);
+    mGain[voice] = mTargetGain[voice];
+  }
+
+  /** Render all voices, summed, accumulating into an output buffer
+   * @param pOutput The buffer to add to
+   * @param nFrames The number of samples to render */
+  void ProcessBlock(T* pOutput, int nFrames)
+  {
+    int nActive = 0;
+
+    for (int g = 0; g < mNGroups; g++)
+    {
+      const int v0 = g * kNLanes;
+      bool silent = true;
+
+      for (int v = v0; v < v0 + kNLanes; v++)
+      {
+        silent = silent && mGain[v] == 0.f && mTargetGain[v] == 0.f;
+        mGainStep[v] = (mTargetGain[v] - mGain[v]) / nFrames;
+      }
+
+      if (!silent)
+        mActiveGroups[nActive++] = v0;
+    }
+
+    for (int start = 0; start < nFrames && nActive; start += kChunkSize)
+    {
+      const int n = std::min(kChunkSize, nFrames - start);
+      alignas(16) float acc[kChunkSize * kNLanes] = {};
+
+      for (int g = 0; g < nActive; g++)
+        ProcessGroup(mActiveGroups[g], acc, n);
+
+      for (int s = 0; s < n; s++)
+        pOutput[start + s] += static_cast<T>((acc[s * kNLanes] + acc[s * kNLanes + 1]) + (acc[s * kNLanes + 2] + acc[s * kNLanes + 3]));
+    }
+
+    // Remove any rounding error of the ramps
+    for (int g = 0; g < nActive; g++)
+    {
+      for (int v = mActiveGroups[g]; v < mActiveGroups[g] + kNLanes; v++)
+        mGain[v] = mTargetGain[v];
+    }
+  }
+
+  /** Render one voice, accumulating into an output buffer, e.g. from a SynthVoice that applies its own processing to each voice
+   * @param voice The voice index
+   * @param pOutput The buffer to add to
+   * @param nFrames The number of samples to render */
+  void ProcessVoice(int voice, T* pOutput, int nFrames)
+  {
+    const float* pTable = mLevels[voice];
+    const uint32_t incr = mPhaseIncr[voice];
+    uint32_t phase = mPhase[voice];
+    float gain = mGain[voice];
+    const float gainStep = (mTargetGain[voice] - gain) / nFrames;
+
+    for (int s = 0; s < nFrames; s++)
+    {
+      const uint32_t idx = phase >> kFracBits;
+      const float frac = static_cast<float>(phase & kFracMask) * kFracScale;
+      const float a = pTable[idx];
+      pOutput[s] += static_cast<T>((a + frac * (pTable[idx + 1] - a)) * gain);
+      gain += gainStep;
+      phase += incr;
+    }
+
+    mPhase[voice] = phase;
+    mGain[voice] = mTargetGain[voice];
+  }
+
+private:
+  static constexpr int kFracBits = 32 - Wavetable::kTableBits;
+  static constexpr uint32_t kFracMask = (1u << kFracBits) - 1;
+  static constexpr float kFracScale = 1.f / static_cast<float>(1u << kFracBits);
+  /** Groups are rendered into an interleaved accumulator of this many frames at a time */
+  static constexpr int kChunkSize = 64;
+
+  /** Render the kNLanes voices starting at v0 into an interleaved accumulator, advancing their phases and gains
+   * @param pAcc kNLanes * nFrames samples, 16 byte aligned, sample s of lane l at [s * kNLanes + l] */
+  void ProcessGroup(int v0, float* pAcc, int nFrames)
+  {
+#if defined IPLUG_SIMDE
+    const float* pTables[kNLanes] = { mLevels[v0], mLevels[v0 + 1], mLevels[v0 + 2], mLevels[v0 + 3] };
+    __m128i phase = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&mPhase[v0]));
+    const __m128i incr = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&mPhaseIncr[v0]));
+    const __m128i fracMask = _mm_set1_epi32(static_cast<int>(kFracMask));
+    const __m128 fracScale = _mm_set1_ps(kFracScale);
+    __m128 gain = _mm_loadu_ps(&mGain[v0]);
+    const __m128 step = _mm_loadu_ps(&mGainStep[v0]);
+    alignas(16) uint32_t idx[kNLanes];
+
+    for (int s = 0; s < nFrames; s++)
+    {
+      _mm_store_si128(reinterpret_cast<__m128i*>(idx), _mm_srli_epi32(phase, kFracBits));
+      const __m128 frac = _mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(phase, fracMask)), fracScale);
+      const __m128 a = _mm_set_ps(pTables[3][idx[3]], pTables[2][idx[2]], pTables[1][idx[1]], pTables[0][idx[0]]);
+      const __m128 b = _mm_set_ps(pTables[3][idx[3] + 1], pTables[2][idx[2] + 1], pTables[1][idx[1] + 1], pTables[0][idx[0] + 1]);
+      const __m128 y = _mm_mul_ps(_mm_add_ps(a, _mm_mul_ps(frac, _mm_sub_ps(b, a))), gain);
+      _mm_store_ps(pAcc + s * kNLanes, _mm_add_ps(_mm_load_ps(pAcc + s * kNLanes), y));
+      gain = _mm_add_ps(gain, step);
+      phase = _mm_add_epi32(phase, incr);
+    }
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&mPhase[v0]), phase);
+    _mm_storeu_ps(&mGain[v0], gain);
+#else
+    for (int l = 0; l < kNLanes; l++)
+    {
+      const float* pTable = mLevels[v0 + l];
+      const uint32_t incr = mPhaseIncr[v0 + l];
+      const float step = mGainStep[v0 + l];
+      uint32_t phase = mPhase[v0 + l];
+      float gain = mGain[v0 + l];
+
+      for (int s = 0; s < nFrames; s++)
+      {
+        const uint32_t idx = phase >> kFracBits;
+        const float frac = static_cast<float>(phase & kFracMask) * kFracScale;
+        const float a = pTable[idx];
+        pAcc[s * kNLanes + l] += (a + frac * (pTable[idx + 1] - a)) * gain;
+        gain += step;
+        phase += incr;
+      }
+
+      mPhase[v0 + l] = phase;
+      mGain[v0 + l] = gain;
+    }
+#endif
+  }
+
+  const int mNVoices;
+  const int mNGroups;
+  double mSampleRate = 44100.;
+  std::vector<uint32_t> mPhase;
+  std::vector<uint32_t> mPhaseIncr;
+  std::vector<float> mGain;
+  std::vector<float> mTargetGain;
+  std::vector<float> mGainStep; // per sample, for the current block
+  std::vector<int> mActiveGroups; // the first voice of each group that is not silent, for the current block
+  std::vector<double> mFreqCPS;
+  std::vector<const float*> mLevels; // the band-limited level of each voice's wavetable
+  std::vector<std::shared_ptr<const Wavetable>> mTables;
+};
+
+END_IPLUG_NAMESPACE
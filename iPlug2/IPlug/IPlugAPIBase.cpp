@@ -42,15 +42,20 @@ IPlugAPIBase::IPlugAPIBase(Config c, EAPI plugAPI)
 
   Trace(TRACELOC, "%s:%s", c.pluginName, CurrentTime());
   
+#if defined PROFILER_BUILD
+  Profiler::GetInstance()->Start();
+#endif
+  
   mParamDisplayStr.Set("", MAX_PARAM_DISPLAY_LEN);
 }
 
 IPlugAPIBase::~IPlugAPIBase()
 {
-  if(mTimer)
-  {
-    mTimer->Stop();
-  }
+  StopTimer();
+
+#if defined PROFILER_BUILD
+  Profiler::GetInstance()->Stop();
+#endif
 
   TRACE
 }
@@ -69,6 +74,14 @@ void IPlugAPIBase::CreateTimer()
   mTimer = std::unique_ptr<Timer>(Timer::Create(std::bind(&IPlugAPIBase::OnTimer, this, std::placeholders::_1), IDLE_TIMER_RATE));
 }
 
+void IPlugAPIBase::StopTimer()
+{
+  if(mTimer)
+  {
+    mTimer->Stop();
+  }
+}
+
 bool IPlugAPIBase::CompareState(const uint8_t* pIncomingState, int startPos) const
 {
   bool isEqual = true;
@@ -119,6 +132,7 @@ void IPlugAPIBase::SetParameterValue(int idx, double normalizedValue)
   Trace(TRACELOC, "%d:%f", idx, normalizedValue);
   GetParam(idx)->SetNormalized(normalizedValue);
   InformHostOfParamChange(idx, normalizedValue);
+  IPLUG_PROFILE_SCOPE("OnParamChange");
   OnParamChange(idx, kUI);
 }
 
@@ -141,6 +155,8 @@ void IPlugAPIBase::SendParameterValueFromAPI(int paramIdx, double value, bool no
 
 void IPlugAPIBase::OnTimer(Timer& t)
 {
+  IdleRestoredParams();
+  
   if(HasUI())
   {
 // VST3 ********************************************************************************
@@ -156,23 +172,51 @@ void IPlugAPIBase::OnTimer(Timer& t)
 #endif
     }
 
-    while (mSysExDataFromProcessor.ElementsAvailable())
+    ISysEx msg;
+
+    while (mSysExDataFromProcessor.Read(msg))
     {
-      SysExData msg;
-      mSysExDataFromProcessor.Pop(msg);
 #ifdef VST3P_API // distributed
       TransmitSysExDataFromProcessor(msg);
 #else
-      SendSysexMsgFromDelegate({msg.mOffset, msg.mData, msg.mSize});
+      SendSysexMsgFromDelegate(msg);
 #endif
     }
+
+    mSysExDataFromProcessor.Release();
 // !VST3 ******************************************************************************
 #else
-    while(mParamChangeFromProcessor.ElementsAvailable())
+    if (GetBatchParamChanges())
+    {
+      // Coalesce the queued changes, so that each parameter's controls are updated once per tick, with its latest value
+      const int n = NParams();
+      mParamChangedFlags.Resize(n, false);
+      memset(mParamChangedFlags.Get(), 0, n);
+      mChangedParamIdx.Resize(0, false);
+      
+      while(mParamChangeFromProcessor.ElementsAvailable())
+      {
+        ParamTuple p;
+        mParamChangeFromProcessor.Pop(p);
+        
+        if (p.idx >= 0 && p.idx < n && !mParamChangedFlags.Get()[p.idx])
+        {
+          mParamChangedFlags.Get()[p.idx] = 1;
+          mChangedParamIdx.Add(p.idx);
+        }
+      }
+      
+      if (mChangedParamIdx.GetSize())
+        SendParameterValuesFromDelegate(mChangedParamIdx.Get(), mChangedParamIdx.GetSize());
+    }
+    else
     {
-      ParamTuple p;
-      mParamChangeFromProcessor.Pop(p);
-      SendParameterValueFromDelegate(p.idx, p.value, false);
+      while(mParamChangeFromProcessor.ElementsAvailable())
+      {
+        ParamTuple p;
+        mParamChangeFromProcessor.Pop(p);
+        SendParameterValueFromDelegate(p.idx, p.value, false);
+      }
     }
     
     while (mMidiMsgsFromProcessor.ElementsAvailable())
@@ -182,12 +226,14 @@ void IPlugAPIBase::OnTimer(Timer& t)
       SendMidiMsgFromDelegate(msg);
     }
     
-    while (mSysExDataFromProcessor.ElementsAvailable())
+    ISysEx msg;
+
+    while (mSysExDataFromProcessor.Read(msg))
     {
-      SysExData msg;
-      mSysExDataFromProcessor.Pop(msg);
-      SendSysexMsgFromDelegate({msg.mOffset, msg.mData, msg.mSize});
+      SendSysexMsgFromDelegate(msg);
     }
+
+    mSysExDataFromProcessor.Release();
 #endif
   }
   
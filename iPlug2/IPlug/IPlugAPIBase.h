@@ -24,6 +24,7 @@
 #include "IPlugUtilities.h"
 #include "IPlugParameter.h"
 #include "IPlugQueue.h"
+#include "IPlugByteQueue.h"
 #include "IPlugTimer.h"
 
 /**
@@ -178,11 +179,14 @@ public:
   
   void DeferSysexMsg(const ISysEx& msg) override
   {
-    mSysExDataFromEditor.PushFromArgs(msg.mOffset, msg.mSize, msg.mData); // copies data
+    mSysExDataFromEditor.Push(msg); // copies data
   }
 
   /** Called by the API class to create the timer that pumps the parameter/message queues */
   void CreateTimer();
+
+  /** Called by the API class to stop the timer before the destructor of IPlugAPIBase does, if the timer function could otherwise run while the API class is destroyed */
+  void StopTimer();
   
 private:
   /** Implementations call into the APIs resize hooks
@@ -207,7 +211,7 @@ private:
   virtual void TransmitMidiMsgFromProcessor(const IMidiMsg& msg) {}
   
   /** \todo */
-  virtual void TransmitSysExDataFromProcessor(const SysExData& data) {}
+  virtual void TransmitSysExDataFromProcessor(const ISysEx& msg) {}
 
   void OnTimer(Timer& t);
 
@@ -228,11 +232,12 @@ private:
   std::unique_ptr<Timer> mTimer;
   
   IPlugQueue<ParamTuple> mParamChangeFromProcessor {PARAM_TRANSFER_SIZE};
+  WDL_TypedBuf<int> mChangedParamIdx; // the parameters popped from mParamChangeFromProcessor in one timer tick, when batched parameter changes are enabled
+  WDL_TypedBuf<uint8_t> mParamChangedFlags; // flags the parameters already in mChangedParamIdx
   IPlugQueue<IMidiMsg> mMidiMsgsFromEditor {MIDI_TRANSFER_SIZE}; // a queue of midi messages generated in the editor by clicking keyboard UI etc
   IPlugQueue<IMidiMsg> mMidiMsgsFromProcessor {MIDI_TRANSFER_SIZE}; // a queue of MIDI messages received (potentially on the high priority thread), by the processor to send to the editor
-  IPlugQueue<SysExData> mSysExDataFromEditor {SYSEX_TRANSFER_SIZE}; // a queue of SYSEX data to send to the processor
-  IPlugQueue<SysExData> mSysExDataFromProcessor {SYSEX_TRANSFER_SIZE}; // a queue of SYSEX data to send to the editor
-  SysExData mSysexBuf;
+  IPlugByteQueue mSysExDataFromEditor {SYSEX_QUEUE_SIZE}; // a queue of SYSEX data to send to the processor
+  IPlugByteQueue mSysExDataFromProcessor {SYSEX_QUEUE_SIZE}; // a queue of SYSEX data to send to the editor
 };
 
 END_IPLUG_NAMESPACE
@@ -0,0 +1,239 @@
+/*
+ ==============================================================================
+
+ This file is part of the iPlug 2 library. Copyright (C) the iPlug 2 developers.
+
+ See LICENSE.txt for  more info.
+
+ ==============================================================================
+*/
+
+#pragma once
+
+/**
+ * @file
+ * @copydoc IPlugByteQueue
+ */
+
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+
+#include "heapbuf.h"
+
+#include "IPlugPlatform.h"
+#include "IPlugMidi.h"
+
+BEGIN_IPLUG_NAMESPACE
+
+/** A lock-free SPSC queue of variable length byte messages, used to transfer SysEx and other blobs between threads without copying them into fixed size slots.
+ * Each message is stored contiguously in a ring buffer along with its size and an offset (the sample offset for SysEx, or any other integer for other blobs).
+ * The producer reserves space and writes the message in place, or pushes a copy of existing data. The consumer receives messages as ISysEx views of the ring buffer,
+ * which stay valid until Release() is called, so several messages can be read and handed on (e.g. to a host event list) before their space is reused.
+ * Nothing is allocated after Resize() */
+class IPlugByteQueue final
+{
+public:
+  /** IPlugByteQueue constructor
+   * @param size The capacity of the queue in bytes, including an eight byte header per message */
+  IPlugByteQueue(int size)
+  {
+    Resize(size);
+  }
+
+  ~IPlugByteQueue() {}
+
+  IPlugByteQueue(const IPlugByteQueue&) = delete;
+  IPlugByteQueue& operator=(const IPlugByteQueue&) = delete;
+
+  /** Resize and clear the queue. Not thread safe
+   * @param size The capacity of the queue in bytes */
+  void Resize(int size)
+  {
+    mCapacity = RoundUp(size);
+    mBuf.Resize(mCapacity);
+    mWritePos.store(0);
+    mReadPos.store(0);
+    mReadCursor = 0;
+    mReservePos = -1;
+  }
+
+  /** Producer: reserve space for a message, which is not visible to the consumer until Commit() is called
+   * @param size The size of the message in bytes
+   * @param offset The offset of the message
+   * @return A pointer to write size bytes of the message to, or nullptr if the queue is full */
+  uint8_t* Reserve(int size, int offset = 0)
+  {
+    if (size < 0)
+      return nullptr;
+
+    const int need = RecordSize(size);
+    const int w = mWritePos.load(std::memory_order_relaxed);
+    const int r = mReadPos.load(std::memory_order_acquire);
+    int pos = -1;
+
+    // The write position must never catch up with the read position, since that means empty
+    if (w >= r)
+    {
+      if (need <= mCapacity - w && (w + need < mCapacity || r > 0))
+        pos = w;
+      else if (need < r)
+      {
+        GetHeader(w)->mSize = kWrapMarker; // the rest of the buffer is unused, continue from the start
+        pos = 0;
+      }
+    }
+    else if (need < r - w)
+      pos = w;
+
+    if (pos < 0)
+      return nullptr;
+
+    Header* pHeader = GetHeader(pos);
+    pHeader->mSize = size;
+    pHeader->mOffset = offset;
+    mReservePos = pos;
+
+    return mBuf.Get() + pos + sizeof(Header);
+  }
+
+  /** Producer: publish the message last reserved with Reserve() */
+  void Commit()
+  {
+    assert(mReservePos >= 0 && "Commit() called without a successful Reserve()");
+
+    const int next = Wrap(mReservePos + RecordSize(GetHeader(mReservePos)->mSize));
+    mReservePos = -1;
+    mWritePos.store(next, std::memory_order_release);
+  }
+
+  /** Producer: push a copy of a message
+   * @param offset The offset of the message
+   * @param size The size of the message in bytes
+   * @param pData The message data
+   * @return \c true if there was space for the message */
+  bool Push(int offset, int size, const void* pData)
+  {
+    uint8_t* pDest = Reserve(size, offset);
+
+    if (!pDest)
+      return false;
+
+    if (size)
+      memcpy(pDest, pData, size);
+
+    Commit();
+    return true;
+  }
+
+  /** Producer: push a copy of a SysEx message
+   * @param msg The message to copy
+   * @return \c true if there was space for the message */
+  bool Push(const ISysEx& msg)
+  {
+    return Push(msg.mOffset, msg.mSize, msg.mData);
+  }
+
+  /** Consumer: get the next unread message without reading it
+   * @param msg Set to a view of the message in the queue
+   * @return \c true if there was an unread message */
+  bool Peek(ISysEx& msg) const
+  {
+    int pos = mReadCursor;
+
+    if (!NextUnread(pos))
+      return false;
+
+    GetMessage(pos, msg);
+    return true;
+  }
+
+  /** Consumer: read the next unread message. Its data stays valid until Release() is called
+   * @param msg Set to a view of the message in the queue
+   * @return \c true if there was an unread message */
+  bool Read(ISysEx& msg)
+  {
+    int pos = mReadCursor;
+
+    if (!NextUnread(pos))
+      return false;
+
+    GetMessage(pos, msg);
+    mReadCursor = Wrap(pos + RecordSize(msg.mSize));
+    return true;
+  }
+
+  /** Consumer: free the space of all messages returned by Read(), so that the producer can reuse it */
+  void Release()
+  {
+    mReadPos.store(mReadCursor, std::memory_order_release);
+  }
+
+  /** Consumer: subtract nFrames from the offsets of the unread messages, in the same way as IMidiQueueBase::Flush()
+   * @param nFrames The number of frames to subtract */
+  void Flush(int nFrames)
+  {
+    int pos = mReadCursor;
+
+    while (NextUnread(pos))
+    {
+      Header* pHeader = GetHeader(pos);
+      pHeader->mOffset -= nFrames;
+      pos = Wrap(pos + RecordSize(pHeader->mSize));
+    }
+  }
+
+  /** Consumer: @return \c true if there are unread messages */
+  bool ElementsAvailable() const
+  {
+    return mReadCursor != mWritePos.load(std::memory_order_acquire);
+  }
+
+  /** @return The capacity of the queue in bytes */
+  int GetCapacity() const { return mCapacity; }
+
+private:
+  struct Header
+  {
+    int32_t mSize;
+    int32_t mOffset;
+  };
+
+  static constexpr int kAlignment = sizeof(Header);
+  static constexpr int32_t kWrapMarker = -1;
+
+  static int RoundUp(int size) { return (size + kAlignment - 1) & ~(kAlignment - 1); }
+  static int RecordSize(int size) { return static_cast<int>(sizeof(Header)) + RoundUp(size); }
+
+  int Wrap(int pos) const { return pos == mCapacity ? 0 : pos; }
+
+  Header* GetHeader(int pos) const { return reinterpret_cast<Header*>(mBuf.Get() + pos); }
+
+  /** Move pos past a wrap marker if there is one. @return \c false if there is no message at pos */
+  bool NextUnread(int& pos) const
+  {
+    if (pos == mWritePos.load(std::memory_order_acquire))
+      return false;
+
+    if (GetHeader(pos)->mSize == kWrapMarker)
+      pos = 0;
+
+    return true;
+  }
+
+  void GetMessage(int pos, ISysEx& msg) const
+  {
+    const Header* pHeader = GetHeader(pos);
+    msg = ISysEx(pHeader->mOffset, mBuf.Get() + pos + sizeof(Header), pHeader->mSize);
+  }
+
+  WDL_TypedBuf<uint8_t> mBuf;
+  int mCapacity = 0;
+  std::atomic<int> mWritePos{0}; // published by the producer
+  std::atomic<int> mReadPos{0}; // released by the consumer
+  int mReservePos = -1; // producer only
+  int mReadCursor = 0; // consumer only
+};
+
+END_IPLUG_NAMESPACE
@@ -38,6 +38,7 @@ using PLUG_SAMPLE_SRC = double;
 using sample = PLUG_SAMPLE_DST;
 
 #define LOGFILE "IPlugLog.txt"
+#define PROFILEFILE "IPlugTrace.json"
 #define MAX_PROCESS_TRACE_COUNT 100
 #define MAX_IDLE_TRACE_COUNT 15
 
@@ -111,18 +112,34 @@ static const int MAX_PARAM_DISPLAY_PRECISION = 6;
 #define IDLE_TIMER_RATE 20 // this controls the frequency of data going from processor to editor (and OnIdle calls)
 #endif
 
+#ifndef PARAM_RESTORE_IDLE_MS
+#define PARAM_RESTORE_IDLE_MS 250 // with lock-free parameter restore, parameter sets are applied on the main thread once no block has been processed for this long
+#endif
+
 #ifndef MAX_SYSEX_SIZE
 #define MAX_SYSEX_SIZE 512
 #endif
 
+#ifndef MAX_PARAM_CHANGES_PER_BLOCK
+#define MAX_PARAM_CHANGES_PER_BLOCK 1024 // capacity of the sample accurate automation queue, changes beyond this are applied at the start of the block
+#endif
+
 #define PARAM_TRANSFER_SIZE 512
 #define MIDI_TRANSFER_SIZE 32
 #define SYSEX_TRANSFER_SIZE 4
 
+#ifndef SYSEX_QUEUE_SIZE
+#define SYSEX_QUEUE_SIZE 16384 // capacity in bytes of the queues that transfer SysEx between threads, each message also takes an eight byte header
+#endif
+
 // All version ints are stored as 0xVVVVRRMM: V = version, R = revision, M = minor revision.
 #define IPLUG_VERSION 0x010000
 #define IPLUG_VERSION_MAGIC 'pfft'
 
+// Delta parameter state starts with this 64 bit pattern, which is a NaN, so it can't be mistaken for the first value of a full parameter set
+#define IPLUG_DELTA_STATE_MAGIC 0x7FF44450534C5441ull
+#define IPLUG_DELTA_STATE_VERSION 1
+
 static const int DEFAULT_BLOCK_SIZE = 1024;
 static const double DEFAULT_TEMPO = 120.0;
 static const int kNoParameter = -1;
@@ -124,10 +124,19 @@ public:
   virtual void OnParamChangeUI(int paramIdx, EParamSource source = kUnknown) {};
   
   /** Called when parameters have changed to inform the plugin of the changes
-   * Override only if you need to handle notifications and updates in a specialist manner (e.g. if the ordering of updating parameters has an effect or if you need to avoid multiple settings of linked parameters). This must update both DSP and UI. The default implementation calls OnParamChange() and OnParamChangeUI() for each parameter.
+   * Override only if you need to handle notifications and updates in a specialist manner (e.g. if the ordering of updating parameters has an effect or if you need to avoid multiple settings of linked parameters). This must update both DSP and UI. The default implementation calls OnParamChange() and OnParamChangeUI() for each parameter,
+   * or OnParamsChange() and OnParamsChangeUI() once for all of them if batched parameter changes are enabled. @see SetBatchParamChanges()
    * @param source Specifies the source of the parameter changes */
   virtual void OnParamReset(EParamSource source)
   {
+    if (mBatchParamChanges)
+    {
+      const int* pAllParamIdx = GetAllParamIdx();
+      OnParamsChange(pAllParamIdx, NParams(), source);
+      OnParamsChangeUI(pAllParamIdx, NParams(), source);
+      return;
+    }
+    
     for (int i = 0; i < NParams(); ++i)
     {
       OnParamChange(i, source);
@@ -135,6 +144,65 @@ public:
     }
   }
   
+  /** Override this method to update your DSP once when several parameters change together, e.g. on reset or preset recall, rather than once per parameter in OnParamChange().
+   * This is only called if batched parameter changes are enabled. The default implementation calls OnParamChange() for each parameter. @see SetBatchParamChanges()
+   * WARNING: this method can in some cases be called on the realtime audio thread
+   * @param pParamIdx The indices of the parameters that changed, each listed once
+   * @param nParams The number of indices in pParamIdx
+   * @param source One of the EParamSource options to indicate where the parameter changes came from */
+  virtual void OnParamsChange(const int* pParamIdx, int nParams, EParamSource source)
+  {
+    for (int i = 0; i < nParams; ++i)
+      OnParamChange(pParamIdx[i], source);
+  }
+  
+  /** Override this method to update your UI once when several parameters change together, rather than once per parameter in OnParamChangeUI().
+   * This is only called if batched parameter changes are enabled, or by SendParameterValuesFromDelegate(). The default implementation calls OnParamChangeUI() for each parameter.
+   * @param pParamIdx The indices of the parameters that changed, each listed once
+   * @param nParams The number of indices in pParamIdx
+   * @param source One of the EParamSource options to indicate where the parameter changes came from */
+  virtual void OnParamsChangeUI(const int* pParamIdx, int nParams, EParamSource source)
+  {
+    for (int i = 0; i < nParams; ++i)
+      OnParamChangeUI(pParamIdx[i], source);
+  }
+  
+  /** Inform the plug-in that a set of parameters has changed, via OnParamsChange() and OnParamsChangeUI() if batched parameter changes are enabled,
+   * otherwise via OnParamChange() and OnParamChangeUI() for each parameter. The same threading rules as OnParamReset() apply.
+   * @param pParamIdx The indices of the parameters that changed, each listed once
+   * @param nParams The number of indices in pParamIdx
+   * @param source One of the EParamSource options to indicate where the parameter changes came from */
+  void InformParamsChanged(const int* pParamIdx, int nParams, EParamSource source)
+  {
+    if (mBatchParamChanges)
+    {
+      OnParamsChange(pParamIdx, nParams, source);
+      OnParamsChangeUI(pParamIdx, nParams, source);
+      return;
+    }
+    
+    for (int i = 0; i < nParams; ++i)
+    {
+      OnParamChange(pParamIdx[i], source);
+      OnParamChangeUI(pParamIdx[i], source);
+    }
+  }
+  
+  /** Deliver changes to several parameters with one call to OnParamsChange() and OnParamsChangeUI(), rather than a call to OnParamChange() and OnParamChangeUI() per parameter.
+   * This applies to reset, preset and state recall, and to the editor updates in SendCurrentParamValuesFromDelegate() and those the API classes send on their timer,
+   * which are also coalesced so that each control is updated once. Call this in your plug-in constructor, after the parameters have been added.
+   * @param enable \c true to enable batched parameter changes */
+  void SetBatchParamChanges(bool enable)
+  {
+    mBatchParamChanges = enable;
+    
+    if (enable)
+      GetAllParamIdx();
+  }
+  
+  /** @return \c true if batched parameter changes are enabled. @see SetBatchParamChanges() */
+  bool GetBatchParamChanges() const { return mBatchParamChanges; }
+  
   /** Handle incoming MIDI messages sent to the user interface
    * @param msg The MIDI message to process  */
   virtual void OnMidiMsgUI(const IMidiMsg& msg) {};
@@ -166,6 +234,12 @@ public:
    *  This is important when modifying groups of parameters, restoring state and opening the UI, in order to update it with the latest values*/
   void SendCurrentParamValuesFromDelegate()
   {
+    if (mBatchParamChanges)
+    {
+      SendParameterValuesFromDelegate(GetAllParamIdx(), NParams());
+      return;
+    }
+    
     for (int i = 0; i < NParams(); ++i)
     {
       SendParameterValueFromDelegate(i, GetParam(i)->GetNormalized(), true);
@@ -223,7 +297,24 @@ public:
    * @param paramIdx The index of the parameter to be updated
    * @param value The new value of the parameter
    * @param normalized \c true if value is normalised */
-  virtual void SendParameterValueFromDelegate(int paramIdx, double value, bool normalized) { OnParamChangeUI(paramIdx, EParamSource::kDelegate); } // TODO: normalised?
+  virtual void SendParameterValueFromDelegate(int paramIdx, double value, bool normalized) { if (!mCoalesceParamChangeUI) OnParamChangeUI(paramIdx, EParamSource::kDelegate); } // TODO: normalised?
+  
+  /** SendParameterValuesFromDelegate (Abbreviation: SPVSFD)
+   * WARNING: should not be called on the realtime audio thread.
+   * Update the user interface with the current values of several parameters, calling SendParameterValueFromDelegate() for each of them and then OnParamsChangeUI() once for them all.
+   * In IGraphics plug-ins, this updates the IControls linked to the parameters in one pass over the controls.
+   * @param pParamIdx The indices of the parameters to be updated, each listed once
+   * @param nParams The number of indices in pParamIdx */
+  virtual void SendParameterValuesFromDelegate(const int* pParamIdx, int nParams)
+  {
+    mCoalesceParamChangeUI = true;
+    
+    for (int i = 0; i < nParams; ++i)
+      SendParameterValueFromDelegate(pParamIdx[i], GetParam(pParamIdx[i])->GetNormalized(), true);
+    
+    mCoalesceParamChangeUI = false;
+    OnParamsChangeUI(pParamIdx, nParams, EParamSource::kDelegate);
+  }
 
 #pragma mark - Methods for sending values FROM the user interface
   // The following methods are called from the user interface in order to set or query values of parameters in the class implementing IEditorDelegate
@@ -361,7 +452,27 @@ public:
   friend class IPlugAPIBase;
   friend class IPluginBase;
 
+protected:
+  /** \c true while SendParameterValuesFromDelegate() is sending values, so that OnParamChangeUI() is left to a single OnParamsChangeUI() call */
+  bool mCoalesceParamChangeUI = false;
+  
 private:
+  /** @return The indices of all the parameters, in order, for passing to OnParamsChange() and OnParamsChangeUI(). Only allocates if the number of parameters has changed */
+  const int* GetAllParamIdx()
+  {
+    const int n = NParams();
+    
+    if (mAllParamIdx.GetSize() != n)
+    {
+      int* pIdx = mAllParamIdx.ResizeOK(n, false);
+      
+      for (int i = 0; pIdx && i < n; ++i)
+        pIdx[i] = i;
+    }
+    
+    return mAllParamIdx.Get();
+  }
+  
   /** A list of IParam objects. This list is populated in the delegate constructor depending on the number of parameters passed as an argument to MakeConfig() in the plug-in class implementation constructor */
   WDL_PtrList<IParam> mParams;
 
@@ -371,6 +482,10 @@ private:
   int mEditorHeight = 0;
   /** Editor sizing constraints */
   int mMinWidth = 10, mMaxWidth = 100000, mMinHeight = 10, mMaxHeight = 100000;
+  /** \c true if changes to several parameters are delivered with OnParamsChange() and OnParamsChangeUI() */
+  bool mBatchParamChanges = false;
+  /** The indices of all the parameters, for OnParamReset() with batched parameter changes */
+  WDL_TypedBuf<int> mAllParamIdx;
 };
 
 END_IPLUG_NAMESPACE
@@ -32,6 +32,7 @@
 
 #include "IPlugConstants.h"
 #include "IPlugUtilities.h"
+#include "IPlugProfiler.h"
 
 BEGIN_IPLUG_NAMESPACE
 
@@ -23,6 +23,12 @@
 #include <windows.h>
 #include <Shlobj.h>
 #include <Shlwapi.h>
+#elif defined OS_LINUX
+#include <climits>
+#include <cstdlib>
+#include <dlfcn.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #endif
 
 BEGIN_IPLUG_NAMESPACE
@@ -284,6 +290,132 @@ EResourceLocation LocateResource(const char* name, const char* type, WDL_String&
   return EResourceLocation::kNotFound;
 }
 
+#elif defined OS_LINUX
+#pragma mark - OS_LINUX
+
+// Helper for getting a directory from an environment variable, falling back to a path relative to the user's home directory
+static void GetEnvPath(WDL_String& path, const char* envVar, const char* homeSubPath)
+{
+  const char* envPath = envVar ? getenv(envVar) : nullptr;
+
+  if (CStringHasContents(envPath))
+  {
+    path.Set(envPath);
+  }
+  else
+  {
+    UserHomePath(path);
+    path.Append(homeSubPath);
+  }
+}
+
+static void GetDirectoryOfFile(const char* filePath, WDL_String& path)
+{
+  path.Set(filePath);
+  const char* lastSlash = strrchr(path.Get(), '/');
+  path.SetLen(lastSlash ? static_cast<int>(lastSlash - path.Get()) + 1 : 0);
+}
+
+static bool FileExists(const char* path)
+{
+  struct stat st;
+  return stat(path, &st) == 0 && S_ISREG(st.st_mode);
+}
+
+void HostPath(WDL_String& path, const char* bundleID)
+{
+  char exePath[PATH_MAX] = {'\0'};
+  const ssize_t len = readlink("/proc/self/exe", exePath, PATH_MAX - 1);
+  GetDirectoryOfFile(len > 0 ? exePath : "", path);
+}
+
+void PluginPath(WDL_String& path, void* pExtra)
+{
+  Dl_info info;
+
+  if (dladdr(pExtra ? pExtra : reinterpret_cast<void*>(&PluginPath), &info) && info.dli_fname)
+    GetDirectoryOfFile(info.dli_fname, path);
+  else
+    path.Set("");
+}
+
+void BundleResourcePath(WDL_String& path, void* pExtra)
+{
+  PluginPath(path, pExtra);
+  path.Append("resources/");
+}
+
+void DesktopPath(WDL_String& path)
+{
+  UserHomePath(path);
+  path.Append("/Desktop");
+}
+
+void UserHomePath(WDL_String& path)
+{
+  const char* home = getenv("HOME");
+  path.Set(home ? home : "");
+}
+
+void AppSupportPath(WDL_String& path, bool isSystem)
+{
+  if (isSystem)
+    path.Set("/usr/share");
+  else
+    GetEnvPath(path, "XDG_DATA_HOME", "/.local/share");
+}
+
+void VST3PresetsPath(WDL_String& path, const char* mfrName, const char* pluginName, bool isSystem)
+{
+  if (isSystem)
+    path.Set("/usr/share/vst3/presets");
+  else
+    GetEnvPath(path, nullptr, "/.vst3/presets");
+
+  path.AppendFormatted(MAX_MACOS_PATH_LEN, "/%s/%s", mfrName, pluginName);
+}
+
+void INIPath(WDL_String& path, const char* pluginName)
+{
+  GetEnvPath(path, "XDG_CONFIG_HOME", "/.config");
+  path.AppendFormatted(MAX_MACOS_PATH_LEN, "/%s", pluginName);
+}
+
+void WebViewCachePath(WDL_String& path)
+{
+  GetEnvPath(path, "XDG_CACHE_HOME", "/.cache");
+  path.Append("/iPlug2/WebViewCache");
+}
+
+EResourceLocation LocateResource(const char* name, const char* type, WDL_String& result, const char*, void*, const char*)
+{
+  if (CStringHasContents(name))
+  {
+    if (FileExists(name))
+    {
+      result.Set(name);
+      return EResourceLocation::kAbsolutePath;
+    }
+
+    // Otherwise look in a resources folder next to the binary, using the same layout as the web build
+    const char* subFolder = strcmp(type, "ttf") == 0 ? "fonts/" : "img/";
+    WDL_String path(name);
+    WDL_String resourcesPath;
+    BundleResourcePath(resourcesPath);
+
+    for (const char* folder : { subFolder, "" })
+    {
+      result.SetFormatted(MAX_MACOS_PATH_LEN, "%s%s%s", resourcesPath.Get(), folder, path.get_filepart());
+
+      if (FileExists(result.Get()))
+        return EResourceLocation::kAbsolutePath;
+    }
+  }
+
+  result.Set("");
+  return EResourceLocation::kNotFound;
+}
+
 #endif
 
 END_IPLUG_NAMESPACE
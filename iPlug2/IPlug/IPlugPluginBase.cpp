@@ -109,41 +109,335 @@ void IPluginBase::GetBuildInfoStr(WDL_String& str, const char* date, const char*
 bool IPluginBase::SerializeParams(IByteChunk& chunk) const
 {
   TRACE
-  bool savedOK = true;
-  int i, n = mParams.GetSize();
-  for (i = 0; i < n && savedOK; ++i)
+  if (mDeltaParamState)
+    return SerializeParamsDelta(chunk);
+  
+  const int n = mParams.GetSize();
+  const int startSize = chunk.Size();
+  const int nBytes = n * static_cast<int>(sizeof(double));
+  
+  // Grow the chunk once and write the values in place, rather than growing it for every parameter
+  chunk.Resize(startSize + nBytes);
+  
+  if (chunk.Size() != startSize + nBytes)
+    return false;
+  
+  uint8_t* pDst = chunk.GetData() + startSize;
+  
+  for (int i = 0; i < n; ++i)
+  {
+    const IParam* pParam = mParams.Get(i);
+    const double v = pParam->Value();
+#if defined TRACER_BUILD
+    Trace(TRACELOC, "%d %s %f", i, pParam->GetName(), v);
+#endif
+    memcpy(pDst + i * sizeof(double), &v, sizeof(double));
+  }
+  
+  return true;
+}
+
+int IPluginBase::UnserializeParams(const IByteChunk& chunk, int startPos)
+{
+  return UnserializeParams(IByteStream(chunk.GetData(), chunk.Size()), startPos);
+}
+
+int IPluginBase::UnserializeParams(const IByteStream& stream, int startPos)
+{
+  TRACE
+  uint64_t magic;
+  
+  if (startPos >= 0 && stream.Size() - startPos >= static_cast<int>(sizeof(uint64_t)))
+  {
+    memcpy(&magic, stream.GetData() + startPos, sizeof(uint64_t));
+    
+    if (magic == IPLUG_DELTA_STATE_MAGIC)
+      return UnserializeParamsDelta(stream, startPos);
+  }
+  
+  const int n = mParams.GetSize();
+  const int valueSize = static_cast<int>(sizeof(double));
+  
+  // Bounds check once for all the values. As when reading them one by one, the values that are present are restored, and the end position is -1 if some are missing
+  const int nRead = startPos >= 0 && startPos <= stream.Size() ? std::min(n, (stream.Size() - startPos) / valueSize) : 0;
+  const int pos = nRead == n ? startPos + n * valueSize : -1;
+  const uint8_t* pSrc = nRead ? stream.GetData() + startPos : nullptr;
+  
+  if (mLockFreeParamRestore)
+  {
+    WDL_MutexLock lock(&mParamRestoreMutex);
+    
+    for (int i = 0; i < nRead; ++i)
+    {
+      double v;
+      memcpy(&v, pSrc + i * valueSize, valueSize);
+      SetRestoredParam(i, v);
+    }
+    
+    if (nRead)
+      PublishRestoredParams();
+    
+    return pos;
+  }
+  
+  ENTER_PARAMS_MUTEX
+  for (int i = 0; i < nRead; ++i)
   {
     IParam* pParam = mParams.Get(i);
+    double v;
+    memcpy(&v, pSrc + i * valueSize, valueSize);
+    pParam->Set(v);
     Trace(TRACELOC, "%d %s %f", i, pParam->GetName(), pParam->Value());
-    double v = pParam->Value();
-    savedOK &= (chunk.Put(&v) > 0);
   }
-  return savedOK;
+
+  OnParamReset(kPresetRecall);
+  LEAVE_PARAMS_MUTEX
+
+  return pos;
 }
 
-int IPluginBase::UnserializeParams(const IByteChunk& chunk, int startPos)
+// Delta parameter state layout, in native byte order:
+// uint64 IPLUG_DELTA_STATE_MAGIC, int32 version, int32 number of parameters when written, int32 number of entries,
+// then for each entry an int32 parameter index and a double value. Parameters without an entry are at their defaults.
+static constexpr int kDeltaStateHeaderSize = static_cast<int>(sizeof(uint64_t) + 3 * sizeof(int32_t));
+static constexpr int kDeltaStateEntrySize = static_cast<int>(sizeof(int32_t) + sizeof(double));
+
+bool IPluginBase::SerializeParamsDelta(IByteChunk& chunk) const
 {
   TRACE
-  int i, n = mParams.GetSize(), pos = startPos;
+  const int n = mParams.GetSize();
+  const int startSize = chunk.Size();
+  const int maxBytes = kDeltaStateHeaderSize + n * kDeltaStateEntrySize;
+  
+  // Grow the chunk once for the worst case, write the entries in a single pass and then trim it
+  chunk.Resize(startSize + maxBytes);
+  
+  if (chunk.Size() != startSize + maxBytes)
+    return false;
+  
+  uint8_t* pDst = chunk.GetData() + startSize + kDeltaStateHeaderSize;
+  int32_t nChanged = 0;
+  
+  for (int32_t i = 0; i < n; ++i)
+  {
+    const IParam* pParam = mParams.Get(i);
+    const double v = pParam->Value();
+    
+    if (v != pParam->GetDefault())
+    {
+#if defined TRACER_BUILD
+      Trace(TRACELOC, "%d %s %f", i, pParam->GetName(), v);
+#endif
+      memcpy(pDst, &i, sizeof(int32_t));
+      memcpy(pDst + sizeof(int32_t), &v, sizeof(double));
+      pDst += kDeltaStateEntrySize;
+      nChanged++;
+    }
+  }
+  
+  const uint64_t magic = IPLUG_DELTA_STATE_MAGIC;
+  const int32_t header[3] = { IPLUG_DELTA_STATE_VERSION, n, nChanged };
+  memcpy(chunk.GetData() + startSize, &magic, sizeof(uint64_t));
+  memcpy(chunk.GetData() + startSize + sizeof(uint64_t), header, sizeof(header));
+  chunk.Resize(startSize + kDeltaStateHeaderSize + nChanged * kDeltaStateEntrySize);
+  
+  return true;
+}
+
+int IPluginBase::UnserializeParamsDelta(const IByteStream& stream, int startPos)
+{
+  TRACE
+  const int n = mParams.GetSize();
+  
+  if (stream.Size() - startPos < kDeltaStateHeaderSize)
+    return -1;
+  
+  const uint8_t* pSrc = stream.GetData() + startPos;
+  int32_t header[3]; // version, number of parameters when written, number of entries
+  memcpy(header, pSrc + sizeof(uint64_t), sizeof(header));
+  const int32_t nEntries = header[2];
+  
+  // Nothing is restored from a truncated block, or from a newer version that this build may misread
+  if (header[0] < 1 || header[0] > IPLUG_DELTA_STATE_VERSION || nEntries < 0 || nEntries > (stream.Size() - startPos - kDeltaStateHeaderSize) / kDeltaStateEntrySize)
+    return -1;
+  
+  pSrc += kDeltaStateHeaderSize;
+  
+  // Parameters without an entry go back to their defaults. Entries for parameters this build doesn't have are skipped
+  auto getTargets = [&](double* pTargets) {
+    for (int i = 0; i < n; ++i)
+      pTargets[i] = mParams.Get(i)->GetDefault();
+    
+    for (int e = 0; e < nEntries; ++e)
+    {
+      int32_t idx;
+      memcpy(&idx, pSrc + e * kDeltaStateEntrySize, sizeof(int32_t));
+      
+      if (idx >= 0 && idx < n)
+        memcpy(pTargets + idx, pSrc + e * kDeltaStateEntrySize + sizeof(int32_t), sizeof(double));
+    }
+  };
+  
+  const int pos = startPos + kDeltaStateHeaderSize + nEntries * kDeltaStateEntrySize;
+  
+  WDL_TypedBuf<double> targets;
+  targets.Resize(n, false);
+  getTargets(targets.Get());
+  
+  if (mLockFreeParamRestore)
+  {
+    WDL_MutexLock lock(&mParamRestoreMutex);
+    bool changed = false;
+    
+    // Only the parameters whose values change are notified
+    for (int i = 0; i < n; ++i)
+    {
+      if (mParams.Get(i)->Value() != targets.Get()[i])
+      {
+        SetRestoredParam(i, targets.Get()[i]);
+        changed = true;
+      }
+    }
+    
+    if (changed)
+      PublishRestoredParams();
+    
+    return pos;
+  }
+  
+  WDL_TypedBuf<int> changedIdx;
+  changedIdx.Resize(n, false);
+  int nChanged = 0;
+  
   ENTER_PARAMS_MUTEX
-  for (i = 0; i < n && pos >= 0; ++i)
+  // Set all the changed parameters before notifying any of them, as OnParamReset() would see them
+  for (int i = 0; i < n; ++i)
   {
     IParam* pParam = mParams.Get(i);
-    double v = 0.0;
-    pos = chunk.Get(&v, pos);
-    if (pos >= 0)
+    
+    if (pParam->Value() != targets.Get()[i])
     {
-      pParam->Set(v);
+      pParam->Set(targets.Get()[i]);
+      changedIdx.Get()[nChanged++] = i;
       Trace(TRACELOC, "%d %s %f", i, pParam->GetName(), pParam->Value());
     }
   }
-
-  OnParamReset(kPresetRecall);
+  
+  InformParamsChanged(changedIdx.Get(), nChanged, kPresetRecall);
   LEAVE_PARAMS_MUTEX
-
+  
   return pos;
 }
 
+void IPluginBase::SetLockFreeParamRestore(bool enable)
+{
+  mLockFreeParamRestore = enable;
+  
+  if (enable && !mRestoredParamChanged)
+  {
+    mRestoredParamChanged.reset(new std::atomic<bool>[NParams()]);
+    
+    for (int i = 0; i < NParams(); ++i)
+      mRestoredParamChanged[i].store(false, std::memory_order_relaxed);
+    
+    mRestoredChangedIdx.Resize(NParams(), false);
+  }
+}
+
+void IPluginBase::SetRestoredParam(int paramIdx, double value)
+{
+  IParam* pParam = mParams.Get(paramIdx);
+  pParam->Set(value);
+  mRestoredParamChanged[paramIdx].store(true, std::memory_order_relaxed);
+  Trace(TRACELOC, "%d %s %f", paramIdx, pParam->GetName(), pParam->Value());
+}
+
+void IPluginBase::PublishRestoredParams()
+{
+  mRestoredParamsPending.store(true, std::memory_order_release);
+  mRestoredParamsUIPending.store(true, std::memory_order_release);
+  
+  if (mProcessingIdle.load(std::memory_order_relaxed))
+    NotifyRestoredParamsDSP();
+}
+
+void IPluginBase::NotifyRestoredParamsDSP()
+{
+  if (mNotifyingRestoredParams.exchange(true, std::memory_order_acquire))
+    return;
+  
+  // Parameters flagged by a restore that runs meanwhile are either collected here or left for the next call, as it sets mRestoredParamsPending again
+  if (mRestoredParamsPending.exchange(false, std::memory_order_acq_rel))
+  {
+    int* pChangedIdx = mRestoredChangedIdx.Get();
+    int nChanged = 0;
+    
+    for (int i = 0; i < NParams(); ++i)
+    {
+      if (mRestoredParamChanged[i].exchange(false, std::memory_order_relaxed))
+        pChangedIdx[nChanged++] = i;
+    }
+    
+    if (nChanged)
+    {
+      if (GetBatchParamChanges())
+        OnParamsChange(pChangedIdx, nChanged, kPresetRecall);
+      else
+      {
+        for (int c = 0; c < nChanged; ++c)
+          OnParamChange(pChangedIdx[c], kPresetRecall);
+      }
+    }
+  }
+  
+  mNotifyingRestoredParams.store(false, std::memory_order_release);
+}
+
+void IPluginBase::NotifyRestoredParamsUI()
+{
+  const int n = NParams();
+  
+  mCoalesceParamChangeUI = true;
+  
+  for (int i = 0; i < n; ++i)
+    SendParameterValueFromDelegate(i, GetParam(i)->GetNormalized(), true);
+  
+  mCoalesceParamChangeUI = false;
+  
+  if (GetBatchParamChanges())
+    OnParamsChangeUI(GetAllParamIdx(), n, kPresetRecall);
+  else
+  {
+    for (int i = 0; i < n; ++i)
+      OnParamChangeUI(i, kPresetRecall);
+  }
+}
+
+void IPluginBase::IdleRestoredParams()
+{
+  if (!mLockFreeParamRestore)
+    return;
+  
+  // If no block was processed for a while, the DSP is told here rather than waiting for the audio thread.
+  // The wait is longer than the period of the largest host buffers, so that the audio thread is not racing this one
+  const int idleTicks = std::max(1, PARAM_RESTORE_IDLE_MS / IDLE_TIMER_RATE);
+  const uint32_t blockCount = mProcessedBlockCount.load(std::memory_order_relaxed);
+  
+  if (blockCount != mIdleBlockCount)
+  {
+    mIdleBlockCount = blockCount;
+    mIdleTickCount = 0;
+  }
+  else if (++mIdleTickCount >= idleTicks)
+    mProcessingIdle.store(true, std::memory_order_relaxed);
+  
+  if (mProcessingIdle.load(std::memory_order_relaxed) && mRestoredParamsPending.load(std::memory_order_acquire))
+    NotifyRestoredParamsDSP();
+  
+  if (mRestoredParamsUIPending.exchange(false, std::memory_order_acq_rel))
+    NotifyRestoredParamsUI();
+}
+
 void IPluginBase::InitParamRange(int startIdx, int endIdx, int countStart, const char* nameFmtStr, double defaultVal, double minVal, double maxVal, double step, const char *label, int flags, const char *group, const IParam::Shape& shape, IParam::EParamUnit unit, IParam::DisplayFunc displayFunc)
 {
   WDL_String nameStr;
@@ -15,6 +15,11 @@
  * @copydoc IPluginBase
  */
 
+#include <atomic>
+#include <memory>
+
+#include "mutex.h"
+
 #include "IPlugDelegate_select.h"
 #include "IPlugParameter.h"
 #include "IPlugStructs.h"
@@ -130,6 +135,7 @@ public:
   bool DoesStateChunks() const { return mStateChunks; }
   
   /** Serializes the current double precision floating point, non-normalised values (IParam::mValue) of all parameters, into a binary byte chunk.
+   * If delta parameter state is enabled, only the values that differ from the parameter defaults are written. @see SetDeltaParamState()
    * @param chunk The output chunk to serialize to. Will append data if the chunk has already been started.
    * @return \c true if the serialization was successful */
   bool SerializeParams(IByteChunk& chunk) const;
@@ -139,6 +145,58 @@ public:
    * @param startPos The start position in the chunk where parameter values are stored
    * @return The new chunk position (endPos) */
   int UnserializeParams(const IByteChunk& chunk, int startPos);
+  
+  /** Unserializes double precision floating point, non-normalised values into mParams, straight from memory that is not owned by an IByteChunk, e.g. host memory.
+   * @param stream A view of the memory where parameter values are stored
+   * @param startPos The start position in the stream where parameter values are stored
+   * @return The new stream position (endPos), or -1 if the stream holds fewer values than there are parameters, or a truncated delta */
+  int UnserializeParams(const IByteStream& stream, int startPos);
+  
+  /** Restore parameter state without blocking the audio thread. When enabled, UnserializeParams() does not take the parameter mutex.
+   * It sets the parameters on the calling thread, so GetParam() returns the restored values as soon as it returns, including in OnRestoreState()
+   * and SerializeParams(). A block that is running meanwhile may read some of the new values and some of the old ones, as it may during host automation.
+   * The DSP is told at the start of the next block, on the audio thread, via OnParamChange(), or OnParamsChange() if batched parameter changes are
+   * enabled, with kPresetRecall, so these must be realtime safe. The UI is told on the main thread, from the API class's timer, via OnParamChangeUI()
+   * or OnParamsChangeUI() for every parameter, and the editor's controls are updated. When no blocks are being processed, for example before the transport
+   * starts or while the host has suspended the plug-in, the DSP is told on the calling thread instead, or on the next timer tick if processing stops later.
+   * @warning OnParamReset() is not called for a restore in this mode, because it tells the DSP and the UI together, and these are now told on
+   * different threads. Move any handling of kPresetRecall in an OnParamReset() override to OnParamsChange() and OnParamsChangeUI().
+   * Call this in your plug-in constructor, after the parameters have been created.
+   * @param enable \c true to enable lock-free parameter restore */
+  void SetLockFreeParamRestore(bool enable);
+  
+  /** @return \c true if lock-free parameter restore is enabled. @see SetLockFreeParamRestore() */
+  bool GetLockFreeParamRestore() const { return mLockFreeParamRestore; }
+  
+  /** Write parameter state as a delta against the parameter defaults. When enabled, SerializeParams() writes a versioned block that lists only the parameters
+   * whose values differ from their defaults, which keeps the frequent snapshots some hosts take for undo small. UnserializeParams() reads both formats
+   * whatever this setting is, and when it reads a delta it only sets and notifies the parameters whose values actually change, via InformParamsChanged(),
+   * rather than calling OnParamReset(). State written in this format cannot be read by builds that predate it.
+   * @warning The delta is against the defaults of the build that \b reads it, and the defaults are not stored. A parameter that was at its default when
+   * the state was saved is restored to the \e current default, so changing a parameter's default in a later release silently changes every saved
+   * session and preset in which that parameter was left at its default. Once state has shipped in this format, never change existing defaults
+   * (add a new parameter instead), or don't enable this.
+   * @param enable \c true to write delta parameter state */
+  void SetDeltaParamState(bool enable) { mDeltaParamState = enable; }
+  
+  /** @return \c true if SerializeParams() writes delta parameter state. @see SetDeltaParamState() */
+  bool GetDeltaParamState() const { return mDeltaParamState; }
+  
+  /** Called by the API classes on the audio thread before processing each block, to tell the DSP about parameters restored by UnserializeParams(). Does not block */
+  void ApplyRestoredParams()
+  {
+    mProcessedBlockCount.fetch_add(1, std::memory_order_relaxed);
+    
+    if (mProcessingIdle.load(std::memory_order_relaxed))
+      mProcessingIdle.store(false, std::memory_order_relaxed);
+    
+    if (mRestoredParamsPending.load(std::memory_order_acquire))
+      NotifyRestoredParamsDSP();
+  }
+  
+  /** Called by IPlugAPIBase on the main thread from its timer, to notify the UI of restored parameters,
+   * and to tell the DSP itself if the audio thread has stopped processing */
+  void IdleRestoredParams();
     
   /** Override this method to serialize custom state data, if your plugin does state chunks.
    * @param chunk The output bytechunk where data can be serialized
@@ -397,6 +455,13 @@ public:
   friend class IPlugAPIBase;
   
 private:
+  /** Write the parameters that differ from their defaults, as a delta parameter state block. @see SetDeltaParamState() */
+  bool SerializeParamsDelta(IByteChunk& chunk) const;
+  
+  /** Read a delta parameter state block written by SerializeParamsDelta()
+   * @return The stream position after the block, or -1 if the block is truncated or from a newer version */
+  int UnserializeParamsDelta(const IByteStream& stream, int startPos);
+  
   int mCurrentPresetIdx = 0;
   /** \c true if the plug-in does opaque state chunks. If false the host will provide a default interface */
   bool mStateChunks = false;
@@ -432,6 +497,39 @@ private:
   WDL_PtrList<const char> mParamGroups;
   /** "Baked in" Factory presets */
   WDL_PtrList<IPreset> mPresets;
+  /** \c true if UnserializeParams() should publish parameter sets to the audio thread rather than lock it out */
+  bool mLockFreeParamRestore = false;
+  /** Set a restored parameter and flag it for NotifyRestoredParamsDSP(). Called with mParamRestoreMutex held */
+  void SetRestoredParam(int paramIdx, double value);
+  /** Hand the flagged parameters to the DSP and the UI, and tell the DSP on the calling thread if no blocks are being processed. Called with mParamRestoreMutex held */
+  void PublishRestoredParams();
+  /** Tell the DSP about the flagged parameters, unless another thread is already doing so */
+  void NotifyRestoredParamsDSP();
+  /** Update the editor and notify the UI after parameters have been restored */
+  void NotifyRestoredParamsUI();
+  
+  /** Per parameter, set when a restore has changed it and the DSP has yet to be told. Allocated by SetLockFreeParamRestore() */
+  std::unique_ptr<std::atomic<bool>[]> mRestoredParamChanged;
+  /** The indices passed to OnParamsChange(), guarded by mNotifyingRestoredParams */
+  WDL_TypedBuf<int> mRestoredChangedIdx;
+  /** Set after parameters have been flagged in mRestoredParamChanged */
+  std::atomic<bool> mRestoredParamsPending {false};
+  /** Taken without waiting by whichever thread tells the DSP, so that the audio thread never blocks on the main thread */
+  std::atomic<bool> mNotifyingRestoredParams {false};
+  /** Set when parameters have been restored and the UI has yet to be notified */
+  std::atomic<bool> mRestoredParamsUIPending {false};
+  /** Incremented by ApplyRestoredParams() for every block */
+  std::atomic<uint32_t> mProcessedBlockCount {0};
+  /** \c true if no block has been processed for PARAM_RESTORE_IDLE_MS, or since construction */
+  std::atomic<bool> mProcessingIdle {true};
+  /** mProcessedBlockCount when it last changed, main thread only */
+  uint32_t mIdleBlockCount = 0;
+  /** The number of timer ticks since mProcessedBlockCount last changed, main thread only */
+  int mIdleTickCount = 0;
+  /** Serializes concurrent calls to UnserializeParams() when lock-free parameter restore is enabled */
+  WDL_Mutex mParamRestoreMutex;
+  /** \c true if SerializeParams() should only write the parameters that differ from their defaults */
+  bool mDeltaParamState = false;
 
 #ifdef PARAMS_MUTEX
   friend class IPlugVST3ProcessorBase;
@@ -56,6 +56,9 @@ IPlugProcessor::IPlugProcessor(const Config& config, EAPI plugAPI)
     pOutChannel->mIncomingData = nullptr;
     mChannelData[ERoute::kOutput].Add(pOutChannel);
   }
+
+  mSubBlockData[ERoute::kInput].Resize(totalNInChans);
+  mSubBlockData[ERoute::kOutput].Resize(totalNOutChans);
 }
 
 IPlugProcessor::~IPlugProcessor()
@@ -496,6 +499,8 @@ void IPlugProcessor::AttachBuffers(ERoute direction, int idx, int n, PLUG_SAMPLE
 
 void IPlugProcessor::PassThroughBuffers(PLUG_SAMPLE_DST type, int nFrames)
 {
+  FlushParamChanges();
+
   if (mLatency && mLatencyDelay)
     mLatencyDelay->ProcessBlock(mScratchData[ERoute::kInput].Get(), mScratchData[ERoute::kOutput].Get(), nFrames);
   else
@@ -522,7 +527,12 @@ void IPlugProcessor::PassThroughBuffers(PLUG_SAMPLE_SRC type, int nFrames)
 
 void IPlugProcessor::ProcessBuffers(PLUG_SAMPLE_DST type, int nFrames)
 {
-  ProcessBlock(mScratchData[ERoute::kInput].Get(), mScratchData[ERoute::kOutput].Get(), nFrames);
+  IPLUG_PROFILE_SCOPE("ProcessBuffers");
+
+  if (mParamChanges.GetSize())
+    ProcessSubBlocks(nFrames);
+  else
+    ProcessBlock(mScratchData[ERoute::kInput].Get(), mScratchData[ERoute::kOutput].Get(), nFrames);
 }
 
 void IPlugProcessor::ProcessBuffers(PLUG_SAMPLE_SRC type, int nFrames)
@@ -580,6 +590,87 @@ void IPlugProcessor::ZeroScratchBuffers()
   }
 }
 
+void IPlugProcessor::SetSampleAccurateAutomation(bool enable, int minSubBlockSize)
+{
+  mSampleAccurateAutomation = enable;
+  mMinSubBlockSize = std::max(minSubBlockSize, 1);
+  
+  if (enable)
+    mParamChanges.Prealloc(MAX_PARAM_CHANGES_PER_BLOCK);
+}
+
+void IPlugProcessor::EnqueueParamChange(int paramIdx, double value, int sampleOffset)
+{
+  IParamChange change(paramIdx, value, sampleOffset);
+  
+  if (!mSampleAccurateAutomation || mParamChanges.GetSize() >= MAX_PARAM_CHANGES_PER_BLOCK)
+  {
+    ApplyParamChange(change);
+    return;
+  }
+  
+  // Insertion sort, keeping the host order for changes at the same offset. Hosts deliver changes sorted per parameter, so this is cheap
+  const int n = mParamChanges.GetSize();
+  IParamChange* pChanges = mParamChanges.Resize(n + 1, false);
+  int i = n;
+  
+  for (; i > 0 && pChanges[i - 1].mOffset > sampleOffset; --i)
+    pChanges[i] = pChanges[i - 1];
+  
+  pChanges[i] = change;
+}
+
+void IPlugProcessor::FlushParamChanges()
+{
+  const int n = mParamChanges.GetSize();
+  const IParamChange* pChanges = mParamChanges.Get();
+
+  for (int i = 0; i < n; ++i)
+    ApplyParamChange(pChanges[i]);
+  
+  mParamChanges.Resize(0, false);
+}
+
+void IPlugProcessor::ProcessSubBlocks(int nFrames)
+{
+  const int nChanges = mParamChanges.GetSize();
+  const IParamChange* pChanges = mParamChanges.Get();
+  const int nIn = MaxNChannels(ERoute::kInput);
+  const int nOut = MaxNChannels(ERoute::kOutput);
+  sample** ppIn = mScratchData[ERoute::kInput].Get();
+  sample** ppOut = mScratchData[ERoute::kOutput].Get();
+  sample** ppSubIn = mSubBlockData[ERoute::kInput].Get();
+  sample** ppSubOut = mSubBlockData[ERoute::kOutput].Get();
+  
+  int changeIdx = 0;
+  int start = 0;
+  
+  while (start < nFrames)
+  {
+    while (changeIdx < nChanges && pChanges[changeIdx].mOffset < start + mMinSubBlockSize)
+      ApplyParamChange(pChanges[changeIdx++]);
+    
+    const int end = changeIdx < nChanges ? std::min(pChanges[changeIdx].mOffset, nFrames) : nFrames;
+
+    for (int i = 0; i < nIn; ++i)
+      ppSubIn[i] = ppIn[i] + start;
+    
+    for (int i = 0; i < nOut; ++i)
+      ppSubOut[i] = ppOut[i] + start;
+
+    mSubBlockOffset = start;
+    ProcessBlock(ppSubIn, ppSubOut, end - start);
+    start = end;
+  }
+  
+  // Any changes timestamped beyond the end of the block
+  while (changeIdx < nChanges)
+    ApplyParamChange(pChanges[changeIdx++]);
+
+  mSubBlockOffset = 0;
+  mParamChanges.Resize(0, false);
+}
+
 void IPlugProcessor::SetBlockSize(int blockSize)
 {
   if (blockSize != mBlockSize)
@@ -126,6 +126,20 @@ public:
   /** @return \c true if the plugin is currently rendering off-line */
   bool GetRenderingOffline() const { return mRenderingOffline; };
 
+  /** Enable sample accurate parameter automation. When enabled, API classes that support it (currently VST3 and CLAP) queue timestamped host
+   * parameter changes instead of applying them all before the block, and ProcessBlock() is called for sub-blocks split at the sample offsets of those changes.
+   * OnParamChange() is then called right before the sub-block that starts at the change. MIDI messages keep their offsets relative to the host block,
+   * so if you use IMidiQueue, call Flush() with the sub-block size as usual. Call this from your plug-in constructor or from OnReset()
+   * @param enable \c true to split the block at parameter changes
+   * @param minSubBlockSize Changes closer than this many samples to the start of the current sub-block are applied together, to bound the cost of dense automation */
+  void SetSampleAccurateAutomation(bool enable, int minSubBlockSize = 16);
+
+  /** @return \c true if sample accurate parameter automation is enabled */
+  bool GetSampleAccurateAutomation() const { return mSampleAccurateAutomation; }
+
+  /** @return The offset in samples of the current ProcessBlock() call within the host block. This is only non-zero when sample accurate automation splits the block */
+  int GetSubBlockOffset() const { return mSubBlockOffset; }
+
 #pragma mark -
   /** @return The number of samples elapsed since start of project timeline. */
   double GetSamplePos() const { return mTimeInfo.mSamplePos; }
@@ -286,7 +300,33 @@ protected:
   void SetRenderingOffline(bool renderingOffline) { mRenderingOffline = renderingOffline; }
   const WDL_String& GetChannelLabel(ERoute direction, int idx) { return mChannelData[direction].Get(idx)->mLabel; }
 
+  /** Queue a host parameter change to be applied at its sample offset during ProcessBuffers(), if the queue is full the change is applied immediately
+   * @param paramIdx The index of the parameter
+   * @param value The value, in the representation delivered by the plug-in API
+   * @param sampleOffset The offset within the host block */
+  void EnqueueParamChange(int paramIdx, double value, int sampleOffset);
+
+  /** Apply any queued parameter changes immediately, e.g. when the plug-in is bypassed and ProcessBlock() will not be called */
+  void FlushParamChanges();
+
+  /** Implemented by API classes that support sample accurate automation, to set the parameter value and call OnParamChange()
+   * @param change The change to apply */
+  virtual void ApplyParamChange(const IParamChange& change) {}
+
 private:
+  void ProcessSubBlocks(int nFrames);
+
+  /** \c true if ProcessBlock() should be split at the sample offsets of queued parameter changes */
+  bool mSampleAccurateAutomation = false;
+  /** Changes within this many samples of a sub-block start are merged into that sub-block */
+  int mMinSubBlockSize = 16;
+  /** Offset of the current sub-block within the host block */
+  int mSubBlockOffset = 0;
+  /** Parameter changes queued for the current block, preallocated to MAX_PARAM_CHANGES_PER_BLOCK */
+  WDL_TypedBuf<IParamChange> mParamChanges;
+  /** Channel pointers offset to the start of the current sub-block */
+  WDL_TypedBuf<sample*> mSubBlockData[2];
+
   /** See EIPlugPluginTypes */
   EIPlugPluginType mPlugType;
   /** \c true if the plug-in accepts MIDI input */
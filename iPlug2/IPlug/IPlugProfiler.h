@@ -0,0 +1,370 @@
+/*
+ ==============================================================================
+
+ This file is part of the iPlug 2 library. Copyright (C) the iPlug 2 developers.
+
+ See LICENSE.txt for  more info.
+
+ ==============================================================================
+*/
+
+#pragma once
+
+/**
+ * @file
+ * @brief Real-time safe profiling of plug-in and editor stages
+ *
+ * To time a scope:                              IPLUG_PROFILE_SCOPE("MyStage");
+ * To time the rest of a function:               IPLUG_PROFILE_FUNCTION
+ * No need to wrap profiler calls in #ifdef PROFILER_BUILD because they are no-ops unless PROFILER_BUILD is defined.
+ *
+ * When PROFILER_BUILD is defined, each scope writes a begin/end timestamp to a lock-free ring owned by the calling thread, which never locks, allocates or
+ * does any IO, so it is safe to use on the audio thread. A background thread drains the rings to a JSON file in the Chrome trace event format,
+ * which can be opened in Perfetto (https://ui.perfetto.dev) or chrome://tracing. Each plug-in binary has its own profiler and trace file.
+ */
+
+#if defined PROFILER_BUILD
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+
+#include "mutex.h"
+#include "wdlstring.h"
+
+#include "IPlugConstants.h"
+#include "IPlugUtilities.h"
+
+BEGIN_IPLUG_NAMESPACE
+
+/** A process wide profiler that collects timed scopes from any thread into per-thread rings, and writes them to a Chrome trace file */
+class Profiler final
+{
+public:
+  /** The maximum number of threads that can record events at the same time. A thread's ring is recycled once the thread has exited and its events
+   * have been written. Events from threads beyond this are dropped and counted in the trace */
+  static constexpr int kMaxThreads = 32; // the number of bits in mFreeRings
+  /** The number of events each thread can record before the drain thread catches up. Must be a power of two */
+  static constexpr int kRingSize = 4096;
+  /** How often the drain thread writes events to the file */
+  static constexpr std::chrono::milliseconds kDrainInterval{20};
+
+  static Profiler* GetInstance()
+  {
+    static Profiler sInstance;
+    return &sInstance;
+  }
+
+  Profiler(const Profiler&) = delete;
+  Profiler& operator=(const Profiler&) = delete;
+
+  ~Profiler()
+  {
+    mStartCount = 1;
+    Stop();
+  }
+
+  /** Start writing events to a trace file, if this is the first call. Calls are reference counted, so that each plug-in instance can call Start() and Stop()
+   * @param path The full path of the trace file, or nullptr to write PROFILEFILE in the home directory */
+  void Start(const char* path = nullptr)
+  {
+    WDL_MutexLock lock(&mMutex);
+
+    if (mStartCount++)
+      return;
+
+    WDL_String fullPath;
+
+    if (path)
+      fullPath.Set(path);
+    else
+    {
+#ifdef OS_WIN
+      fullPath.SetFormatted(MAX_WIN32_PATH_LEN, "%s/%s", "C:\\", PROFILEFILE);
+#else
+      fullPath.SetFormatted(MAX_MACOS_PATH_LEN, "%s/%s", getenv("HOME"), PROFILEFILE);
+#endif
+    }
+
+    mFP = fopenUTF8(fullPath.Get(), "w");
+
+    if (!mFP)
+    {
+      mStartCount = 0;
+      return;
+    }
+
+    fprintf(mFP, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    fprintf(mFP, "{\"name\":\"trace_start\",\"ph\":\"i\",\"s\":\"g\",\"pid\":0,\"tid\":0,\"ts\":%.3f}", GetTimeUs());
+
+    mRunning.store(true);
+    mDrainThread = std::thread([this]() {
+      while (mRunning.load(std::memory_order_acquire))
+      {
+        std::this_thread::sleep_for(kDrainInterval);
+        Drain();
+      }
+    });
+  }
+
+  /** Stop writing events and close the trace file, once every call to Start() has been matched */
+  void Stop()
+  {
+    WDL_MutexLock lock(&mMutex);
+
+    if (!mStartCount || --mStartCount)
+      return;
+
+    mRunning.store(false);
+
+    if (mDrainThread.joinable())
+      mDrainThread.join();
+
+    Drain();
+
+    if (mFP)
+    {
+      fprintf(mFP, "\n]}\n");
+      fclose(mFP);
+      mFP = nullptr;
+    }
+  }
+
+  /** @return \c true if a trace file is being written */
+  bool IsRunning() const { return mRunning.load(std::memory_order_relaxed); }
+
+  /** Give the calling thread a name in the trace. The name is copied, so this is not real-time safe
+   * @param name The name to show for this thread */
+  void SetThreadName(const char* name)
+  {
+    if (Ring* pRing = GetThreadRing())
+    {
+      WDL_MutexLock lock(&mNameMutex);
+      pRing->mName.Set(name);
+      pRing->mNameWritten = false;
+    }
+  }
+
+  /** Record a timed scope for the calling thread. Real-time safe
+   * @param name The name of the scope, which must be a string literal or otherwise outlive the profiler
+   * @param begin The time the scope started
+   * @param end The time the scope ended */
+  void Record(const char* name, std::chrono::steady_clock::time_point begin, std::chrono::steady_clock::time_point end)
+  {
+    if (!IsRunning())
+      return;
+
+    Ring* pRing = GetThreadRing();
+
+    if (!pRing)
+      return;
+
+    const uint32_t w = pRing->mWritePos.load(std::memory_order_relaxed);
+
+    if (w - pRing->mReadPos.load(std::memory_order_acquire) >= kRingSize)
+    {
+      pRing->mDropped.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+
+    Event& event = pRing->mEvents[w & (kRingSize - 1)];
+    event.mName = name;
+    event.mBegin = std::chrono::duration_cast<std::chrono::nanoseconds>(begin - mEpoch).count();
+    event.mEnd = std::chrono::duration_cast<std::chrono::nanoseconds>(end - mEpoch).count();
+    pRing->mWritePos.store(w + 1, std::memory_order_release);
+  }
+
+private:
+  Profiler()
+  : mEpoch(std::chrono::steady_clock::now())
+  {
+  }
+
+  struct Event
+  {
+    const char* mName;
+    int64_t mBegin; // ns since mEpoch
+    int64_t mEnd;
+  };
+
+  struct Ring
+  {
+    Event mEvents[kRingSize];
+    alignas(64) std::atomic<uint32_t> mWritePos{0}; // written by the owning thread
+    alignas(64) std::atomic<uint32_t> mReadPos{0}; // written by the drain thread
+    std::atomic<uint32_t> mDropped{0};
+    std::atomic<int> mTid{0}; // the thread id in the trace, which is new each time the ring is claimed
+    std::atomic<bool> mRetired{false}; // set when the owning thread exits, the drain thread frees the ring once it is empty
+    WDL_String mName;
+    bool mNameWritten = true;
+  };
+
+  /** Owns the calling thread's ring, and retires it when the thread exits */
+  struct ThreadRingHolder
+  {
+    int mIdx = -1; // -1 before the first claim, kMaxThreads if no ring was free
+
+    ~ThreadRingHolder()
+    {
+      if (mIdx >= 0 && mIdx < kMaxThreads)
+        Profiler::GetInstance()->mRings[mIdx].mRetired.store(true, std::memory_order_release);
+    }
+  };
+
+  /** Claim a free ring for the calling thread on first use, from the rings allocated up front. Lock-free
+   * @return The calling thread's ring, or nullptr if none was free when it first recorded */
+  Ring* GetThreadRing()
+  {
+    static thread_local ThreadRingHolder tHolder;
+
+    if (tHolder.mIdx < 0)
+    {
+      uint32_t freeMask = mFreeRings.load(std::memory_order_acquire);
+      tHolder.mIdx = kMaxThreads;
+
+      while (freeMask)
+      {
+        const uint32_t lowest = freeMask & (~freeMask + 1);
+
+        if (mFreeRings.compare_exchange_weak(freeMask, freeMask & ~lowest, std::memory_order_acq_rel))
+        {
+          int idx = 0;
+
+          while (!(lowest & (1u << idx)))
+            idx++;
+
+          mRings[idx].mTid.store(mNextTid.fetch_add(1, std::memory_order_relaxed), std::memory_order_relaxed);
+          tHolder.mIdx = idx;
+          break;
+        }
+      }
+    }
+
+    if (tHolder.mIdx < kMaxThreads)
+      return &mRings[tHolder.mIdx];
+
+    mNoRingDropped.fetch_add(1, std::memory_order_relaxed);
+    return nullptr;
+  }
+
+  double GetTimeUs() const
+  {
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - mEpoch).count();
+  }
+
+  /** Write the events in all rings to the file. Called on the drain thread, or with the drain thread stopped */
+  void Drain()
+  {
+    if (!mFP)
+      return;
+
+    for (int i = 0; i < kMaxThreads; i++)
+    {
+      Ring& ring = mRings[i];
+
+      if (mFreeRings.load(std::memory_order_acquire) & (1u << i))
+        continue;
+
+      // Load mRetired first, so that a retired ring's last events are drained before it is freed
+      const bool retired = ring.mRetired.load(std::memory_order_acquire);
+      const int t = ring.mTid.load(std::memory_order_relaxed);
+      const uint32_t w = ring.mWritePos.load(std::memory_order_acquire);
+      uint32_t r = ring.mReadPos.load(std::memory_order_relaxed);
+
+      {
+        WDL_MutexLock lock(&mNameMutex);
+
+        if (!ring.mNameWritten)
+        {
+          fprintf(mFP, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%d,\"args\":{\"name\":\"%s\"}}", t, ring.mName.Get());
+          ring.mNameWritten = true;
+        }
+      }
+
+      for (; r != w; r++)
+      {
+        const Event& event = ring.mEvents[r & (kRingSize - 1)];
+        fprintf(mFP, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":0,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                event.mName, t, static_cast<double>(event.mBegin) * 1e-3, static_cast<double>(event.mEnd - event.mBegin) * 1e-3);
+      }
+
+      ring.mReadPos.store(r, std::memory_order_release);
+
+      if (const uint32_t dropped = ring.mDropped.exchange(0, std::memory_order_relaxed))
+        fprintf(mFP, ",\n{\"name\":\"%u events dropped\",\"ph\":\"i\",\"s\":\"t\",\"pid\":0,\"tid\":%d,\"ts\":%.3f}",
+                dropped, t, GetTimeUs());
+
+      if (retired)
+      {
+        {
+          WDL_MutexLock lock(&mNameMutex);
+          ring.mName.Set("");
+          ring.mNameWritten = true;
+        }
+
+        ring.mRetired.store(false, std::memory_order_relaxed);
+        mFreeRings.fetch_or(1u << i, std::memory_order_release);
+      }
+    }
+
+    if (const uint32_t dropped = mNoRingDropped.exchange(0, std::memory_order_relaxed))
+      fprintf(mFP, ",\n{\"name\":\"%u events dropped from threads without a ring\",\"ph\":\"i\",\"s\":\"g\",\"pid\":0,\"tid\":0,\"ts\":%.3f}",
+              dropped, GetTimeUs());
+
+    fflush(mFP);
+  }
+
+  const std::chrono::steady_clock::time_point mEpoch;
+  std::unique_ptr<Ring[]> mRings {new Ring[kMaxThreads]};
+  std::atomic<uint32_t> mFreeRings{0xFFFFFFFFu}; // a bit per ring in mRings
+  std::atomic<int> mNextTid{1};
+  std::atomic<uint32_t> mNoRingDropped{0};
+  std::atomic<bool> mRunning{false};
+  std::thread mDrainThread;
+  WDL_Mutex mMutex; // guards Start() and Stop()
+  WDL_Mutex mNameMutex; // guards the thread names
+  FILE* mFP = nullptr;
+  int mStartCount = 0;
+};
+
+/** Records the time between its construction and destruction with the Profiler */
+class ProfileScope final
+{
+public:
+  ProfileScope(const char* name)
+  : mName(name)
+  , mBegin(std::chrono::steady_clock::now())
+  {
+  }
+
+  ~ProfileScope()
+  {
+    Profiler::GetInstance()->Record(mName, mBegin, std::chrono::steady_clock::now());
+  }
+
+  ProfileScope(const ProfileScope&) = delete;
+  ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+  const char* mName;
+  std::chrono::steady_clock::time_point mBegin;
+};
+
+END_IPLUG_NAMESPACE
+
+#define IPLUG_PROFILE_CONCAT_(a, b) a##b
+#define IPLUG_PROFILE_CONCAT(a, b) IPLUG_PROFILE_CONCAT_(a, b)
+#define IPLUG_PROFILE_SCOPE(name) iplug::ProfileScope IPLUG_PROFILE_CONCAT(profileScope, __LINE__) {name}
+#define IPLUG_PROFILE_FUNCTION IPLUG_PROFILE_SCOPE(__FUNCTION__);
+#define IPLUG_PROFILE_THREAD_NAME(name) iplug::Profiler::GetInstance()->SetThreadName(name)
+
+#else // PROFILER_BUILD
+  #define IPLUG_PROFILE_SCOPE(name) do {} while(0)
+  #define IPLUG_PROFILE_FUNCTION
+  #define IPLUG_PROFILE_THREAD_NAME(name) do {} while(0)
+#endif // !PROFILER_BUILD
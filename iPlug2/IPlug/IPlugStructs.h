@@ -40,6 +40,20 @@ struct ParamTuple
   {}
 };
 
+/** A timestamped parameter change, queued on the audio thread when sample accurate automation is enabled (see IPlugProcessor::SetSampleAccurateAutomation()) */
+struct IParamChange
+{
+  int mIdx;
+  double mValue; // The value in the representation delivered by the plug-in API (e.g. normalized for VST3)
+  int mOffset; // Sample offset within the current host block
+
+  IParamChange(int idx = kNoParameter, double value = 0., int offset = 0)
+  : mIdx(idx)
+  , mValue(value)
+  , mOffset(offset)
+  {}
+};
+
 /** This structure is used when queueing Sysex messages. You may need to set MAX_SYSEX_SIZE to reflect the max sysex payload in bytes */
 struct SysExData
 {
@@ -140,16 +154,28 @@ public:
     return ver;
   }
   
-  /** Copies data into the chunk, placing it at the end, resizing if necessary
+  /** Copies data into the chunk, placing it at the end, resizing if necessary.
+   * The allocation grows geometrically and never shrinks here, so a sequence of Puts only reallocates a few times, and not at all after Reserve()
    * @param pSrc Pointer to the data to copy
    * @param nBytesToCopy Number of bytes to copy
-   * @return int The size of the chunk after insertion  */
+   * @return int The size of the chunk after insertion, or 0 if memory could not be allocated  */
   inline int PutBytes(const void* pSrc, int nBytesToCopy)
   {
     int n = mBytes.GetSize();
-    mBytes.Resize(n + nBytesToCopy);
-    memcpy(mBytes.Get() + n, pSrc, nBytesToCopy);
-    return mBytes.GetSize();
+    uint8_t* pDst = mBytes.ResizeOK(n + nBytesToCopy, false);
+    
+    if (!pDst)
+      return 0;
+    
+    memcpy(pDst + n, pSrc, nBytesToCopy);
+    return n + nBytesToCopy;
+  }
+  
+  /** Allocate memory up front, so that the chunk can grow to a size without reallocating
+   * @param nBytes The total size in bytes that the chunk is expected to reach */
+  inline void Reserve(int nBytes)
+  {
+    mBytes.Prealloc(nBytes);
   }
   
   /** Copy raw bytes from the IByteChunk, returning the new position for subsequent calls
@@ -172,6 +198,17 @@ public:
     return PutBytes(pVal, sizeof(T));
   }
   
+  /** Copies an array of typed data into the IByteChunk with a single copy
+   * @tparam T The type of data to be stored
+   * @param pVals Ptr to the first element
+   * @param count The number of elements
+   * @return int The size of the chunk after insertion  */
+  template <class T>
+  inline int PutArray(const T* pVals, int count)
+  {
+    return PutBytes(pVals, count * static_cast<int>(sizeof(T)));
+  }
+  
   /** Get arbitary typed data from the IByteChunk
    * @tparam T The type of data to be extracted
    * @param pDst Ptr to the destination where the data will be extracted
@@ -210,10 +247,11 @@ public:
     return PutBytes(pRHS->GetData(), pRHS->Size());
   }
   
-  /** Clears the chunk (resizes to 0) */
-  inline void Clear()
+  /** Clears the chunk (resizes to 0)
+   * @param keepMemory Set \c true to keep the allocation, when the chunk is about to be refilled */
+  inline void Clear(bool keepMemory = false)
   {
-    mBytes.Resize(0);
+    mBytes.Resize(0, !keepMemory);
   }
   
   /** Returns the current size of the chunk
@@ -317,7 +355,7 @@ public:
   
   /** Gets a const ptr to the stream data
    * @return uint8_t* const ptr to the stream data */
-  inline const uint8_t* GetData()
+  inline const uint8_t* GetData() const
   {
     return mBytes;
   }
@@ -386,6 +424,68 @@ private:
   int mPos;
 };
 
+/** Helper class to append data to an IByteChunk, which reserves the expected size up front and then grows geometrically if needed,
+ * so that writing many small values does not reallocate for each of them */
+class IByteChunkWriter
+{
+public:
+  /** @param chunk The chunk to append to
+   * @param expectedBytes The number of bytes that are expected to be written, or 0 if unknown */
+  IByteChunkWriter(IByteChunk& chunk, int expectedBytes = 0)
+  : mChunk(chunk)
+  {
+    if (expectedBytes > 0)
+      mChunk.Reserve(mChunk.Size() + expectedBytes);
+  }
+  
+  /** Copy raw bytes to the end of the managed IByteChunk
+   * @param pSrc The data to copy
+   * @param nBytesToCopy Number of bytes to copy
+   * @return The size of the IByteChunk after the copy, or 0 if memory could not be allocated */
+  inline int PutBytes(const void* pSrc, int nBytesToCopy)
+  {
+    return mChunk.PutBytes(pSrc, nBytesToCopy);
+  }
+  
+  /** Copy arbitary typed data to the end of the managed IByteChunk
+   * @tparam T type of the variable to put
+   * @param pVal Pointer to the value
+   * @return The size of the IByteChunk after the copy */
+  template <class T>
+  inline int Put(const T* pVal)
+  {
+    return mChunk.Put(pVal);
+  }
+  
+  /** Copy an array of typed data to the end of the managed IByteChunk
+   * @tparam T type of the elements
+   * @param pVals Pointer to the first element
+   * @param count The number of elements
+   * @return The size of the IByteChunk after the copy */
+  template <class T>
+  inline int PutArray(const T* pVals, int count)
+  {
+    return mChunk.PutArray(pVals, count);
+  }
+  
+  /** Copy a string to the end of the managed IByteChunk
+   * @param str The string to copy
+   * @return The size of the IByteChunk after the copy */
+  inline int PutStr(const char* str)
+  {
+    return mChunk.PutStr(str);
+  }
+  
+  /** @return The current size of the managed IByteChunk, which is where the next value will be written */
+  inline int Tell() const
+  {
+    return mChunk.Size();
+  }
+  
+private:
+  IByteChunk& mChunk;
+};
+
 /** Helper struct to set compile time options to an API class constructor  */
 struct Config
 {
@@ -143,4 +143,358 @@ void Timer_impl::TimerProc(void* userData)
   Timer_impl* itimer = (Timer_impl*) userData;
   itimer->mTimerFunc(*itimer);
 }
+#elif defined OS_LINUX
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <thread>
+
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+/** Each distinct interval has a group of timers sharing one timerfd, and all timerfds are watched by one epoll fd.
+ * A thread waits on the epoll fd and calls the timer functions, unless a host run loop has been attached, in which case the host polls the epoll fd
+ * and calls RunPending() on its main thread */
+class Timer_impl::EventLoop
+{
+public:
+  static EventLoop& Get()
+  {
+    static EventLoop sLoop;
+    return sLoop;
+  }
+
+  EventLoop()
+  {
+    mEpollFD = epoll_create1(EPOLL_CLOEXEC);
+    mWakeFD = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    mThread = std::thread([this]() { Run(); });
+  }
+
+  ~EventLoop()
+  {
+    mQuit = true;
+    Wake();
+
+    if (mThread.joinable())
+      mThread.join();
+
+    for (auto i = 0; i < mGroups.GetSize(); i++)
+      close(mGroups.Get(i)->mFD);
+
+    mGroups.Empty(true);
+    close(mWakeFD);
+    close(mEpollFD);
+  }
+
+  int GetEventFD() const { return mEpollFD; }
+
+  /** Stop the thread calling timer functions. Once this returns, they are only called from RunPending() */
+  void AttachRunLoop()
+  {
+    mNumRunLoops.fetch_add(1);
+    Wake();
+
+    // Wait for a dispatch in progress on the thread
+    WDL_MutexLock lock(&mMutex);
+  }
+
+  /** Resume calling timer functions on the thread, once every attached run loop has been detached */
+  void DetachRunLoop()
+  {
+    if (mNumRunLoops.fetch_sub(1) == 1)
+      Wake();
+  }
+
+  bool Add(Timer_impl* pTimer)
+  {
+    WDL_MutexLock lock(&mMutex);
+
+    Group* pGroup = FindGroup(pTimer->mIntervalMs);
+
+    if (!pGroup)
+    {
+      const int fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+
+      if (fd < 0)
+        return false;
+
+      itimerspec spec = {};
+      spec.it_interval.tv_sec = pTimer->mIntervalMs / 1000;
+      spec.it_interval.tv_nsec = (pTimer->mIntervalMs % 1000) * 1000000;
+      spec.it_value = spec.it_interval;
+
+      epoll_event event = {};
+      event.events = EPOLLIN;
+      event.data.fd = fd;
+
+      if (timerfd_settime(fd, 0, &spec, nullptr) || epoll_ctl(mEpollFD, EPOLL_CTL_ADD, fd, &event))
+      {
+        close(fd);
+        return false;
+      }
+
+      pGroup = mGroups.Add(new Group);
+      pGroup->mFD = fd;
+      pGroup->mStats.intervalMs = pTimer->mIntervalMs;
+      pGroup->mInterval = std::chrono::milliseconds(pTimer->mIntervalMs);
+      pGroup->mNextExpiry = std::chrono::steady_clock::now() + pGroup->mInterval;
+    }
+
+    // Set before the timer can be called, which may stop it
+    pTimer->mRunning = true;
+    pGroup->mTimers.Add(pTimer);
+    pGroup->mStats.nTimers = pGroup->mTimers.GetSize();
+    return true;
+  }
+
+  /** Remove a timer. Once this returns the timer function is not running and will not be called again, unless this is called from the timer function itself */
+  void Remove(Timer_impl* pTimer)
+  {
+    WDL_MutexLock lock(&mMutex);
+
+    Group* pGroup = FindGroup(pTimer->mIntervalMs);
+
+    if (!pGroup)
+      return;
+
+    pGroup->mTimers.DeletePtr(pTimer);
+    pGroup->mStats.nTimers = pGroup->mTimers.GetSize();
+
+    if (pGroup->mTimers.GetSize())
+      return;
+
+    epoll_ctl(mEpollFD, EPOLL_CTL_DEL, pGroup->mFD, nullptr);
+    close(pGroup->mFD);
+    mGroups.DeletePtr(pGroup);
+
+    // A group emptied by one of its own timer functions is deleted once it has finished dispatching
+    if (pGroup == mDispatchingGroup)
+      mDispatchingGroupRemoved = true;
+    else
+      delete pGroup;
+  }
+
+  bool GetStats(uint32_t intervalMs, Stats& stats)
+  {
+    WDL_MutexLock lock(&mMutex);
+
+    const Group* pGroup = FindGroup(intervalMs);
+
+    if (!pGroup)
+      return false;
+
+    stats = pGroup->mStats;
+    return true;
+  }
+
+  /** Call the timer functions of the groups that have expired, without waiting */
+  void RunPending()
+  {
+    static constexpr int kMaxEvents = 16;
+    epoll_event events[kMaxEvents];
+
+    WDL_MutexLock lock(&mMutex);
+
+    // A timer function run by an outer RunPending() must not be re-entered
+    if (mDispatchingGroup)
+      return;
+
+    int nEvents;
+
+    do
+    {
+      nEvents = epoll_wait(mEpollFD, events, kMaxEvents, 0);
+    }
+    while (nEvents < 0 && errno == EINTR);
+
+    for (auto e = 0; e < nEvents; e++)
+    {
+      // The group may have been removed by a timer function called earlier in this loop
+      Group* pGroup = FindGroupByFD(events[e].data.fd);
+      uint64_t expirations = 0;
+
+      if (!pGroup || read(pGroup->mFD, &expirations, sizeof(expirations)) != sizeof(expirations) || !expirations)
+        continue;
+
+      UpdateStats(*pGroup, expirations);
+      Dispatch(pGroup);
+    }
+  }
+
+private:
+  void Wake()
+  {
+    const uint64_t one = 1;
+    (void) !write(mWakeFD, &one, sizeof(one));
+  }
+
+  /** The thread, which waits on the epoll fd while no run loop is attached, and otherwise only for a wake up */
+  void Run()
+  {
+    while (!mQuit)
+    {
+      pollfd fds[2] = {};
+      fds[0].fd = mWakeFD;
+      fds[0].events = POLLIN;
+      fds[1].fd = mEpollFD;
+      fds[1].events = POLLIN;
+
+      const bool dispatch = mNumRunLoops.load() == 0;
+
+      if (poll(fds, dispatch ? 2 : 1, -1) < 0 && errno != EINTR)
+        break;
+
+      if (fds[0].revents & POLLIN)
+      {
+        uint64_t count;
+        (void) !read(mWakeFD, &count, sizeof(count));
+      }
+
+      // Check again, in case a run loop was attached while waiting
+      if (!mQuit && dispatch && mNumRunLoops.load() == 0)
+        RunPending();
+    }
+  }
+
+  struct Group
+  {
+    int mFD = -1;
+    WDL_PtrList<Timer_impl> mTimers;
+    std::chrono::steady_clock::duration mInterval;
+    std::chrono::steady_clock::time_point mNextExpiry;
+    double mTotalJitterMs = 0.;
+    Stats mStats;
+  };
+
+  Group* FindGroup(uint32_t intervalMs) const
+  {
+    for (auto i = 0; i < mGroups.GetSize(); i++)
+    {
+      if (mGroups.Get(i)->mStats.intervalMs == intervalMs)
+        return mGroups.Get(i);
+    }
+
+    return nullptr;
+  }
+
+  Group* FindGroupByFD(int fd) const
+  {
+    for (auto i = 0; i < mGroups.GetSize(); i++)
+    {
+      if (mGroups.Get(i)->mFD == fd)
+        return mGroups.Get(i);
+    }
+
+    return nullptr;
+  }
+
+  void UpdateStats(Group& group, uint64_t expirations)
+  {
+    using namespace std::chrono;
+
+    // Measure the lateness against the latest expiry that this wakeup is for
+    const steady_clock::time_point now = steady_clock::now();
+    const steady_clock::time_point expiry = group.mNextExpiry + group.mInterval * static_cast<int>(expirations - 1);
+    const double jitterMs = std::max(duration<double, std::milli>(now - expiry).count(), 0.);
+
+    group.mNextExpiry = expiry + group.mInterval;
+    group.mTotalJitterMs += jitterMs;
+
+    Stats& stats = group.mStats;
+    stats.nWakeups++;
+    stats.nOverruns += expirations - 1;
+    stats.meanJitterMs = group.mTotalJitterMs / static_cast<double>(stats.nWakeups);
+    stats.maxJitterMs = std::max(stats.maxJitterMs, jitterMs);
+  }
+
+  /** Call the timer functions of a group, allowing them to stop or start any timer (including themselves) */
+  void Dispatch(Group* pGroup)
+  {
+    mDispatchingGroup = pGroup;
+    mDispatchingGroupRemoved = false;
+    mDispatchList.Empty();
+
+    for (auto i = 0; i < pGroup->mTimers.GetSize(); i++)
+      mDispatchList.Add(pGroup->mTimers.Get(i));
+
+    for (auto i = 0; i < mDispatchList.GetSize(); i++)
+    {
+      Timer_impl* pTimer = mDispatchList.Get(i);
+
+      // Skip timers stopped by an earlier timer function in this wakeup, they may have been deleted
+      if (!mDispatchingGroupRemoved && pGroup->mTimers.Find(pTimer) >= 0)
+        pTimer->mTimerFunc(*pTimer);
+    }
+
+    if (mDispatchingGroupRemoved)
+      delete pGroup;
+
+    mDispatchingGroup = nullptr;
+  }
+
+  WDL_Mutex mMutex;
+  WDL_PtrList<Group> mGroups;
+  WDL_PtrList<Timer_impl> mDispatchList;
+  Group* mDispatchingGroup = nullptr;
+  bool mDispatchingGroupRemoved = false;
+  int mEpollFD = -1;
+  int mWakeFD = -1;
+  std::atomic<int> mNumRunLoops {0};
+  std::atomic<bool> mQuit {false};
+  std::thread mThread;
+};
+
+Timer* Timer::Create(ITimerFunction func, uint32_t intervalMs)
+{
+  return new Timer_impl(func, intervalMs);
+}
+
+Timer_impl::Timer_impl(ITimerFunction func, uint32_t intervalMs)
+: mTimerFunc(func)
+, mIntervalMs(std::max(intervalMs, 1u))
+{
+  EventLoop::Get().Add(this);
+}
+
+Timer_impl::~Timer_impl()
+{
+  Stop();
+}
+
+void Timer_impl::Stop()
+{
+  if (mRunning.exchange(false))
+    EventLoop::Get().Remove(this);
+}
+
+bool Timer_impl::GetStats(uint32_t intervalMs, Stats& stats)
+{
+  return EventLoop::Get().GetStats(intervalMs, stats);
+}
+
+int Timer_impl::GetEventFD()
+{
+  return EventLoop::Get().GetEventFD();
+}
+
+void Timer_impl::RunPending()
+{
+  EventLoop::Get().RunPending();
+}
+
+void Timer_impl::AttachRunLoop()
+{
+  EventLoop::Get().AttachRunLoop();
+}
+
+void Timer_impl::DetachRunLoop()
+{
+  EventLoop::Get().DetachRunLoop();
+}
 #endif
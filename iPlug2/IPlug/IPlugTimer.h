@@ -17,6 +17,7 @@
  * base/source/timer.cpp, so thanks to them 
  * */
 
+#include <atomic>
 #include <cstring>
 #include <stdint.h>
 #include <cstring>
@@ -95,6 +96,54 @@ private:
   long ID = 0;
   ITimerFunction mTimerFunc;
 };
+#elif defined OS_LINUX
+/** On linux each distinct interval has one timerfd, and all of them are watched by a single epoll fd.
+ * Timers that share an interval are coalesced into the same wakeup, and are called one after the other.
+ * Linux has no standard main run loop, so by default the timer functions are called on an event loop thread, which suits headless use.
+ * A host that provides a run loop, e.g. through the CLAP posix fd extension or a Steinberg::Linux::IRunLoop in VST3, should poll GetEventFD() for readability
+ * and call RunPending() on its main thread, bracketed by AttachRunLoop() and DetachRunLoop(), so that the timer functions are called on the main thread instead */
+class Timer_impl : public Timer
+{
+public:
+  /** Wakeup statistics for the timers that share an interval */
+  struct Stats
+  {
+    uint32_t intervalMs = 0;
+    int nTimers = 0;
+    uint64_t nWakeups = 0;
+    uint64_t nOverruns = 0; // expirations that were missed because a wakeup was more than an interval late
+    double meanJitterMs = 0.; // mean lateness of a wakeup
+    double maxJitterMs = 0.;
+  };
+
+  Timer_impl(ITimerFunction func, uint32_t intervalMs);
+  ~Timer_impl();
+  void Stop() override;
+
+  /** Get the wakeup statistics of the timers with a given interval
+   * @param intervalMs The interval of the timers
+   * @param stats Filled with the statistics
+   * @return \c true if there are running timers with this interval */
+  static bool GetStats(uint32_t intervalMs, Stats& stats);
+
+  /** @return A file descriptor that becomes readable when timers are due. Don't read from it, call RunPending() instead */
+  static int GetEventFD();
+
+  /** Call the functions of the timers that are due, without waiting. Call this on the main thread when GetEventFD() is readable */
+  static void RunPending();
+
+  /** Stop calling timer functions on the event loop thread, because a run loop now calls RunPending(). Calls are counted, match each one with DetachRunLoop() */
+  static void AttachRunLoop();
+
+  /** Resume calling timer functions on the event loop thread once every AttachRunLoop() has been matched */
+  static void DetachRunLoop();
+
+private:
+  class EventLoop;
+  ITimerFunction mTimerFunc;
+  uint32_t mIntervalMs;
+  std::atomic<bool> mRunning {false};
+};
 #else
   #error NOT IMPLEMENTED
 #endif
@@ -504,7 +504,9 @@ private:
   float mThreshold = 0.01f;
 };
 
-/** ISpectrumSender is designed for sending Spectral Data from the plug-in to the UI */
+/** ISpectrumSender is designed for sending Spectral Data from the plug-in to the UI
+ * Audio is queued in hops of fftSize/overlap samples. On the UI thread each hop is appended to a per-channel ring buffer holding the last fftSize samples,
+ * which is windowed and transformed with a single real FFT, so one spectrum is sent for every hop */
 template <int MAXNC = 1, int QUEUE_SIZE = 64, int MAX_FFT_SIZE = 4096>
 class ISpectrumSender : public IBufferSender<MAXNC, QUEUE_SIZE, MAX_FFT_SIZE>
 {
@@ -536,16 +538,17 @@ public:
 
   void SetFFTSize(int fftSize)
   {
-    TBufferSender::SetBufferSize(fftSize);
-    SetFFTSize();
-    CalculateWindow();
-    CalculateScalingFactors();
+    SetFFTSizeAndOverlap(fftSize, mOverlap);
   }
   
   void SetFFTSizeAndOverlap(int fftSize, int overlap)
   {
+    assert(fftSize >= 4 && fftSize <= MAX_FFT_SIZE);
+    assert(overlap > 0 && overlap <= fftSize);
+
+    mFFTSize = fftSize;
     mOverlap = overlap;
-    TBufferSender::SetBufferSize(fftSize);
+    TBufferSender::SetBufferSize(fftSize / overlap);
     SetFFTSize();
     CalculateWindow();
     CalculateScalingFactors();
@@ -564,40 +567,58 @@ public:
   
   void PrepareDataForUI(ISenderData<MAXNC, TDataPacket>& d) override
   {
-    auto fftSize = TBufferSender::GetBufferSize();
+    const auto fftSize = mFFTSize;
+    const auto hopSize = TBufferSender::GetBufferSize();
+    const auto nBins = fftSize / 2;
 
-    for (auto s = 0; s < fftSize; s++)
+    for (auto ch = d.chanOffset; ch < (d.chanOffset + d.nChans); ch++)
     {
-      for (auto stftFrameIdx = 0; stftFrameIdx < mOverlap; stftFrameIdx++)
-      {
-        auto& stftFrame = mSTFTFrames[stftFrameIdx];
-        
-        for (auto ch = 0; ch < MAXNC; ch++)
-        {
-          auto windowedValue = (float) d.vals[ch][s] * mWindow[stftFrame.pos];
-          stftFrame.bins[ch][stftFrame.pos].re = windowedValue;
-          stftFrame.bins[ch][stftFrame.pos].im = 0.0f;
-        }
-        
-        stftFrame.pos++;
+      float* pRing = mRingBuffers[ch].data();
+      float* pData = d.vals[ch].data();
 
-        if (stftFrame.pos >= fftSize)
-        {
-          stftFrame.pos = 0;
-          
-          for (auto ch = 0; ch < MAXNC; ch++)
-          {
-            Permute(ch, stftFrameIdx);
-            memcpy(d.vals[ch].data(), mSTFTOutput[ch].data(), fftSize * sizeof(float));
-          }
-        }
+      // Append the new hop, overwriting the oldest samples
+      const auto firstPart = std::min(hopSize, fftSize - mRingPos);
+      memcpy(pRing + mRingPos, pData, firstPart * sizeof(float));
+      memcpy(pRing, pData + firstPart, (hopSize - firstPart) * sizeof(float));
+
+      // Window the ring, oldest sample first
+      const auto oldest = (mRingPos + hopSize) % fftSize;
+      const auto nTail = fftSize - oldest;
+      WDL_FFT_REAL* pFFT = mFFTBuffer.data();
+      const float* pWindow = mWindow.data();
+
+      for (auto i = 0; i < nTail; i++)
+        pFFT[i] = pRing[oldest + i] * pWindow[i];
+
+      for (auto i = 0; i < oldest; i++)
+        pFFT[nTail + i] = pRing[i] * pWindow[nTail + i];
+
+      WDL_real_fft(pFFT, fftSize, false);
+
+      // De-interleave the bins in frequency order, the real FFT is scaled by two compared to the complex one
+      const WDL_FFT_COMPLEX* pBins = reinterpret_cast<const WDL_FFT_COMPLEX*>(pFFT);
+      float* pRe = mOutputType == EOutputType::Complex ? pData : mRe.data();
+      float* pIm = mOutputType == EOutputType::Complex ? pData + nBins : mIm.data();
+
+      for (auto i = 0; i < nBins; i++)
+      {
+        const WDL_FFT_COMPLEX& bin = pBins[mPermutation[i]];
+        pRe[i] = static_cast<float>(bin.re) * 0.5f;
+        pIm[i] = static_cast<float>(bin.im) * 0.5f;
       }
+
+      pIm[0] = 0.0f; // holds the nyquist bin
+
+      if (mOutputType == EOutputType::MagPhase)
+        CalculateMagPhase(pData, nBins);
     }
+
+    mRingPos = (mRingPos + hopSize) % fftSize;
   }
 
   int GetFFTSize() const
   {
-    return TBufferSender::GetBufferSize();
+    return mFFTSize;
   }
 
   int GetOverlap() const
@@ -608,30 +629,52 @@ public:
 private:
   void SetFFTSize()
   {
-    if (mSTFTFrames.size() != mOverlap)
+    const auto nBins = mFFTSize / 2;
+
+    for (auto i = 0; i < nBins; i++)
     {
-      mSTFTFrames.resize(mOverlap);
+      mPermutation[i] = WDL_fft_permute(nBins, i);
     }
-    
-    for (auto&& frame : mSTFTFrames)
+
+    for (auto ch = 0; ch < MAXNC; ch++)
     {
-      for (auto ch = 0; ch < MAXNC; ch++)
-      {
-        std::fill(frame.bins[ch].begin(), frame.bins[ch].end(), WDL_FFT_COMPLEX{0.0f, 0.0f});
-      }
-      
-      frame.pos = 0;
+      std::fill(mRingBuffers[ch].begin(), mRingBuffers[ch].end(), 0.0f);
     }
     
-    for (auto ch = 0; ch < MAXNC; ch++)
+    mRingPos = 0;
+  }
+  
+  void CalculateMagPhase(float* pOutput, int nBins)
+  {
+    const float magScale = 2.0f / mScalingFactor;
+    float* pMag = pOutput;
+    float* pPhase = pOutput + nBins;
+
+#if defined OS_IOS || defined OS_MAC
+    DSPSplitComplex split { mRe.data(), mIm.data() };
+    vDSP_zvmags(&split, 1, pMag, 1, nBins);
+    vDSP_vsmul(pMag, 1, &magScale, pMag, 1, nBins);
+    vvsqrtf(pMag, pMag, &nBins);
+    vvatan2f(pPhase, mIm.data(), mRe.data(), &nBins);
+#else
+    const float* pRe = mRe.data();
+    const float* pIm = mIm.data();
+
+    for (auto i = 0; i < nBins; i++)
     {
-      std::fill(mSTFTOutput[ch].begin(), mSTFTOutput[ch].end(), 0.0f);
+      pMag[i] = std::sqrt((pRe[i] * pRe[i] + pIm[i] * pIm[i]) * magScale);
     }
+
+    for (auto i = 0; i < nBins; i++)
+    {
+      pPhase[i] = std::atan2(pIm[i], pRe[i]);
+    }
+#endif
   }
   
   void CalculateWindow()
   {
-    const auto fftSize = TBufferSender::GetBufferSize();
+    const auto fftSize = mFFTSize;
 
     const float M = static_cast<float>(fftSize - 1);
     
@@ -668,7 +711,7 @@ private:
   
   void CalculateScalingFactors()
   {
-    const auto fftSize = TBufferSender::GetBufferSize();
+    const auto fftSize = mFFTSize;
     const float M = static_cast<float>(fftSize - 1);
 
     auto scaling = 0.0f;
@@ -682,47 +725,17 @@ private:
     mScalingFactor = scaling * scaling;
   }
   
-  void Permute(int ch, int frameIdx)
-  {
-    const auto fftSize = TBufferSender::GetBufferSize();
-    WDL_fft(mSTFTFrames[frameIdx].bins[ch].data(), fftSize, false);
-
-    if (mOutputType == EOutputType::Complex)
-    {
-      auto nBins = fftSize/2;
-      for (auto i = 0; i < nBins; ++i)
-      {
-        int sortIdx = WDL_fft_permute(fftSize, i);
-        mSTFTOutput[ch][i] = mSTFTFrames[frameIdx].bins[ch][sortIdx].re;
-        mSTFTOutput[ch][i + nBins] = mSTFTFrames[frameIdx].bins[ch][sortIdx].im;
-      }
-    }
-    else // magPhase
-    {
-      auto nBins = fftSize/2;
-      for (auto i = 0; i < nBins; ++i)
-      {
-        int sortIdx = WDL_fft_permute(fftSize, i);
-        auto re = mSTFTFrames[frameIdx].bins[ch][sortIdx].re;
-        auto im = mSTFTFrames[frameIdx].bins[ch][sortIdx].im;
-        mSTFTOutput[ch][i] = std::sqrt(2.0f * (re * re + im * im) / mScalingFactor);
-        mSTFTOutput[ch][i + nBins] = std::atan2(im, re);
-      }
-    }
-  }
-  
-  struct STFTFrame
-  {
-    int pos;
-    std::array<std::array<WDL_FFT_COMPLEX, MAX_FFT_SIZE>, MAXNC> bins;
-  };
-  
+  int mFFTSize = MAX_FFT_SIZE;
   int mOverlap = 2;
+  int mRingPos = 0;
   EWindowType mWindowType;
   EOutputType mOutputType;
   std::array<float, MAX_FFT_SIZE> mWindow;
-  std::vector<STFTFrame> mSTFTFrames;
-  std::array<std::array<float, MAX_FFT_SIZE>, MAXNC> mSTFTOutput;
+  std::array<int, MAX_FFT_SIZE / 2> mPermutation;
+  std::array<std::array<float, MAX_FFT_SIZE>, MAXNC> mRingBuffers;
+  std::array<WDL_FFT_REAL, MAX_FFT_SIZE> mFFTBuffer;
+  std::array<float, MAX_FFT_SIZE / 2> mRe;
+  std::array<float, MAX_FFT_SIZE / 2> mIm;
   float mScalingFactor = 0.0f;
 };
 
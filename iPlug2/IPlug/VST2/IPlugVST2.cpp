@@ -417,6 +417,7 @@ VstIntPtr VSTCALLBACK IPlugVST2::VSTDispatcher(AEffect *pEffect, VstInt32 opCode
           const double v = pParam->StringToValue((const char *)ptr);
           pParam->Set(v);
           _this->SendParameterValueFromAPI(idx, v, false);
+          IPLUG_PROFILE_SCOPE("OnParamChange");
           _this->OnParamChange(idx, kHost);
           LEAVE_PARAMS_MUTEX_STATIC
         }
@@ -561,6 +562,7 @@ VstIntPtr VSTCALLBACK IPlugVST2::VSTDispatcher(AEffect *pEffect, VstInt32 opCode
             {
               VstMidiEvent* pME = (VstMidiEvent*) pEvent;
               IMidiMsg msg(pME->deltaFrames, pME->midiData[0], pME->midiData[1], pME->midiData[2]);
+              IPLUG_PROFILE_SCOPE("ProcessMidiMsg");
               _this->ProcessMidiMsg(msg);
               _this->mMidiMsgsFromProcessor.Push(msg);
 
@@ -976,6 +978,7 @@ void IPlugVST2::VSTPreProcess(SAMPLETYPE** inputs, SAMPLETYPE** outputs, VstInt3
 
   while (mMidiMsgsFromEditor.Pop(msg))
   {
+    IPLUG_PROFILE_SCOPE("ProcessMidiMsg");
     ProcessMidiMsg(msg);
   }
 }
@@ -986,6 +989,7 @@ void VSTCALLBACK IPlugVST2::VSTProcess(AEffect* pEffect, float** inputs, float**
   TRACE
   IPlugVST2* _this = (IPlugVST2*) pEffect->object;
   _this->VSTPreProcess(inputs, outputs, nFrames);
+  _this->ApplyRestoredParams();
   ENTER_PARAMS_MUTEX_STATIC
   _this->ProcessBuffersAccumulating(nFrames);
   LEAVE_PARAMS_MUTEX_STATIC
@@ -997,6 +1001,7 @@ void VSTCALLBACK IPlugVST2::VSTProcessReplacing(AEffect* pEffect, float** inputs
   TRACE
   IPlugVST2* _this = (IPlugVST2*) pEffect->object;
   _this->VSTPreProcess(inputs, outputs, nFrames);
+  _this->ApplyRestoredParams();
   ENTER_PARAMS_MUTEX_STATIC
   _this->ProcessBuffers((float) 0.0f, nFrames);
   LEAVE_PARAMS_MUTEX_STATIC
@@ -1008,6 +1013,7 @@ void VSTCALLBACK IPlugVST2::VSTProcessDoubleReplacing(AEffect* pEffect, double**
   TRACE
   IPlugVST2* _this = (IPlugVST2*) pEffect->object;
   _this->VSTPreProcess(inputs, outputs, nFrames);
+  _this->ApplyRestoredParams();
   ENTER_PARAMS_MUTEX_STATIC
   _this->ProcessBuffers((double) 0.0, nFrames);
   LEAVE_PARAMS_MUTEX_STATIC
@@ -1038,6 +1044,7 @@ void VSTCALLBACK IPlugVST2::VSTSetParameter(AEffect *pEffect, VstInt32 idx, floa
     ENTER_PARAMS_MUTEX_STATIC
     _this->GetParam(idx)->SetNormalized(value);
     _this->SendParameterValueFromAPI(idx, value, true);
+    IPLUG_PROFILE_SCOPE("OnParamChange");
     _this->OnParamChange(idx, kHost);
     LEAVE_PARAMS_MUTEX_STATIC
   }
@@ -1048,10 +1055,13 @@ void IPlugVST2::OutputSysexFromEditor()
   //Output SYSEX from the editor, which has bypassed ProcessSysEx()
   if(mSysExDataFromEditor.ElementsAvailable())
   {
-    while (mSysExDataFromEditor.Pop(mSysexBuf))
+    ISysEx smsg;
+
+    while (mSysExDataFromEditor.Read(smsg))
     {
-      ISysEx smsg {mSysexBuf.mOffset, mSysexBuf.mData, mSysexBuf.mSize};
       SendSysEx(smsg);
     }
+
+    mSysExDataFromEditor.Release();
   }
 }
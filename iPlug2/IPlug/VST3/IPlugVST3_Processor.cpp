@@ -88,7 +88,7 @@ tresult PLUGIN_API IPlugVST3Processor::process(ProcessData& data)
 {
   TRACE
   
-  Process(data, processSetup, audioInputs, audioOutputs, mMidiMsgsFromEditor, mMidiMsgsFromProcessor, mSysExDataFromEditor, mSysexBuf);
+  Process(data, processSetup, audioInputs, audioOutputs, mMidiMsgsFromEditor, mMidiMsgsFromProcessor, mSysExDataFromEditor);
   return kResultOk;
 }
 
@@ -193,9 +193,8 @@ tresult PLUGIN_API IPlugVST3Processor::notify(IMessage* message)
     {
       int64 offset = 0;
       message->getAttributes()->getInt("O", offset);
-      SysExData sysex {(int) offset, (int) size, data};
-      mSysExDataFromEditor.Push(sysex);
-      return kResultOk;
+      if (mSysExDataFromEditor.Push((int) offset, (int) size, data))
+        return kResultOk;
     }
     return kResultFalse;
   }
@@ -235,7 +234,7 @@ void IPlugVST3Processor::TransmitMidiMsgFromProcessor(const IMidiMsg& msg)
   sendMessage(message);
 }
 
-void IPlugVST3Processor::TransmitSysExDataFromProcessor(const SysExData& data)
+void IPlugVST3Processor::TransmitSysExDataFromProcessor(const ISysEx& msg)
 {
   OPtr<IMessage> message = allocateMessage();
   
@@ -243,7 +242,7 @@ void IPlugVST3Processor::TransmitSysExDataFromProcessor(const SysExData& data)
     return;
   
   message->setMessageID("SSMFD");
-  message->getAttributes()->setBinary("D", (void*) data.mData, data.mSize);
-  message->getAttributes()->setInt("O", data.mOffset);
+  message->getAttributes()->setBinary("D", (void*) msg.mData, msg.mSize);
+  message->getAttributes()->setInt("O", msg.mOffset);
   sendMessage(message);
 }
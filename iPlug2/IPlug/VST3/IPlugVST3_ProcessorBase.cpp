@@ -82,6 +82,7 @@ void IPlugVST3ProcessorBase::ProcessMidiIn(IEventList* pEventList, IPlugQueue<IM
           case Event::kNoteOnEvent:
           {
             msg.MakeNoteOnMsg(event.noteOn.pitch, event.noteOn.velocity * 127, event.sampleOffset, event.noteOn.channel);
+            IPLUG_PROFILE_SCOPE("ProcessMidiMsg");
             ProcessMidiMsg(msg);
             processorQueue.Push(msg);
             break;
@@ -90,6 +91,7 @@ void IPlugVST3ProcessorBase::ProcessMidiIn(IEventList* pEventList, IPlugQueue<IM
           case Event::kNoteOffEvent:
           {
             msg.MakeNoteOffMsg(event.noteOff.pitch, event.sampleOffset, event.noteOff.channel);
+            IPLUG_PROFILE_SCOPE("ProcessMidiMsg");
             ProcessMidiMsg(msg);
             processorQueue.Push(msg);
             break;
@@ -97,6 +99,7 @@ void IPlugVST3ProcessorBase::ProcessMidiIn(IEventList* pEventList, IPlugQueue<IM
           case Event::kPolyPressureEvent:
           {
             msg.MakePolyATMsg(event.polyPressure.pitch, event.polyPressure.pressure * 127., event.sampleOffset, event.polyPressure.channel);
+            IPLUG_PROFILE_SCOPE("ProcessMidiMsg");
             ProcessMidiMsg(msg);
             processorQueue.Push(msg);
             break;
@@ -114,13 +117,30 @@ void IPlugVST3ProcessorBase::ProcessMidiIn(IEventList* pEventList, IPlugQueue<IM
   
   while (editorQueue.Pop(msg))
   {
+    IPLUG_PROFILE_SCOPE("ProcessMidiMsg");
     ProcessMidiMsg(msg);
   }
 }
 
-void IPlugVST3ProcessorBase::ProcessMidiOut(IPlugQueue<SysExData>& sysExQueue, SysExData& sysExBuf, IEventList* pOutputEvents, int32 numSamples)
+void IPlugVST3ProcessorBase::ProcessMidiOut(IPlugByteQueue& sysExQueue, IEventList* pOutputEvents, int32 numSamples)
 {
-  if (!mMidiOutputQueue.Empty() && pOutputEvents)
+  // The host has consumed the output events of the previous block, which point into the SysEx queue
+  sysExQueue.Release();
+  
+  // Without an output event list the host is not taking MIDI output, so discard it rather than let the queues grow and deliver it late
+  if (!pOutputEvents)
+  {
+    ISysEx msg;
+    
+    mMidiOutputQueue.Clear();
+    
+    while (sysExQueue.Read(msg)) {}
+    
+    sysExQueue.Release();
+    return;
+  }
+  
+  if (!mMidiOutputQueue.Empty())
   {
     Event toAdd = {0};
     IMidiMsg msg;
@@ -194,14 +214,16 @@ void IPlugVST3ProcessorBase::ProcessMidiOut(IPlugQueue<SysExData>& sysExQueue, S
   if (sysExQueue.ElementsAvailable())
   {
     Event toAdd = {0};
+    ISysEx msg;
     
-    while (sysExQueue.Pop(sysExBuf))
+    // Each event points at its message in the queue, which is not reused until the next block
+    while (sysExQueue.Read(msg))
     {
       toAdd.type = Event::kDataEvent;
-      toAdd.sampleOffset = sysExBuf.mOffset;
+      toAdd.sampleOffset = msg.mOffset;
       toAdd.data.type = DataEvent::kMidiSysEx;
-      toAdd.data.size = sysExBuf.mSize;
-      toAdd.data.bytes = (uint8*) sysExBuf.mData; // TODO!  this is a problem if more than one message in this block!
+      toAdd.data.size = msg.mSize;
+      toAdd.data.bytes = msg.mData;
       pOutputEvents->addEvent(toAdd);
     }
   }
@@ -307,16 +329,19 @@ void IPlugVST3ProcessorBase::ProcessParameterChanges(ProcessData& data, IPlugQue
             {
               if (idx >= 0 && idx < mPlug.NParams())
               {
-#ifdef PARAMS_MUTEX
-                mPlug.mParams_mutex.Enter();
-#endif
-                mPlug.GetParam(idx)->SetNormalized(value);
-              
-                // In VST3 non distributed the same parameter value is also set via IPlugVST3Controller::setParamNormalized(ParamID tag, ParamValue value)
-                mPlug.OnParamChange(idx, kHost, offsetSamples);
-#ifdef PARAMS_MUTEX
-                mPlug.mParams_mutex.Leave();
-#endif
+                if (GetSampleAccurateAutomation())
+                {
+                  // Queue every point, ProcessBuffers() splits the block at their offsets
+                  for (int32 pointIdx = 0; pointIdx < numPoints; pointIdx++)
+                  {
+                    if (paramQueue->getPoint(pointIdx, offsetSamples, value) == kResultTrue)
+                      EnqueueParamChange(idx, value, offsetSamples);
+                  }
+                }
+                else
+                {
+                  ApplyParamChange(IParamChange(idx, value, offsetSamples));
+                }
               }
               else if (idx >= kMIDICCParamStartIdx)
               {
@@ -334,6 +359,7 @@ void IPlugVST3ProcessorBase::ProcessParameterChanges(ProcessData& data, IPlugQue
                   msg.MakeControlChangeMsg((IMidiMsg::EControlChangeMsg) ctrlr, value, channel, offsetSamples);
 
                 fromProcessor.Push(msg);
+                IPLUG_PROFILE_SCOPE("ProcessMidiMsg");
                 ProcessMidiMsg(msg);
               }
             }
@@ -345,6 +371,21 @@ void IPlugVST3ProcessorBase::ProcessParameterChanges(ProcessData& data, IPlugQue
   }
 }
 
+void IPlugVST3ProcessorBase::ApplyParamChange(const IParamChange& change)
+{
+#ifdef PARAMS_MUTEX
+  mPlug.mParams_mutex.Enter();
+#endif
+  mPlug.GetParam(change.mIdx)->SetNormalized(change.mValue);
+
+  // In VST3 non distributed the same parameter value is also set via IPlugVST3Controller::setParamNormalized(ParamID tag, ParamValue value)
+  IPLUG_PROFILE_SCOPE("OnParamChange");
+  mPlug.OnParamChange(change.mIdx, kHost, change.mOffset);
+#ifdef PARAMS_MUTEX
+  mPlug.mParams_mutex.Leave();
+#endif
+}
+
 void IPlugVST3ProcessorBase::ProcessAudio(ProcessData& data, ProcessSetup& setup, const BusList& ins, const BusList& outs)
 {
   int32 sampleSize = setup.symbolicSampleSize;
@@ -396,6 +437,8 @@ void IPlugVST3ProcessorBase::ProcessAudio(ProcessData& data, ProcessSetup& setup
       chanOffset += busChannels;
     }
     
+    mPlug.ApplyRestoredParams();
+    
     if (GetBypassed())
     {
       if (sampleSize == kSample32)
@@ -419,7 +462,7 @@ void IPlugVST3ProcessorBase::ProcessAudio(ProcessData& data, ProcessSetup& setup
   }
 }
 
-void IPlugVST3ProcessorBase::Process(ProcessData& data, ProcessSetup& setup, const BusList& ins, const BusList& outs, IPlugQueue<IMidiMsg>& fromEditor, IPlugQueue<IMidiMsg>& fromProcessor, IPlugQueue<SysExData>& sysExFromEditor, SysExData& sysExBuf)
+void IPlugVST3ProcessorBase::Process(ProcessData& data, ProcessSetup& setup, const BusList& ins, const BusList& outs, IPlugQueue<IMidiMsg>& fromEditor, IPlugQueue<IMidiMsg>& fromProcessor, IPlugByteQueue& sysExFromEditor)
 {
   PrepareProcessContext(data, setup);
   ProcessParameterChanges(data, fromProcessor);
@@ -433,7 +476,7 @@ void IPlugVST3ProcessorBase::Process(ProcessData& data, ProcessSetup& setup, con
   
   if (DoesMIDIOut())
   {
-    ProcessMidiOut(sysExFromEditor, sysExBuf, data.outputEvents, data.numSamples);
+    ProcessMidiOut(sysExFromEditor, data.outputEvents, data.numSamples);
   }
 }
 
@@ -66,6 +66,7 @@ void IPlugWAM::onProcess(WAM::AudioBus* pAudio, void* pData)
   AttachBuffers(ERoute::kInput, 0, NChannelsConnected(ERoute::kInput), pAudio->inputs, blockSize);
   AttachBuffers(ERoute::kOutput, 0, NChannelsConnected(ERoute::kOutput), pAudio->outputs, blockSize);
   
+  ApplyRestoredParams();
   ENTER_PARAMS_MUTEX
   ProcessBuffers((float) 0.0f, blockSize);
   LEAVE_PARAMS_MUTEX
@@ -108,6 +109,7 @@ void IPlugWAM::onMessage(char* verb, char* res, double data)
     }
     
     IMidiMsg msg = {0, data[0], data[1], data[2]};
+    IPLUG_PROFILE_SCOPE("ProcessMidiMsg");
     ProcessMidiMsg(msg); // TODO: should queue to mMidiMsgsFromEditor?
   }
   else if(strcmp(verb, "SAMFUI") == 0) // SAMFUI
@@ -159,6 +161,7 @@ void IPlugWAM::onMidi(byte status, byte data1, byte data2)
 {
 //   DBGMSG("onMidi\n");
   IMidiMsg msg = {0, status, data1, data2};
+  IPLUG_PROFILE_SCOPE("ProcessMidiMsg");
   ProcessMidiMsg(msg); // onMidi is not called on HPT. We could queue things up, but just process the message straightaway for now
   //mMidiMsgsFromProcessor.Push(msg);
   
@@ -0,0 +1,119 @@
+/*
+ ==============================================================================
+
+ This file is part of the iPlug 2 library. Copyright (C) the iPlug 2 developers.
+
+ See LICENSE.txt for  more info.
+
+ ==============================================================================
+*/
+
+/*
+ OverSampler::ProcessBlock() throughput, us per 512 frame block (up + down with a trivial callback), for 1, 2, 4 and 8 channels at 2x-16x.
+ Also checks that every channel of a multi-channel OverSampler is identical to a mono OverSampler, which always uses the scalar stages.
+
+ From the iPlug2 folder:
+ g++ -std=c++17 -O2 -IIPlug -IIPlug/Extras -IWDL Tests/Benchmarks/OverSamplerBench.cpp -o OverSamplerBench
+ g++ -std=c++17 -O2 -DIPLUG_SIMDE -IIPlug -IIPlug/Extras -IWDL Tests/Benchmarks/OverSamplerBench.cpp -o OverSamplerBench_SIMD
+*/
+
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "IPlugConstants.h"
+#include "Oversampler.h"
+
+using namespace iplug;
+
+static constexpr int kBlockSize = 512;
+static constexpr int kIterations = 400;
+static constexpr int kMaxChans = 8;
+
+template <typename T>
+static bool Run(const char* typeName)
+{
+  bool identical = true;
+
+  printf("%s, us per %d frame block\n", typeName, kBlockSize);
+
+  for (int nChans : {1, 2, 4, 8})
+  {
+    printf("%d ch ", nChans);
+
+    for (int f = k2x; f <= k16x; f++)
+    {
+      const EFactor factor = static_cast<EFactor>(f);
+      OverSampler<T> overSampler(factor, true, nChans, nChans);
+      overSampler.Reset(kBlockSize);
+
+      std::vector<std::vector<T>> in(nChans, std::vector<T>(kBlockSize)), out(nChans, std::vector<T>(kBlockSize)), ref(nChans, std::vector<T>(kBlockSize));
+      T* pIn[kMaxChans];
+      T* pOut[kMaxChans];
+
+      for (int c = 0; c < nChans; c++)
+      {
+        pIn[c] = in[c].data();
+        pOut[c] = out[c].data();
+
+        for (int s = 0; s < kBlockSize; s++)
+          in[c][s] = static_cast<T>(std::sin(0.01 * (s + 1) * (c + 1)));
+      }
+
+      auto func = [nChans](T** inputs, T** outputs, int nFrames) {
+        for (int c = 0; c < nChans; c++)
+          for (int s = 0; s < nFrames; s++)
+            outputs[c][s] = inputs[c][s] * static_cast<T>(0.5);
+      };
+
+      const auto start = std::chrono::steady_clock::now();
+
+      for (int i = 0; i < kIterations; i++)
+        overSampler.ProcessBlock(pIn, pOut, kBlockSize, nChans, nChans, func);
+
+      const double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / kIterations;
+      printf("%8.1f (%2dx)", us, 1 << f);
+
+      // Each channel through its own mono OverSampler, for the same number of blocks
+      for (int c = 0; c < nChans; c++)
+      {
+        OverSampler<T> mono(factor, true, 1, 1);
+        mono.Reset(kBlockSize);
+        T* pMonoIn[1] = { pIn[c] };
+        T* pMonoOut[1] = { ref[c].data() };
+        auto monoFunc = [](T** inputs, T** outputs, int nFrames) {
+          for (int s = 0; s < nFrames; s++)
+            outputs[0][s] = inputs[0][s] * static_cast<T>(0.5);
+        };
+
+        for (int i = 0; i < kIterations; i++)
+          mono.ProcessBlock(pMonoIn, pMonoOut, kBlockSize, 1, 1, monoFunc);
+
+        if (memcmp(ref[c].data(), out[c].data(), kBlockSize * sizeof(T)))
+          identical = false;
+      }
+    }
+
+    printf("\n");
+  }
+
+  return identical;
+}
+
+int main(int argc, char** argv)
+{
+#if defined IPLUG_SIMDE
+  printf("IPLUG_SIMDE: groups of %d channels in SIMD lanes\n", OverSampler<double>::kNLanes);
+#else
+  printf("scalar stages\n");
+#endif
+
+  const bool doubleOK = Run<double>("double");
+  const bool floatOK = Run<float>("float");
+
+  printf("multi-channel output %s mono output\n", doubleOK && floatOK ? "is identical to" : "DIFFERS from");
+  return doubleOK && floatOK ? 0 : 1;
+}
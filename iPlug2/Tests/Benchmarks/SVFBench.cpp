@@ -0,0 +1,141 @@
+/*
+ ==============================================================================
+
+ This file is part of the iPlug 2 library. Copyright (C) the iPlug 2 developers.
+
+ See LICENSE.txt for  more info.
+
+ ==============================================================================
+*/
+
+/*
+ SVF::ProcessBlock() throughput, us per 512 frame block, for 1, 2, 4 and 8 channels: with fixed coefficients, with the cutoff modulated per
+ sample (FastTan()), and with the cutoff set per sample via SetFreqCPS() and one frame blocks (std::tan()), which is what modulation cost before.
+ Also reports the relative error of SVF::FastTan() against std::tan() and the difference between the fixed and modulated paths at a constant cutoff.
+
+ From the iPlug2 folder:
+ g++ -std=c++17 -O2 -IIPlug -IIPlug/Extras -IWDL Tests/Benchmarks/SVFBench.cpp -o SVFBench
+ g++ -std=c++17 -O2 -DIPLUG_SIMDE -IIPlug -IIPlug/Extras -IWDL Tests/Benchmarks/SVFBench.cpp -o SVFBench_SIMD
+*/
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "IPlugConstants.h"
+#include "IPlugUtilities.h"
+#include "SVF.h"
+
+using namespace iplug;
+
+static constexpr int kBlockSize = 512;
+static constexpr int kIterations = 400;
+static constexpr int kMaxChans = 8;
+
+using TSVF = SVF<double, kMaxChans>;
+
+// FastTan() is documented to be within 2e-6, and the filters should follow it closely
+static constexpr double kMaxTanError = 2e-6;
+static constexpr double kMaxPathDiff = 1e-4;
+
+template <typename F>
+static double Time(F&& func)
+{
+  const auto start = std::chrono::steady_clock::now();
+
+  for (int i = 0; i < kIterations; i++)
+    func();
+
+  return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / kIterations;
+}
+
+int main(int argc, char** argv)
+{
+#if defined IPLUG_SIMDE
+  printf("IPLUG_SIMDE: pairs of channels in SSE2 lanes\n");
+#else
+  printf("scalar\n");
+#endif
+
+  std::vector<std::vector<double>> in(kMaxChans, std::vector<double>(kBlockSize)), out(kMaxChans, std::vector<double>(kBlockSize)), ref(kMaxChans, std::vector<double>(kBlockSize));
+  std::vector<double> freqs(kBlockSize);
+  double* pIn[kMaxChans];
+  double* pOut[kMaxChans];
+  double* pRef[kMaxChans];
+
+  for (int c = 0; c < kMaxChans; c++)
+  {
+    pIn[c] = in[c].data();
+    pOut[c] = out[c].data();
+    pRef[c] = ref[c].data();
+
+    for (int s = 0; s < kBlockSize; s++)
+      in[c][s] = std::sin(0.01 * (s + 1) * (c + 1));
+  }
+
+  for (int s = 0; s < kBlockSize; s++)
+    freqs[s] = 1000. + 500. * std::sin(0.01 * s);
+
+  printf("us per %d frame block: fixed / modulated (FastTan) / SetFreqCPS per sample (std::tan)\n", kBlockSize);
+
+  for (int nChans : {1, 2, 4, 8})
+  {
+    TSVF fixed(TSVF::kLowPass, 1000.), modulated(TSVF::kLowPass, 1000.), perSample(TSVF::kLowPass, 1000.);
+
+    const double tFixed = Time([&]() { fixed.ProcessBlock(pIn, pOut, nChans, kBlockSize); });
+    const double tModulated = Time([&]() { modulated.ProcessBlock(pIn, pOut, nChans, kBlockSize, freqs.data()); });
+    const double tPerSample = Time([&]() {
+      for (int s = 0; s < kBlockSize; s++)
+      {
+        double* pIn1[kMaxChans];
+        double* pOut1[kMaxChans];
+
+        for (int c = 0; c < nChans; c++)
+        {
+          pIn1[c] = pIn[c] + s;
+          pOut1[c] = pOut[c] + s;
+        }
+
+        perSample.SetFreqCPS(freqs[s]);
+        perSample.ProcessBlock(pIn1, pOut1, nChans, 1);
+      }
+    });
+
+    printf("%d ch %8.1f %8.1f %8.1f\n", nChans, tFixed, tModulated, tPerSample);
+  }
+
+  double maxTanError = 0.;
+
+  for (int i = 1; i < 100000; i++)
+  {
+    const double x = 0.4999 * PI * i / 100000.;
+    maxTanError = std::max(maxTanError, std::abs(TSVF::FastTan(x) / std::tan(x) - 1.));
+  }
+
+  // The modulated path at a constant cutoff against the fixed path, for every mode
+  double maxPathDiff = 0.;
+  std::fill(freqs.begin(), freqs.end(), 3000.);
+
+  for (int m = 0; m < TSVF::kNumModes; m++)
+  {
+    TSVF fixed(static_cast<TSVF::EMode>(m), 3000.), modulated(static_cast<TSVF::EMode>(m), 3000.);
+    fixed.SetQ(2.);
+    modulated.SetQ(2.);
+    fixed.SetGain(6.);
+    modulated.SetGain(6.);
+
+    fixed.ProcessBlock(pIn, pRef, kMaxChans, kBlockSize);
+    modulated.ProcessBlock(pIn, pOut, kMaxChans, kBlockSize, freqs.data());
+
+    for (int c = 0; c < kMaxChans; c++)
+      for (int s = 0; s < kBlockSize; s++)
+        maxPathDiff = std::max(maxPathDiff, std::abs(ref[c][s] - out[c][s]));
+  }
+
+  const bool ok = maxTanError <= kMaxTanError && maxPathDiff <= kMaxPathDiff;
+  printf("FastTan relative error %g, fixed vs modulated max diff %g: %s\n", maxTanError, maxPathDiff, ok ? "ok" : "FAIL");
+  return ok ? 0 : 1;
+}
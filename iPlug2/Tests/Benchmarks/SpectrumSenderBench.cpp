@@ -0,0 +1,266 @@
+/*
+ ==============================================================================
+
+ This file is part of the iPlug 2 library. Copyright (C) the iPlug 2 developers.
+
+ See LICENSE.txt for  more info.
+
+ ==============================================================================
+*/
+
+/*
+ ISpectrumSender::PrepareDataForUI() cost for 8 channels at FFT sizes 256-4096, with complex and mag/phase output, in us per fftSize samples of audio
+ (which is overlap hops), with overlaps 1 and 4. Each is compared with ReferenceSpectrum, the per-sample complex FFT path that PrepareDataForUI()
+ used before it was reworked, which is kept here as it was.
+ With overlap 1 both compute the same spectrum, and the outputs are checked to match. With overlap > 1 the reference's frames all start together,
+ so it computes overlap identical spectra per fftSize samples, and only the timings are compared.
+
+ From the iPlug2 folder:
+ gcc -O2 -c WDL/fft.c -o fft.o
+ g++ -std=c++17 -O2 -Wno-multichar -IIPlug -IWDL Tests/Benchmarks/SpectrumSenderBench.cpp fft.o -o SpectrumSenderBench
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+#include "IPlugEditorDelegate.h"
+#include "ISender.h"
+
+using namespace iplug;
+
+static constexpr int kNChans = 8;
+static constexpr int kMaxFFTSize = 4096;
+
+// Relative to the largest magnitude in the spectrum. Phases are only compared for bins above kPhaseMinMag, as they are noise below it
+static constexpr float kMaxMagError = 1e-4f;
+static constexpr float kMaxPhaseError = 1e-3f;
+static constexpr float kPhaseMinMag = 1e-3f;
+
+using TSender = ISpectrumSender<kNChans, 2, kMaxFFTSize>;
+using TData = ISenderData<kNChans, TSender::TDataPacket>;
+
+/** The replaced ISpectrumSender::PrepareDataForUI() path, Hann window only. Takes fftSize samples per call */
+class ReferenceSpectrum
+{
+public:
+  ReferenceSpectrum(int fftSize, int overlap, TSender::EOutputType outputType)
+  : mFFTSize(fftSize)
+  , mOverlap(overlap)
+  , mOutputType(outputType)
+  , mSTFTFrames(overlap)
+  {
+    WDL_fft_init();
+
+    const float M = static_cast<float>(fftSize - 1);
+    auto scaling = 0.0f;
+
+    for (auto i = 0; i < fftSize; i++)
+    {
+      mWindow[i] = 0.5f * (1.0f - std::cos(PI * 2.0f * i / M));
+      scaling += 0.5f * (1.0f - std::cos(2.0f * PI * i / M));
+    }
+
+    mScalingFactor = scaling * scaling;
+
+    for (auto&& frame : mSTFTFrames)
+    {
+      for (auto ch = 0; ch < kNChans; ch++)
+        std::fill(frame.bins[ch].begin(), frame.bins[ch].end(), WDL_FFT_COMPLEX{0.0f, 0.0f});
+
+      frame.pos = 0;
+    }
+  }
+
+  void PrepareDataForUI(TData& d)
+  {
+    const auto fftSize = mFFTSize;
+
+    for (auto s = 0; s < fftSize; s++)
+    {
+      for (auto stftFrameIdx = 0; stftFrameIdx < mOverlap; stftFrameIdx++)
+      {
+        auto& stftFrame = mSTFTFrames[stftFrameIdx];
+
+        for (auto ch = 0; ch < kNChans; ch++)
+        {
+          auto windowedValue = (float) d.vals[ch][s] * mWindow[stftFrame.pos];
+          stftFrame.bins[ch][stftFrame.pos].re = windowedValue;
+          stftFrame.bins[ch][stftFrame.pos].im = 0.0f;
+        }
+
+        stftFrame.pos++;
+
+        if (stftFrame.pos >= fftSize)
+        {
+          stftFrame.pos = 0;
+
+          for (auto ch = 0; ch < kNChans; ch++)
+          {
+            Permute(ch, stftFrameIdx);
+            memcpy(d.vals[ch].data(), mSTFTOutput[ch].data(), fftSize * sizeof(float));
+          }
+        }
+      }
+    }
+  }
+
+private:
+  void Permute(int ch, int frameIdx)
+  {
+    const auto fftSize = mFFTSize;
+    WDL_fft(mSTFTFrames[frameIdx].bins[ch].data(), fftSize, false);
+
+    auto nBins = fftSize/2;
+
+    for (auto i = 0; i < nBins; ++i)
+    {
+      int sortIdx = WDL_fft_permute(fftSize, i);
+      auto re = mSTFTFrames[frameIdx].bins[ch][sortIdx].re;
+      auto im = mSTFTFrames[frameIdx].bins[ch][sortIdx].im;
+
+      if (mOutputType == TSender::EOutputType::Complex)
+      {
+        mSTFTOutput[ch][i] = re;
+        mSTFTOutput[ch][i + nBins] = im;
+      }
+      else
+      {
+        mSTFTOutput[ch][i] = std::sqrt(2.0f * (re * re + im * im) / mScalingFactor);
+        mSTFTOutput[ch][i + nBins] = std::atan2(im, re);
+      }
+    }
+  }
+
+  struct STFTFrame
+  {
+    int pos;
+    std::array<std::array<WDL_FFT_COMPLEX, kMaxFFTSize>, kNChans> bins;
+  };
+
+  int mFFTSize;
+  int mOverlap;
+  TSender::EOutputType mOutputType;
+  std::array<float, kMaxFFTSize> mWindow;
+  std::vector<STFTFrame> mSTFTFrames;
+  std::array<std::array<float, kMaxFFTSize>, kNChans> mSTFTOutput;
+  float mScalingFactor = 0.0f;
+};
+
+static void FillAudio(TData& d, int nSamples)
+{
+  for (int c = 0; c < kNChans; c++)
+    for (int s = 0; s < nSamples; s++)
+      d.vals[c][s] = static_cast<float>(std::sin(0.05 * (s + 1) * (c + 1)) + 0.25 * std::sin(0.9 * (s + 1) / (c + 1)));
+}
+
+/** Time fn(), which transforms in place, on a fresh copy of the audio for each call. @return us per fftSize samples, or -1 if the output is not finite */
+template <typename T>
+static double Time(T&& fn, const TData& audio, int samplesPerCall, int fftSize)
+{
+  auto pData = std::make_unique<TData>();
+  const int nCalls = std::max((1 << 22) / samplesPerCall / kNChans, 8);
+  float check = 0.f;
+
+  const auto start = std::chrono::steady_clock::now();
+
+  for (int i = 0; i < nCalls; i++)
+  {
+    *pData = audio;
+    fn(*pData);
+    check += pData->vals[0][1];
+  }
+
+  const double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / nCalls;
+  return std::isfinite(check) ? us * fftSize / samplesPerCall : -1.;
+}
+
+/** @return the largest error of the new output against the reference, relative to the largest magnitude, for overlap 1 */
+static float Compare(int fftSize, TSender::EOutputType outputType, const TData& audio)
+{
+  auto pSender = std::make_unique<TSender>(fftSize, 1, TSender::EWindowType::Hann, outputType);
+  auto pReference = std::make_unique<ReferenceSpectrum>(fftSize, 1, outputType);
+  auto pNew = std::make_unique<TData>(audio);
+  auto pOld = std::make_unique<TData>(audio);
+  pSender->PrepareDataForUI(*pNew);
+  pReference->PrepareDataForUI(*pOld);
+
+  const int nBins = fftSize / 2;
+  float maxError = 0.f;
+
+  for (int c = 0; c < kNChans; c++)
+  {
+    const float* pN = pNew->vals[c].data();
+    const float* pO = pOld->vals[c].data();
+    float peak = 0.f;
+
+    for (int i = 0; i < nBins; i++)
+      peak = std::max(peak, outputType == TSender::EOutputType::Complex ? std::hypot(pO[i], pO[i + nBins]) : pO[i]);
+
+    for (int i = 0; i < nBins; i++)
+    {
+      if (outputType == TSender::EOutputType::Complex)
+      {
+        maxError = std::max(maxError, std::fabs(pN[i] - pO[i]) / peak);
+        maxError = std::max(maxError, std::fabs(pN[i + nBins] - pO[i + nBins]) / peak);
+      }
+      else
+      {
+        maxError = std::max(maxError, std::fabs(pN[i] - pO[i]) / peak);
+
+        if (pO[i] > kPhaseMinMag * peak)
+        {
+          const float d = std::fabs(std::remainder(pN[i + nBins] - pO[i + nBins], 2.f * static_cast<float>(PI)));
+
+          if (d > kMaxPhaseError)
+            maxError = std::max(maxError, 1.f); // fails the check
+        }
+      }
+    }
+  }
+
+  return maxError;
+}
+
+int main(int argc, char** argv)
+{
+  auto pAudio = std::make_unique<TData>(kNoTag, kNChans, 0);
+  FillAudio(*pAudio, kMaxFFTSize);
+  bool pass = true;
+
+  printf("%d channels, us per fftSize samples: new / reference\n", kNChans);
+
+  for (int fftSize = 256; fftSize <= kMaxFFTSize; fftSize *= 2)
+  {
+    printf("%5d:", fftSize);
+
+    for (auto outputType : {TSender::EOutputType::Complex, TSender::EOutputType::MagPhase})
+    {
+      for (int overlap : {1, 4})
+      {
+        auto pSender = std::make_unique<TSender>(fftSize, overlap, TSender::EWindowType::Hann, outputType);
+        auto pReference = std::make_unique<ReferenceSpectrum>(fftSize, overlap, outputType);
+        const double usNew = Time([&](TData& d) { pSender->PrepareDataForUI(d); }, *pAudio, fftSize / overlap, fftSize);
+        const double usOld = Time([&](TData& d) { pReference->PrepareDataForUI(d); }, *pAudio, fftSize, fftSize);
+        printf("  %s overlap %d %7.1f / %7.1f", outputType == TSender::EOutputType::Complex ? "complex" : "magphase", overlap, usNew, usOld);
+
+        if (usNew < 0. || usOld < 0.)
+          pass = false;
+      }
+
+      const float error = Compare(fftSize, outputType, *pAudio);
+      printf(" (error %.1e)", error);
+
+      if (error > kMaxMagError)
+        pass = false;
+    }
+
+    printf("\n");
+  }
+
+  printf("%s\n", pass ? "outputs match the reference" : "FAILED: outputs differ from the reference");
+  return pass ? 0 : 1;
+}
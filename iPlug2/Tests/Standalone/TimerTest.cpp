@@ -0,0 +1,120 @@
+/*
+ ==============================================================================
+
+ This file is part of the iPlug 2 library. Copyright (C) the iPlug 2 developers.
+
+ See LICENSE.txt for  more info.
+
+ ==============================================================================
+*/
+
+/*
+ Checks that Timer fires on linux: on the event loop thread by default, only from RunPending() while a run loop is attached,
+ and on the thread again once it is detached. Also checks that a timer can stop itself from its timer function.
+
+ From the iPlug2 folder:
+ g++ -std=c++17 -O2 -IIPlug -IWDL Tests/Standalone/TimerTest.cpp IPlug/IPlugTimer.cpp -lpthread -o TimerTest
+
+ Returns 0 if all checks pass
+*/
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <thread>
+
+#include <poll.h>
+
+#include "IPlugTimer.h"
+
+using namespace iplug;
+
+static constexpr uint32_t kIntervalMs = 10;
+static int sErrors = 0;
+
+static void Check(bool ok, const char* what)
+{
+  printf("%s %s\n", ok ? "ok  " : "FAIL", what);
+
+  if (!ok)
+    sErrors++;
+}
+
+/** Wait for a count to reach a target, or time out */
+static bool WaitFor(const std::atomic<int>& count, int target, std::chrono::milliseconds timeout = std::chrono::milliseconds(2000))
+{
+  const auto end = std::chrono::steady_clock::now() + timeout;
+
+  while (count.load() < target)
+  {
+    if (std::chrono::steady_clock::now() > end)
+      return false;
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+
+  return true;
+}
+
+int main(int argc, char** argv)
+{
+  const std::thread::id mainThread = std::this_thread::get_id();
+  std::atomic<int> count {0};
+  std::atomic<bool> calledOnMainThread {false};
+
+  std::unique_ptr<Timer> pTimer(Timer::Create([&](Timer& t) {
+    if (std::this_thread::get_id() == mainThread)
+      calledOnMainThread = true;
+
+    count++;
+  }, kIntervalMs));
+
+  Check(WaitFor(count, 5), "fires on the event loop thread");
+  Check(!calledOnMainThread, "is not called on the main thread without a run loop");
+
+  Timer_impl::Stats stats;
+  Check(Timer_impl::GetStats(kIntervalMs, stats) && stats.nTimers == 1 && stats.nWakeups >= 5, "reports wakeup statistics");
+
+  // Attach a run loop, which the main thread runs by polling the event fd
+  Timer_impl::AttachRunLoop();
+  const int attachedCount = count.load();
+  std::this_thread::sleep_for(std::chrono::milliseconds(kIntervalMs * 5));
+  Check(count.load() == attachedCount, "does not fire on the thread while a run loop is attached");
+
+  pollfd fd = {};
+  fd.fd = Timer_impl::GetEventFD();
+  fd.events = POLLIN;
+
+  for (int i = 0; i < 5; i++)
+  {
+    if (poll(&fd, 1, 1000) == 1)
+      Timer_impl::RunPending();
+  }
+
+  Check(count.load() >= attachedCount + 5 && calledOnMainThread, "fires from RunPending() on the main thread");
+
+  Timer_impl::DetachRunLoop();
+  calledOnMainThread = false;
+  const int detachedCount = count.load();
+  Check(WaitFor(count, detachedCount + 5) && !calledOnMainThread, "fires on the thread again once detached");
+
+  // A timer that stops itself is not called again
+  std::atomic<int> selfStopCount {0};
+  std::unique_ptr<Timer> pSelfStop(Timer::Create([&](Timer& t) {
+    if (++selfStopCount == 3)
+      t.Stop();
+  }, kIntervalMs));
+
+  WaitFor(selfStopCount, 3);
+  std::this_thread::sleep_for(std::chrono::milliseconds(kIntervalMs * 5));
+  Check(selfStopCount.load() == 3, "stops from its own timer function");
+
+  pTimer->Stop();
+  const int stoppedCount = count.load();
+  std::this_thread::sleep_for(std::chrono::milliseconds(kIntervalMs * 5));
+  Check(count.load() == stoppedCount, "does not fire once stopped");
+
+  printf("%d errors\n", sErrors);
+  return sErrors ? 1 : 0;
+}
@@ -29,6 +29,7 @@
 #include <stdlib.h>
 #include <memory.h>
 #include "convoengine.h"
+#include "fnv64.h"
 
 #include "denormal.h"
 
@@ -121,18 +122,64 @@ static bool CompareQueueToBuf(WDL_FastQueue *q, const void *data, int len)
 }
 
 
+WDL_PtrList<WDL_ConvolutionEngine::SharedImpulse> WDL_ConvolutionEngine::s_impcache;
+WDL_Mutex WDL_ConvolutionEngine::s_impcache_mutex;
+
+WDL_ConvolutionEngine::SharedImpulse *WDL_ConvolutionEngine::FindSharedImpulse(WDL_UINT64 hash, int nch, int fft_size, int impulse_len)
+{
+#ifndef WDL_CONVO_NO_IMPULSE_CACHE
+  WDL_MutexLock lock(&s_impcache_mutex);
+  for (int x = 0; x < s_impcache.GetSize(); x ++)
+  {
+    SharedImpulse *imp = s_impcache.Get(x);
+    if (imp->hash == hash && imp->nch == nch && imp->fft_size == fft_size && imp->impulse_len == impulse_len)
+    {
+      imp->refcnt++;
+      return imp;
+    }
+  }
+#endif
+  return NULL;
+}
+
+void WDL_ConvolutionEngine::AddSharedImpulse(SharedImpulse *imp)
+{
+#ifndef WDL_CONVO_NO_IMPULSE_CACHE
+  WDL_MutexLock lock(&s_impcache_mutex);
+  s_impcache.Add(imp);
+#endif
+}
+
+void WDL_ConvolutionEngine::ReleaseSharedImpulse(SharedImpulse *imp)
+{
+  if (!imp) return;
+  {
+    WDL_MutexLock lock(&s_impcache_mutex);
+    if (--imp->refcnt > 0) return;
+    s_impcache.DeletePtr(imp);
+  }
+  delete imp;
+}
+
+int WDL_ConvolutionEngine::GetNumSharedImpulses()
+{
+  WDL_MutexLock lock(&s_impcache_mutex);
+  return s_impcache.GetSize();
+}
+
 WDL_ConvolutionEngine::WDL_ConvolutionEngine()
 {
   WDL_fft_init();
   m_fft_size=0;
-  m_impdata.Add(new ImpChannelInfo);
+  m_impdata=new SharedImpulse;
+  m_impdata->chans.Add(new ImpChannelInfo);
   m_impulse_len=0;
   m_proc_nch=0;
 }
 
 WDL_ConvolutionEngine::~WDL_ConvolutionEngine()
 {
-  m_impdata.Empty(true);
+  ReleaseSharedImpulse(m_impdata);
   m_proc.Empty(true);
 }
 
@@ -163,26 +210,50 @@ int WDL_ConvolutionEngine::SetImpulse(WDL_ImpulseBuffer *impulse, int fft_size,
   m_impulse_len=impulse_len;
   m_proc_nch=-1;
 
-  while (m_impdata.GetSize() > nch)
-    m_impdata.Delete(m_impdata.GetSize()-1,true);
-  while (m_impdata.GetSize() < nch)
-    m_impdata.Add(new ImpChannelInfo);
+  if (forceBrute) fft_size=0;
+  else if (fft_size<=0)
+  {
+    int msz=fft_size<=-16? -fft_size*2 : 32768;
 
-  if (forceBrute)
+    fft_size=32;
+    while (fft_size < impulse_len*2 && fft_size < msz) fft_size*=2;
+  }
+
+  m_fft_size=fft_size;
+
+  // share the transformed impulse with any engine that has the same samples, channels and FFT size
+  WDL_UINT64 hash=WDL_FNV64_IV;
+  for (x = 0; x < nch; x ++)
   {
-    m_fft_size=0;
+    int lenout=impulse->impulses[x].GetSize()-impulse_sample_offset;
+    if (max_imp_size && lenout>max_imp_size) lenout=max_imp_size;
+    if (lenout<0) lenout=0;
+    hash=WDL_FNV64(hash,(const unsigned char *)&lenout,sizeof(lenout));
+    if (lenout>0) hash=WDL_FNV64(hash,(const unsigned char *)(impulse->impulses[x].Get()+impulse_sample_offset),lenout*(int)sizeof(WDL_FFT_REAL));
+  }
 
-    // save impulse
-    for (x = 0; x < m_impdata.GetSize(); x ++)
-    {
-      WDL_FFT_REAL *imp=impulse->impulses[x].Get()+impulse_sample_offset;
-      int lenout=impulse->impulses[x].GetSize()-impulse_sample_offset;  
-      if (max_imp_size && lenout>max_imp_size) lenout=max_imp_size;
+  SharedImpulse *shared=FindSharedImpulse(hash,nch,fft_size,impulse_len);
+  ReleaseSharedImpulse(m_impdata);
+  m_impdata=shared;
 
-      WDL_CONVO_IMPULSEBUFf *impout=m_impdata.Get(x)->imp.Resize(lenout)+lenout;
-      while (lenout-->0) *--impout = (WDL_CONVO_IMPULSEBUFf) *imp++;
-    }
+  if (!m_impdata)
+  {
+    m_impdata=new SharedImpulse;
+    m_impdata->hash=hash;
+    m_impdata->nch=nch;
+    m_impdata->fft_size=fft_size;
+    m_impdata->impulse_len=impulse_len;
+    while (m_impdata->chans.GetSize() < nch)
+      m_impdata->chans.Add(new ImpChannelInfo);
+
+    if (forceBrute) BuildBruteImpulse(impulse,impulse_sample_offset,max_imp_size);
+    else BuildFFTImpulse(impulse,impulse_sample_offset,max_imp_size);
+
+    AddSharedImpulse(m_impdata);
+  }
 
+  if (forceBrute)
+  {
     for (x = 0; x < m_proc.GetSize(); x ++)
     {
       ProcChannelInfo *inf = m_proc.Get(x);
@@ -194,16 +265,27 @@ int WDL_ConvolutionEngine::SetImpulse(WDL_ImpulseBuffer *impulse, int fft_size,
     return 0;
   }
 
- 
-  if (fft_size<=0)
+  return m_fft_size/2;
+}
+
+void WDL_ConvolutionEngine::BuildBruteImpulse(WDL_ImpulseBuffer *impulse, int impulse_sample_offset, int max_imp_size)
+{
+  // save impulse, reversed
+  for (int x = 0; x < m_impdata->chans.GetSize(); x ++)
   {
-    int msz=fft_size<=-16? -fft_size*2 : 32768;
+    WDL_FFT_REAL *imp=impulse->impulses[x].Get()+impulse_sample_offset;
+    int lenout=impulse->impulses[x].GetSize()-impulse_sample_offset;  
+    if (max_imp_size && lenout>max_imp_size) lenout=max_imp_size;
 
-    fft_size=32;
-    while (fft_size < impulse_len*2 && fft_size < msz) fft_size*=2;
+    WDL_CONVO_IMPULSEBUFf *impout=m_impdata->chans.Get(x)->imp.Resize(lenout)+lenout;
+    while (lenout-->0) *--impout = (WDL_CONVO_IMPULSEBUFf) *imp++;
   }
+}
 
-  m_fft_size=fft_size;
+void WDL_ConvolutionEngine::BuildFFTImpulse(WDL_ImpulseBuffer *impulse, int impulse_sample_offset, int max_imp_size)
+{
+  int x;
+  const int fft_size=m_fft_size, impulse_len=m_impulse_len;
 
   int impchunksize=fft_size/2;
   int nblocks=(impulse_len+impchunksize-1)/impchunksize;
@@ -212,14 +294,14 @@ int WDL_ConvolutionEngine::SetImpulse(WDL_ImpulseBuffer *impulse, int fft_size,
   const bool smallerSizeMode=sizeof(WDL_CONVO_IMPULSEBUFf)!=sizeof(WDL_FFT_REAL);
  
   WDL_FFT_REAL scale=(WDL_FFT_REAL) (1.0/fft_size);
-  for (x = 0; x < m_impdata.GetSize(); x ++)
+  for (x = 0; x < m_impdata->chans.GetSize(); x ++)
   {
     WDL_FFT_REAL *imp=impulse->impulses[x].Get()+impulse_sample_offset;
 
-    WDL_FFT_REAL *imp2=x < m_impdata.GetSize()-1 ? impulse->impulses[x+1].Get()+impulse_sample_offset : NULL;
+    WDL_FFT_REAL *imp2=x < m_impdata->chans.GetSize()-1 ? impulse->impulses[x+1].Get()+impulse_sample_offset : NULL;
 
-    WDL_CONVO_IMPULSEBUFf *impout=m_impdata.Get(x)->imp.Resize((nblocks+!!smallerSizeMode)*fft_size*2);
-    char *zbuf=m_impdata.Get(x)->zflag.Resize(nblocks);
+    WDL_CONVO_IMPULSEBUFf *impout=m_impdata->chans.Get(x)->imp.Resize((nblocks+!!smallerSizeMode)*fft_size*2);
+    char *zbuf=m_impdata->chans.Get(x)->zflag.Resize(nblocks);
     int lenout=impulse->impulses[x].GetSize()-impulse_sample_offset;  
     if (max_imp_size && lenout>max_imp_size) lenout=max_imp_size;
       
@@ -274,7 +356,6 @@ int WDL_ConvolutionEngine::SetImpulse(WDL_ImpulseBuffer *impulse, int fft_size,
       impout+=fft_size*2;
     }
   }
-  return m_fft_size/2;
 }
 
 
@@ -304,9 +385,9 @@ void WDL_ConvolutionEngine::Add(WDL_FFT_REAL **bufs, int len, int nch)
 
     for (int ch = 0; ch < nch; ch ++)
     {
-      int wch = ch % m_impdata.GetSize();
-      WDL_CONVO_IMPULSEBUFf *imp=m_impdata.Get(wch)->imp.Get();
-      int imp_len = m_impdata.Get(wch)->imp.GetSize();
+      int wch = ch % m_impdata->chans.GetSize();
+      WDL_CONVO_IMPULSEBUFf *imp=m_impdata->chans.Get(wch)->imp.Get();
+      int imp_len = m_impdata->chans.Get(wch)->imp.GetSize();
       ProcChannelInfo *pinf = m_proc.Get(ch);
 
       if (imp_len>0) 
@@ -482,12 +563,12 @@ int WDL_ConvolutionEngine::Avail(int want)
     ProcChannelInfo *pinf2 = (!(ch&1) && ch+1 < m_proc_nch) ? m_proc.Get(ch+1) : NULL;
 
     if (!pinf->samplehist.GetSize()||!pinf->overlaphist.GetSize()) continue;
-    int srcc=ch % m_impdata.GetSize();
+    int srcc=ch % m_impdata->chans.GetSize();
 
     bool allow_mono_input_mode=true;
     bool mono_impulse_mode=false;
 
-    if (m_impdata.GetSize()==1 && pinf2 &&
+    if (m_impdata->chans.GetSize()==1 && pinf2 &&
         pinf2->samplehist.GetSize()&&pinf2->overlaphist.GetSize() &&
         pinf->samplesin.Available()==pinf2->samplesin.Available() &&
         pinf->samplesout.Available()==pinf2->samplesout.Available()
@@ -535,7 +616,7 @@ int WDL_ConvolutionEngine::Avail(int want)
       {
         if (allow_mono_input_mode && 
           pinf2 &&
-          srcc<m_impdata.GetSize()-1 &&
+          srcc<m_impdata->chans.GetSize()-1 &&
           !CompareQueueToBuf(&pinf2->samplesin,optr+sz,sz*sizeof(WDL_FFT_REAL))
           )
         {
@@ -597,9 +678,9 @@ int WDL_ConvolutionEngine::Avail(int want)
       }
 
       int applycnt=0;
-      char *useImpSilentList=m_impdata.Get(srcc)->zflag.GetSize() == nblocks ? m_impdata.Get(srcc)->zflag.Get() : NULL;
+      char *useImpSilentList=m_impdata->chans.Get(srcc)->zflag.GetSize() == nblocks ? m_impdata->chans.Get(srcc)->zflag.Get() : NULL;
 
-      WDL_CONVO_IMPULSEBUFf *impulseptr=m_impdata.Get(srcc)->imp.Get();
+      WDL_CONVO_IMPULSEBUFf *impulseptr=m_impdata->chans.Get(srcc)->imp.Get();
       for (int i = 0; i < nblocks; i ++, impulseptr+=m_fft_size*2)
       {
         int srchistpos = histpos-i;
@@ -944,10 +1025,554 @@ int WDL_ConvolutionEngine_Div::Avail(int wantSamples)
 }
 
 
+#ifdef WDL_CONVO_THREAD
+
+/****************************************************************
+**  low latency version, with the long partitions on worker threads
+*/
+
+WDL_ConvolutionEngine_Thread::WDL_ConvolutionEngine_Thread(int nthreads)
+{
+  for (int x = 0; x < 2; x ++) m_sout.Add(new WDL_Queue);
+  m_nch=0;
+  m_maxadd=8192;
+  m_need_feedsilence=true;
+  m_nthreads=nthreads>0 ? nthreads : 1;
+  m_signalled=false;
+  m_wake_pending=false;
+  m_quit=false;
+  m_latecnt=0;
+  m_dropcnt=0;
+}
+
+WDL_ConvolutionEngine_Thread::~WDL_ConvolutionEngine_Thread()
+{
+  StopThreads();
+  m_tail.Empty(true);
+  m_sout.Empty(true);
+}
+
+int WDL_ConvolutionEngine_Thread::SetImpulse(WDL_ImpulseBuffer *impulse, int maxfft_size, int known_blocksize, int max_imp_size, int impulse_offset, int latency_allowed)
+{
+  StopThreads();
+  m_tail.Empty(true);
+  m_need_feedsilence=true;
+  m_maxadd=known_blocksize>8192 ? known_blocksize : 8192;
+
+  int samplesleft=impulse->impulses[0].GetSize()-impulse_offset;
+  if (max_imp_size>0 && samplesleft>max_imp_size) samplesleft=max_imp_size;
+
+  if (maxfft_size<0) maxfft_size=-maxfft_size;
+  int maxblock=16384; // the largest FFT is 32768, as for WDL_ConvolutionEngine_Div
+  while (maxfft_size>0 && maxblock>maxfft_size && maxblock>WDL_CONVO_THREAD_MIN_BLOCK) maxblock/=2;
+
+  // worker partitions are at least as large as the host block, so that each has at least one host block to compute in
+  int blocksize=WDL_CONVO_THREAD_MIN_BLOCK;
+  while (blocksize<maxblock && (blocksize<known_blocksize || blocksize<latency_allowed)) blocksize*=2;
+
+  const int headlen=blocksize*2;
+  m_head.SetImpulse(impulse,maxfft_size,known_blocksize,samplesleft>headlen ? headlen : max_imp_size,impulse_offset,latency_allowed);
+
+  int offs=headlen;
+  samplesleft-=headlen;
+  while (samplesleft>0)
+  {
+    // each partition starts at twice its block size, and ends where the next one can double its block size.
+    // Past the largest block size the partitions are kept short, so that no one worker job holds up the others for long
+    int len=blocksize<maxblock ? blocksize*4-offs : blocksize*WDL_CONVO_THREAD_MAX_BLOCKS;
+    if (len>samplesleft) len=samplesleft;
+    if (samplesleft-len < blocksize) len=samplesleft; // don't leave a partition shorter than a block
+
+    TailPartition *part=new TailPartition;
+    part->offs=offs;
+    part->blocksize=blocksize;
+    part->eng.SetImpulse(impulse,blocksize*2,impulse_offset+offs,len);
+    m_tail.Add(part);
+
+    offs+=len;
+    samplesleft-=len;
+    if (blocksize<maxblock) blocksize*=2;
+  }
+
+  // stagger the block boundaries of the partitions, so that their FFTs fall in different host blocks
+  for (int x = 0; x < m_tail.GetSize(); x ++)
+  {
+    TailPartition *part=m_tail.Get(x);
+    part->stagger=(int) (((WDL_INT64)part->blocksize*x)/m_tail.GetSize());
+    if (m_nch) SetNumChannels(part,m_nch);
+  }
+
+  StartThreads();
+
+  return GetLatency();
+}
+
+void WDL_ConvolutionEngine_Thread::SetNumChannels(TailPartition *part, int nch)
+{
+  // the input ring holds a block plus the largest expected Add(), with room to spare for a late worker.
+  // The output ring also holds the output that is computed ahead of the partition's offset
+  int in_size=1, out_size=1;
+  while (in_size < part->blocksize*2+m_maxadd*2) in_size*=2;
+  while (out_size < part->offs+in_size+part->blocksize*2) out_size*=2;
+
+  part->nch=0;
+  if (part->in.ResizeOK(in_size*nch,false) && part->out.ResizeOK(out_size*nch,false) && part->tmpptrs.ResizeOK(nch,false))
+  {
+    part->nch=nch;
+    part->in_size=in_size;
+    part->out_size=out_size;
+  }
+  part->in_wr=part->in_rd=0;
+  part->out_wr=part->out_rd=0;
+}
+
+bool WDL_ConvolutionEngine_Thread::TryReset(TailPartition *part)
+{
+  part->reset_pending=!part->TryClaim();
+  if (part->reset_pending) return false;
+
+  if (part->nch != m_nch) SetNumChannels(part,m_nch);
+  part->eng.Reset();
+  part->in_wr=part->in_rd=0;
+  part->out_wr=part->out_rd=0;
+  part->Release();
+  return true;
+}
+
+void WDL_ConvolutionEngine_Thread::Reset()
+{
+  m_head.Reset();
+
+  for (int x = 0; x < m_tail.GetSize(); x ++)
+  {
+    TailPartition *part=m_tail.Get(x);
+    part->outdelay=0;
+    part->outdrop=0;
+    TryReset(part);
+  }
+
+  for (int x = 0; x < m_sout.GetSize(); x ++)
+  {
+    m_sout.Get(x)->Clear();
+  }
+
+  m_need_feedsilence=true;
+}
+
+void WDL_ConvolutionEngine_Thread::Add(WDL_FFT_REAL **bufs, int len, int nch)
+{
+  if (nch != m_nch)
+  {
+    m_nch=nch;
+    Reset();
+  }
+
+  while (m_sout.GetSize() < nch)
+    m_sout.Add(new WDL_Queue);
+  while (m_sout.GetSize() > nch)
+    m_sout.Delete(m_sout.GetSize()-1,true);
+
+  const bool ns=m_need_feedsilence;
+  m_need_feedsilence=false;
+
+  m_head.Add(bufs,len,nch);
+
+  bool wake=m_wake_pending;
+  for (int x = 0; x < m_tail.GetSize(); x ++)
+  {
+    TailPartition *part=m_tail.Get(x);
+
+    // the staggering silence delays the output, so less delay is needed to put the output at the partition's offset.
+    // The delay is counted rather than queued, so that the output rings stay short
+    if (ns)
+    {
+      part->outdelay=part->offs-part->stagger;
+      part->stagger_pending=true;
+    }
+
+    // a partition that a worker held when it was reset drops its input until it can be reset, as AddInput() does when a worker holds it up
+    if (part->reset_pending && !TryReset(part))
+    {
+      part->outdelay+=len;
+      m_dropcnt++;
+      continue;
+    }
+    if (!part->nch) continue;
+
+    if (part->stagger_pending)
+    {
+      part->stagger_pending=false;
+      AddInput(part,NULL,part->stagger);
+    }
+    AddInput(part,bufs,len);
+
+    if (part->InAvail() >= part->blocksize) wake=true;
+  }
+
+  if (wake) WakeWorkers();
+}
+
+void WDL_ConvolutionEngine_Thread::WakeWorkers()
+{
+  m_signalled=true;
+  // a worker holding m_signal_mutex may have found m_signalled false and be about to wait, and would miss the notification.
+  // Don't block on the mutex, notify again on the next call instead
+  m_wake_pending=!m_signal_mutex.try_lock();
+  if (!m_wake_pending) m_signal_mutex.unlock();
+  m_signal.notify_all();
+}
+
+void WDL_ConvolutionEngine_Thread::AddInput(TailPartition *part, WDL_FFT_REAL **bufs, int len)
+{
+  const int mask=part->in_size-1;
+  int done=0;
+  while (done<len)
+  {
+    int space=part->in_size-part->InAvail();
+    if (space<len-done && part->TryClaim())
+    {
+      // the workers are not keeping up, convolve the pending input here
+      m_latecnt++;
+      Process(part);
+      part->Release();
+      space=part->in_size-part->InAvail();
+    }
+
+    if (!space)
+    {
+      // a worker holds the partition: drop the rest of the input. Delaying the output by the same amount keeps
+      // the partition aligned once the output computed before the dropout has been played
+      part->outdelay+=len-done;
+      m_dropcnt++;
+      return;
+    }
+
+    const int n=wdl_min(space,len-done);
+    unsigned int wr=part->in_wr.load(std::memory_order_relaxed);
+    for (int i = 0; i < n; )
+    {
+      const int pos=(int) (wr&mask), chunk=wdl_min(n-i,part->in_size-pos);
+      for (int ch = 0; ch < part->nch; ch ++)
+      {
+        WDL_FFT_REAL *o=part->in.Get()+ch*part->in_size+pos;
+        if (bufs && bufs[ch]) memcpy(o,bufs[ch]+done+i,chunk*sizeof(WDL_FFT_REAL));
+        else memset(o,0,chunk*sizeof(WDL_FFT_REAL));
+      }
+      wr+=chunk;
+      i+=chunk;
+    }
+    part->in_wr.store(wr,std::memory_order_release);
+    done+=n;
+  }
+}
+
+void WDL_ConvolutionEngine_Thread::Process(TailPartition *part)
+{
+  const int nch=part->nch;
+  WDL_FFT_REAL **p=part->tmpptrs.Get();
+  if (!nch) return;
+
+  int n=part->InAvail();
+  unsigned int rd=part->in_rd.load(std::memory_order_relaxed);
+  while (n>0)
+  {
+    const int pos=(int) (rd&(part->in_size-1)), chunk=wdl_min(n,part->in_size-pos);
+    for (int ch = 0; ch < nch; ch ++) p[ch]=part->in.Get()+ch*part->in_size+pos;
+    part->eng.Add(p,chunk,nch);
+    rd+=chunk;
+    n-=chunk;
+  }
+  part->in_rd.store(rd,std::memory_order_release);
+
+  // output that doesn't fit in the ring stays in eng until the next call
+  int a=part->eng.Avail(1<<24);
+  const int space=part->out_size-part->OutAvail();
+  if (a>space) a=space;
+  if (a<1) return;
+
+  WDL_FFT_REAL **ep=part->eng.Get();
+  if (WDL_NORMALLY(ep))
+  {
+    unsigned int wr=part->out_wr.load(std::memory_order_relaxed);
+    for (int i = 0; i < a; )
+    {
+      const int pos=(int) (wr&(part->out_size-1)), chunk=wdl_min(a-i,part->out_size-pos);
+      for (int ch = 0; ch < nch; ch ++) memcpy(part->out.Get()+ch*part->out_size+pos,ep[ch]+i,chunk*sizeof(WDL_FFT_REAL));
+      wr+=chunk;
+      i+=chunk;
+    }
+    part->out_wr.store(wr,std::memory_order_release);
+  }
+  part->eng.Advance(a);
+}
+
+void WDL_ConvolutionEngine_Thread::DropOutput(TailPartition *part)
+{
+  if (part->outdrop<1) return;
+  const int n=wdl_min(part->outdrop,part->OutAvail());
+  part->out_rd.store(part->out_rd.load(std::memory_order_relaxed)+n,std::memory_order_release);
+  part->outdrop-=n;
+}
+
+int WDL_ConvolutionEngine_Thread::Avail(int wantSamples)
+{
+  const int wso=wantSamples;
+  const int a=m_head.Avail(wantSamples);
+
+  if (m_wake_pending) WakeWorkers();
+
+  if (a>0)
+  {
+    for (int x = 0; x < m_tail.GetSize(); x ++)
+    {
+      TailPartition *part=m_tail.Get(x);
+      if (part->reset_pending) continue;
+      DropOutput(part);
+      const int need=part->outdelay < a ? a-part->outdelay : 0;
+      if (need>0 && (part->outdrop>0 || part->OutAvail() < need) && part->TryClaim())
+      {
+        // not ready in time, and no worker is computing it: compute it here
+        m_latecnt++;
+        Process(part);
+        part->Release();
+        DropOutput(part);
+      }
+    }
+
+    const int add_sz=a*sizeof(WDL_FFT_REAL);
+    WDL_FFT_REAL **hp=m_head.Get();
+    for (int ch = 0; ch < m_sout.GetSize(); ch ++)
+    {
+      WDL_FFT_REAL *o=(WDL_FFT_REAL *)m_sout.Get(ch)->Add(NULL,add_sz);
+      if (WDL_NORMALLY(o && hp)) memcpy(o,hp[ch],add_sz);
+    }
+    m_head.Advance(a);
+
+    for (int x = 0; x < m_tail.GetSize(); x ++)
+    {
+      TailPartition *part=m_tail.Get(x);
+      const int skip=part->outdelay < a ? part->outdelay : a;
+      part->outdelay-=skip;
+      if (skip == a || !part->nch || part->reset_pending) continue;
+
+      // a worker that is still computing this block will finish it later: output silence now, and discard its output when it arrives
+      const int n=a-skip;
+      DropOutput(part);
+      const int got=part->outdrop>0 ? 0 : wdl_min(n,part->OutAvail());
+      if (got<n)
+      {
+        part->outdrop+=n-got;
+        m_dropcnt++;
+      }
+      if (!got) continue;
+
+      const unsigned int rd=part->out_rd.load(std::memory_order_relaxed);
+      for (int ch = 0; ch < m_sout.GetSize() && ch < part->nch; ch ++)
+      {
+        WDL_Queue *q=m_sout.Get(ch);
+        if (WDL_NOT_NORMALLY(q->Available() < add_sz)) continue;
+
+        WDL_FFT_REAL *o=(WDL_FFT_REAL *)((char *)q->Get() + q->Available() - add_sz) + skip;
+        const WDL_FFT_REAL *in=part->out.Get()+ch*part->out_size;
+        unsigned int pos=rd;
+        int j=got;
+        while (j-->0) *o++ += in[pos++&(part->out_size-1)];
+      }
+      part->out_rd.store(rd+got,std::memory_order_release);
+    }
+  }
+
+  WDL_Queue *q0=m_sout.Get(0);
+  int av=WDL_NORMALLY(q0 != NULL) ? (int) (q0->Available()/sizeof(WDL_FFT_REAL)) : 0;
+  return av>wso ? wso : av;
+}
+
+WDL_FFT_REAL **WDL_ConvolutionEngine_Thread::Get()
+{
+  WDL_FFT_REAL **ret = m_get_tmpptrs.ResizeOK(m_sout.GetSize(),false);
+  if (WDL_NORMALLY(ret))
+    for (int x = 0; x < m_sout.GetSize(); x ++) ret[x]=(WDL_FFT_REAL *)m_sout.Get(x)->Get();
+  return ret;
+}
+
+void WDL_ConvolutionEngine_Thread::Advance(int len)
+{
+  for (int x = 0; x < m_sout.GetSize(); x ++)
+  {
+    WDL_Queue *q = m_sout.Get(x);
+    q->Advance(len*sizeof(WDL_FFT_REAL));
+    q->Compact();
+  }
+}
+
+void WDL_ConvolutionEngine_Thread::ThreadProc()
+{
+  for (;;)
+  {
+    {
+      std::unique_lock<std::mutex> lock(m_signal_mutex);
+      while (!m_signalled && !m_quit) m_signal.wait(lock);
+      if (m_quit) return;
+      m_signalled=false;
+    }
+
+    // earliest deadline first: of the unclaimed partitions with a complete block of input, run the one with the least output ready
+    for (;;)
+    {
+      int best=-1, bestout=0;
+      for (int x = 0; x < m_tail.GetSize(); x ++)
+      {
+        const TailPartition *part=m_tail.Get(x);
+        if (part->claimed.load(std::memory_order_relaxed) || part->InAvail() < part->blocksize) continue;
+        const int outav=part->OutAvail();
+        if (best<0 || outav<bestout) { best=x; bestout=outav; }
+      }
+      if (best<0) break;
+
+      TailPartition *part=m_tail.Get(best);
+      if (part->TryClaim())
+      {
+        Process(part);
+        part->Release();
+      }
+    }
+  }
+}
+
+void WDL_ConvolutionEngine_Thread::StartThreads()
+{
+  if (!m_tail.GetSize()) return;
+
+  m_quit=false;
+  for (int x = 0; x < m_nthreads; x ++)
+    m_threads.Add(new std::thread(&WDL_ConvolutionEngine_Thread::ThreadProc,this));
+}
+
+void WDL_ConvolutionEngine_Thread::StopThreads()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_signal_mutex);
+    m_quit=true;
+  }
+  m_signal.notify_all();
+
+  for (int x = 0; x < m_threads.GetSize(); x ++) m_threads.Get(x)->join();
+  m_threads.Empty(true);
+  m_signalled=false;
+  m_wake_pending=false;
+}
+
+#endif // WDL_CONVO_THREAD
+
+
 #ifdef WDL_TEST_CONVO
 
 #include <stdio.h>
 
+#if WDL_TEST_CONVO==3
+
+// benchmark of the calling thread's time per block, WDL_ConvolutionEngine_Div against WDL_ConvolutionEngine_Thread (requires WDL_CONVO_THREAD).
+// Blocks are paced to real time, so that the workers have the time they would have in a host
+#ifndef WDL_CONVO_THREAD
+#error WDL_TEST_CONVO==3 requires WDL_CONVO_THREAD
+#endif
+
+#define BENCH_MAXCH 8
+
+static WDL_UINT64 s_bench_seed;
+static WDL_FFT_REAL bench_rand()
+{
+  s_bench_seed=s_bench_seed*6364136223846793005ull+1442695040888963407ull;
+  return (WDL_FFT_REAL) ((int)(s_bench_seed>>40)-(1<<23))/(WDL_FFT_REAL)(1<<23);
+}
+
+template<class ENGINE> static void bench_run(const char *name, ENGINE &engine, int nch, int bs, int srate, int nblocks, WDL_TypedBuf<WDL_FFT_REAL> *out)
+{
+  WDL_TypedBuf<WDL_FFT_REAL> inbuf;
+  WDL_FFT_REAL *in[BENCH_MAXCH];
+  for (int ch = 0; ch < nch; ch ++) in[ch]=inbuf.Resize(nch*bs)+ch*bs;
+
+  s_bench_seed=1;
+  double worst=0.0, total=0.0;
+  int nmeasured=0;
+  std::chrono::steady_clock::time_point next=std::chrono::steady_clock::now();
+  for (int b = 0; b < nblocks; b ++)
+  {
+    for (int ch = 0; ch < nch; ch ++) for (int i = 0; i < bs; i ++) in[ch][i]=bench_rand()*0.5;
+
+    const std::chrono::steady_clock::time_point t0=std::chrono::steady_clock::now();
+    engine.Add(in,bs,nch);
+    const int a=engine.Avail(bs);
+    WDL_FFT_REAL **o=engine.Get();
+    for (int ch = 0; ch < nch; ch ++)
+    {
+      const int sz=out[ch].GetSize();
+      memcpy(out[ch].Resize(sz+a)+sz,o[ch],a*sizeof(WDL_FFT_REAL));
+    }
+    engine.Advance(a);
+    const double us=std::chrono::duration<double,std::micro>(std::chrono::steady_clock::now()-t0).count();
+
+    if (b >= nblocks/8) // skip the warmup
+    {
+      if (us>worst) worst=us;
+      total+=us;
+      nmeasured++;
+    }
+
+    next+=std::chrono::microseconds((WDL_INT64)bs*1000000/srate);
+    std::this_thread::sleep_until(next);
+  }
+
+  printf("%s: worst %.0f us, mean %.1f us per block\n",name,worst,total/wdl_max(nmeasured,1));
+}
+
+int main(int argc, char **argv)
+{
+  const int nch=argc>1 ? atoi(argv[1]) : 6;
+  const double implen_s=argc>2 ? atof(argv[2]) : 8.0;
+  const int bs=argc>3 ? atoi(argv[3]) : 64;
+  const int nblocks=argc>4 ? atoi(argv[4]) : 4000;
+  const int srate=48000;
+
+  if (nch < 1 || nch > BENCH_MAXCH || implen_s <= 0.0 || bs < 1 || nblocks < 8)
+  {
+    printf("usage: convoengine [nch [impulse_seconds [blocksize [nblocks]]]]\n");
+    return -1;
+  }
+
+  const int implen=(int) (implen_s*srate);
+  WDL_ImpulseBuffer imp;
+  imp.SetNumChannels(nch);
+  imp.SetLength(implen);
+  s_bench_seed=7;
+  for (int ch = 0; ch < nch; ch ++)
+    for (int i = 0; i < implen; i ++) imp.impulses[ch].Get()[i]=bench_rand()*(WDL_FFT_REAL)(exp(-3.0*i/implen)*0.01);
+
+  WDL_TypedBuf<WDL_FFT_REAL> out1[BENCH_MAXCH], out2[BENCH_MAXCH];
+  printf("%d channels, %.1f s impulse, %d sample blocks at %d Hz\n",nch,implen_s,bs,srate);
+  {
+    WDL_ConvolutionEngine_Div engine;
+    engine.SetImpulse(&imp,0,bs);
+    bench_run("WDL_ConvolutionEngine_Div   ",engine,nch,bs,srate,nblocks,out1);
+  }
+  {
+    WDL_ConvolutionEngine_Thread engine;
+    engine.SetImpulse(&imp,0,bs);
+    bench_run("WDL_ConvolutionEngine_Thread",engine,nch,bs,srate,nblocks,out2);
+    printf("%d tail partitions, %d late blocks, %d dropouts\n",engine.GetNumTailPartitions(),engine.GetLateCount(),engine.GetDropoutCount());
+  }
+
+  double maxdiff=0.0;
+  const int n=wdl_min(out1[0].GetSize(),out2[0].GetSize());
+  for (int ch = 0; ch < nch; ch ++)
+    for (int i = 0; i < n; i ++) maxdiff=wdl_max(maxdiff,fabs(out1[ch].Get()[i]-out2[ch].Get()[i]));
+  printf("max difference %g over %d samples\n",maxdiff,n);
+
+  return 0;
+}
+
+#else
+
 int main(int argc, char **argv)
 {
   if (argc!=5)
@@ -1013,6 +1638,8 @@ int main(int argc, char **argv)
   return 0;
 }
 
+#endif // WDL_TEST_CONVO==3
+
 #endif
 
 
@@ -33,6 +33,7 @@
 #include "queue.h"
 #include "fastqueue.h"
 #include "fft.h"
+#include "mutex.h"
 
 //#define WDL_CONVO_WANT_FULLPRECISION_IMPULSE_STORAGE // define this for slowerness with -138dB error difference in resulting output (+-1 LSB at 24 bit)
 
@@ -101,6 +102,8 @@ public:
   WDL_FFT_REAL **Get(); // returns length valid
   void Advance(int len);
 
+  static int GetNumSharedImpulses(); // number of distinct transformed impulses in use by all engines
+
 private:
 
   struct ImpChannelInfo {
@@ -120,8 +123,29 @@ private:
     int hist_pos;
   };
 
+  // the transformed impulse is read-only once built, so engines with the same impulse partitions share one copy,
+  // found by a hash of the impulse samples (unless WDL_CONVO_NO_IMPULSE_CACHE is defined)
+  struct SharedImpulse {
+    WDL_PtrList<ImpChannelInfo> chans;
+    int refcnt; // guarded by s_impcache_mutex
+    WDL_UINT64 hash;
+    int nch, fft_size, impulse_len;
+
+    SharedImpulse() : refcnt(1), hash(0), nch(0), fft_size(0), impulse_len(0) { }
+    ~SharedImpulse() { chans.Empty(true); }
+  };
+
+  void BuildBruteImpulse(WDL_ImpulseBuffer *impulse, int impulse_sample_offset, int max_imp_size);
+  void BuildFFTImpulse(WDL_ImpulseBuffer *impulse, int impulse_sample_offset, int max_imp_size);
+
+  static SharedImpulse *FindSharedImpulse(WDL_UINT64 hash, int nch, int fft_size, int impulse_len); // adds a reference
+  static void AddSharedImpulse(SharedImpulse *imp);
+  static void ReleaseSharedImpulse(SharedImpulse *imp);
+
+  static WDL_PtrList<SharedImpulse> s_impcache;
+  static WDL_Mutex s_impcache_mutex;
 
-  WDL_PtrList<ImpChannelInfo> m_impdata;
+  SharedImpulse *m_impdata;
 
   int m_impulse_len;
   int m_fft_size;
@@ -176,4 +200,110 @@ private:
 } WDL_FIXALIGN;
 
 
+#ifdef WDL_CONVO_THREAD
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#ifndef WDL_CONVO_THREAD_MIN_BLOCK
+#define WDL_CONVO_THREAD_MIN_BLOCK 1024 // smallest partition size convolved on a worker thread
+#endif
+
+#ifndef WDL_CONVO_THREAD_MAX_BLOCKS
+#define WDL_CONVO_THREAD_MAX_BLOCKS 4 // most blocks in a worker partition of the largest size
+#endif
+
+// low latency version that convolves the long partitions of the impulse on worker threads.
+// Only the head of the impulse, up to 2x the smallest worker partition, is convolved on the calling thread (by a WDL_ConvolutionEngine_Div).
+// Each worker partition starts at least 2x its block size into the impulse, so its output is due at least one block after its input arrives,
+// and the workers process the partition whose output is due soonest first.
+// The calling thread never waits for a worker: input and output pass through lock-free single producer single consumer rings, and a partition
+// is run by whichever thread claims it. If a block is not ready in time, the calling thread computes it, or if a worker is still computing it,
+// outputs silence for that partition in its place (a dropout). Likewise Reset() and Add() only reset a partition that no worker holds, and
+// retry the others on the following calls to Add(), dropping their input until then.
+class WDL_ConvolutionEngine_Thread
+{
+public:
+  WDL_ConvolutionEngine_Thread(int nthreads=1);
+  ~WDL_ConvolutionEngine_Thread();
+
+  // parameters as for WDL_ConvolutionEngine_Div::SetImpulse(). Stops the worker threads while the partitions are rebuilt, so call when not processing
+  int SetImpulse(WDL_ImpulseBuffer *impulse, int maxfft_size=0, int known_blocksize=0, int max_imp_size=0, int impulse_offset=0, int latency_allowed=0);
+
+  int GetLatency() { return m_head.GetLatency(); }
+  void Reset(); // partitions held by a worker are reset by a later Add()
+
+  void Add(WDL_FFT_REAL **bufs, int len, int nch); // resets, and reallocates the partitions that are not held by a worker, when nch changes
+
+  int Avail(int wantSamples);
+  WDL_FFT_REAL **Get(); // returns length valid
+  void Advance(int len);
+
+  int GetNumTailPartitions() const { return m_tail.GetSize(); }
+  int GetLateCount() const { return m_latecnt.load(std::memory_order_relaxed); } // number of tail blocks that were not ready in time, and were computed by the calling thread
+  int GetDropoutCount() const { return m_dropcnt.load(std::memory_order_relaxed); } // number of tail blocks that were not ready in time while a worker was computing them, and were replaced by silence
+
+private:
+  struct TailPartition
+  {
+    WDL_ConvolutionEngine eng; // only used by the thread that has claimed the partition
+    int offs, blocksize, stagger;
+    int outdelay; // silence still to be output before the output of eng, only used by the calling thread
+    int outdrop; // output of eng still to be discarded because silence was output in its place, only used by the calling thread
+    bool reset_pending; // a worker held the partition when it was to be reset, only used by the calling thread
+    bool stagger_pending; // the staggering silence is still to be added once the partition is reset, only used by the calling thread
+
+    std::atomic<bool> claimed; // held while running eng, or while the calling thread reallocates or resets the rings. The calling thread only ever tries to claim it
+
+    // the rings have in_size/out_size (powers of 2) samples per channel. The calling thread writes in and reads out,
+    // and the thread that has claimed the partition reads in and writes out. The positions only ever increase
+    WDL_TypedBuf<WDL_FFT_REAL> in, out;
+    WDL_TypedBuf<WDL_FFT_REAL *> tmpptrs;
+    int nch, in_size, out_size;
+    std::atomic<unsigned int> in_wr, in_rd, out_wr, out_rd;
+
+    TailPartition() : offs(0), blocksize(0), stagger(0), outdelay(0), outdrop(0), reset_pending(false), stagger_pending(false), claimed(false), nch(0), in_size(0), out_size(0), in_wr(0), in_rd(0), out_wr(0), out_rd(0) { }
+
+    bool TryClaim() { bool c=false; return claimed.compare_exchange_strong(c,true,std::memory_order_acquire); }
+    void Release() { claimed.store(false,std::memory_order_release); }
+
+    int InAvail() const { return (int) (in_wr.load(std::memory_order_acquire)-in_rd.load(std::memory_order_acquire)); }
+    int OutAvail() const { return (int) (out_wr.load(std::memory_order_acquire)-out_rd.load(std::memory_order_acquire)); }
+  };
+
+  void SetNumChannels(TailPartition *part, int nch); // caller has claimed part
+  bool TryReset(TailPartition *part); // resets part to m_nch channels if no worker holds it, otherwise sets reset_pending
+  void AddInput(TailPartition *part, WDL_FFT_REAL **bufs, int len); // bufs=NULL adds silence
+  void DropOutput(TailPartition *part);
+  void Process(TailPartition *part); // caller has claimed part
+  void WakeWorkers();
+  void ThreadProc();
+  void StartThreads();
+  void StopThreads();
+
+  WDL_ConvolutionEngine_Div m_head;
+  WDL_PtrList<TailPartition> m_tail;
+
+  WDL_PtrList<WDL_Queue> m_sout;
+  WDL_TypedBuf<WDL_FFT_REAL *> m_get_tmpptrs;
+  int m_nch;
+  int m_maxadd; // the rings hold at least this much input beyond a block
+  bool m_need_feedsilence;
+
+  int m_nthreads;
+  WDL_PtrList<std::thread> m_threads;
+  std::mutex m_signal_mutex; // only ever try-locked by the calling thread
+  std::condition_variable m_signal;
+  std::atomic<bool> m_signalled;
+  bool m_wake_pending; // m_signal_mutex was held when the workers were woken, so they may have missed it. Only used by the calling thread
+  bool m_quit;
+  std::atomic<int> m_latecnt, m_dropcnt;
+};
+
+#endif // WDL_CONVO_THREAD
+
+
 #endif
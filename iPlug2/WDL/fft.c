@@ -1086,6 +1086,28 @@ void WDL_fft(WDL_FFT_COMPLEX *buf, int len, int isInverse)
   }
 }
 
+static const WDL_FFT_COMPLEX *real_fft_tw(int len)
+{
+  switch (len)
+  {
+#define TMP(x) case x: return d##x;
+    TMP(16)
+    TMP(32)
+    TMP(64)
+    TMP(128)
+    TMP(256)
+    TMP(512)
+    TMP(1024)
+    TMP(2048)
+    TMP(4096)
+    TMP(8192)
+    TMP(16384)
+    TMP(32768)
+#undef TMP
+  }
+  return 0;
+}
+
 static inline void r2(register WDL_FFT_REAL *a)
 {
   register WDL_FFT_REAL t1, t2;
@@ -1106,7 +1128,8 @@ static inline void v2(register WDL_FFT_REAL *a)
   a[1] = t2;
 }
 
-static void two_for_one(WDL_FFT_REAL* buf, const WDL_FFT_COMPLEX *d, int len, int isInverse)
+/* splits (forward) or joins (inverse) the half size complex transform of a real transform, after r2() or before v2() */
+static void two_for_one_tw(WDL_FFT_REAL* buf, const WDL_FFT_COMPLEX *d, int len, int isInverse)
 {
   const unsigned int half = (unsigned)len >> 1, quart = half >> 1, eighth = quart >> 1;
   const int *permute = WDL_fft_permute_tab(half);
@@ -1115,16 +1138,6 @@ static void two_for_one(WDL_FFT_REAL* buf, const WDL_FFT_COMPLEX *d, int len, in
   WDL_FFT_COMPLEX *p, *q, tw, sum, diff;
   WDL_FFT_REAL tw1, tw2;
 
-  if (!isInverse)
-  {
-  	WDL_fft((WDL_FFT_COMPLEX*)buf, half, isInverse);
-  	r2(buf);
-  }
-  else
-  {
-  	v2(buf);
-  }
-
   /* Source: http://www.katjaas.nl/realFFT/realFFT2.html */
 
   for (i = 1; i < quart; ++i)
@@ -1171,6 +1184,23 @@ static void two_for_one(WDL_FFT_REAL* buf, const WDL_FFT_COMPLEX *d, int len, in
   p = (WDL_FFT_COMPLEX*)buf + permute[i];
   p->re *=  2;
   p->im *= -2;
+}
+
+static void two_for_one(WDL_FFT_REAL* buf, const WDL_FFT_COMPLEX *d, int len, int isInverse)
+{
+  const int half = len >> 1;
+
+  if (!isInverse)
+  {
+  	WDL_fft((WDL_FFT_COMPLEX*)buf, half, isInverse);
+  	r2(buf);
+  }
+  else
+  {
+  	v2(buf);
+  }
+
+  two_for_one_tw(buf, d, len, isInverse);
 
   if (isInverse) WDL_fft((WDL_FFT_COMPLEX*)buf, half, isInverse);
 }
@@ -1197,3 +1227,372 @@ void WDL_real_fft(WDL_FFT_REAL* buf, int len, int isInverse)
 #undef TMP
   }
 }
+
+
+/* batched transforms: radix-4 Stockham (autosorting, so no bit reversal pass),
+   with one channel per SIMD lane */
+
+#include <stdlib.h>
+#include <string.h>
+
+#if !defined(WDL_FFT_NO_SSE) && !defined(WDL_FFT_USE_SSE)
+  #if defined(__SSE2__) || _M_IX86_FP >= 2 || defined(_M_X64)
+    #define WDL_FFT_USE_SSE
+  #endif
+#endif
+
+#if defined(WDL_FFT_USE_SSE) && WDL_FFT_REALSIZE == 4
+  #include <xmmintrin.h>
+  typedef __m128 fftv;
+  #define FFTV_LANES 4
+  #define fftv_add(a,b) _mm_add_ps(a,b)
+  #define fftv_sub(a,b) _mm_sub_ps(a,b)
+  #define fftv_mul(a,b) _mm_mul_ps(a,b)
+  #define fftv_set1(a) _mm_set1_ps(a)
+#elif defined(WDL_FFT_USE_SSE) && WDL_FFT_REALSIZE == 8
+  #include <emmintrin.h>
+  typedef __m128d fftv;
+  #define FFTV_LANES 2
+  #define fftv_add(a,b) _mm_add_pd(a,b)
+  #define fftv_sub(a,b) _mm_sub_pd(a,b)
+  #define fftv_mul(a,b) _mm_mul_pd(a,b)
+  #define fftv_set1(a) _mm_set1_pd(a)
+#else
+  typedef WDL_FFT_REAL fftv;
+  #define FFTV_LANES 1
+  #define fftv_add(a,b) ((a)+(b))
+  #define fftv_sub(a,b) ((a)-(b))
+  #define fftv_mul(a,b) ((a)*(b))
+  #define fftv_set1(a) (a)
+#endif
+
+struct WDL_fft_plan
+{
+  int len;
+  WDL_FFT_REAL *tw_re, *tw_im; /* exp(-2*PI*i*k/len), k < len*3/4 */
+  int *perm; /* WDL_fft_permute(len) order, or NULL */
+  fftv *work[4]; /* x.re, x.im, y.re, y.im */
+  void *mem;
+};
+
+WDL_fft_plan *WDL_fft_plan_create(int len)
+{
+  WDL_fft_plan *plan;
+  size_t sz;
+  char *p;
+  int x, ntw;
+
+  if (len < 2 || len > WDL_FFT_PLAN_MAXSIZE || (len & (len-1))) return NULL;
+
+  WDL_fft_init(); /* for the sizes that use WDL_fft() */
+
+  plan = (WDL_fft_plan *)calloc(1,sizeof(WDL_fft_plan));
+  if (!plan) return NULL;
+
+  ntw = len < 4 ? 1 : len*3/4;
+  sz = 64 + 4*(size_t)len*sizeof(fftv) + 2*(size_t)ntw*sizeof(WDL_FFT_REAL) + (size_t)len*sizeof(int);
+  plan->mem = malloc(sz);
+  if (!plan->mem)
+  {
+    free(plan);
+    return NULL;
+  }
+
+  p = (char *)plan->mem;
+  p += (64 - ((size_t)p & 63)) & 63;
+  for (x = 0; x < 4; x ++)
+  {
+    plan->work[x] = (fftv *)p;
+    p += (size_t)len*sizeof(fftv);
+  }
+  plan->tw_re = (WDL_FFT_REAL *)p;
+  p += (size_t)ntw*sizeof(WDL_FFT_REAL);
+  plan->tw_im = (WDL_FFT_REAL *)p;
+  p += (size_t)ntw*sizeof(WDL_FFT_REAL);
+
+  plan->len = len;
+  for (x = 0; x < ntw; x ++)
+  {
+    plan->tw_re[x] = (WDL_FFT_REAL) cos(2.0*PI*x/len);
+    plan->tw_im[x] = (WDL_FFT_REAL) -sin(2.0*PI*x/len);
+  }
+
+#ifndef WDL_FFT_NO_PERMUTE
+  plan->perm = (int *)p;
+  plan->perm[0] = 0;
+  for (x = 1; x < len; x ++) plan->perm[len - fftfreq_c(x,len)] = x;
+#endif
+
+  return plan;
+}
+
+void WDL_fft_plan_destroy(WDL_fft_plan *plan)
+{
+  if (plan)
+  {
+    free(plan->mem);
+    free(plan);
+  }
+}
+
+int WDL_fft_plan_size(const WDL_fft_plan *plan)
+{
+  return plan ? plan->len : 0;
+}
+
+int WDL_fft_batch_lanes(void)
+{
+  return FFTV_LANES;
+}
+
+/* WDL_fft() on each channel is faster than the batch with fewer than 4 lanes (double), at every size it supports.
+   With 4 lanes it is also faster at 32768, where each Stockham pass streams the full buffers through cache,
+   unless the batch can skip the permutation (split) */
+static int fft_batch_use_scalar(int len, int split)
+{
+#if FFTV_LANES < 4
+  (void)split;
+  return len <= 32768;
+#else
+  return !split && len == 32768;
+#endif
+}
+
+/* transforms work[0..1] in place (using work[2..3]) */
+static void fft_batch_exec(WDL_fft_plan *plan, int isInverse)
+{
+  fftv *xr = plan->work[0], *xi = plan->work[1], *yr = plan->work[2], *yi = plan->work[3], *t;
+  const WDL_FFT_REAL *twr = plan->tw_re, *twi = plan->tw_im;
+  const WDL_FFT_REAL tsign = isInverse ? (WDL_FFT_REAL)-1.0 : (WDL_FFT_REAL)1.0;
+  const int len = plan->len;
+  int n = len, s = 1, p, q;
+
+  while (n >= 4)
+  {
+    const int n1 = n >> 2;
+    for (p = 0; p < n1; p ++)
+    {
+      const fftv w1r = fftv_set1(twr[p*s]), w1i = fftv_set1(tsign*twi[p*s]);
+      const fftv w2r = fftv_set1(twr[2*p*s]), w2i = fftv_set1(tsign*twi[2*p*s]);
+      const fftv w3r = fftv_set1(twr[3*p*s]), w3i = fftv_set1(tsign*twi[3*p*s]);
+      const int i0 = s*p, i1 = s*(p+n1), i2 = s*(p+2*n1), i3 = s*(p+3*n1), o = s*4*p;
+
+      for (q = 0; q < s; q ++)
+      {
+        const fftv apcr = fftv_add(xr[i0+q],xr[i2+q]), apci = fftv_add(xi[i0+q],xi[i2+q]);
+        const fftv amcr = fftv_sub(xr[i0+q],xr[i2+q]), amci = fftv_sub(xi[i0+q],xi[i2+q]);
+        const fftv bpdr = fftv_add(xr[i1+q],xr[i3+q]), bpdi = fftv_add(xi[i1+q],xi[i3+q]);
+        fftv jbmdr, jbmdi, r, i;
+
+        /* j*(b-d) forward, -j*(b-d) inverse */
+        if (!isInverse)
+        {
+          jbmdr = fftv_sub(xi[i3+q],xi[i1+q]);
+          jbmdi = fftv_sub(xr[i1+q],xr[i3+q]);
+        }
+        else
+        {
+          jbmdr = fftv_sub(xi[i1+q],xi[i3+q]);
+          jbmdi = fftv_sub(xr[i3+q],xr[i1+q]);
+        }
+
+        yr[o+q] = fftv_add(apcr,bpdr);
+        yi[o+q] = fftv_add(apci,bpdi);
+
+        r = fftv_sub(amcr,jbmdr);
+        i = fftv_sub(amci,jbmdi);
+        yr[o+s+q] = fftv_sub(fftv_mul(w1r,r),fftv_mul(w1i,i));
+        yi[o+s+q] = fftv_add(fftv_mul(w1r,i),fftv_mul(w1i,r));
+
+        r = fftv_sub(apcr,bpdr);
+        i = fftv_sub(apci,bpdi);
+        yr[o+2*s+q] = fftv_sub(fftv_mul(w2r,r),fftv_mul(w2i,i));
+        yi[o+2*s+q] = fftv_add(fftv_mul(w2r,i),fftv_mul(w2i,r));
+
+        r = fftv_add(amcr,jbmdr);
+        i = fftv_add(amci,jbmdi);
+        yr[o+3*s+q] = fftv_sub(fftv_mul(w3r,r),fftv_mul(w3i,i));
+        yi[o+3*s+q] = fftv_add(fftv_mul(w3r,i),fftv_mul(w3i,r));
+      }
+    }
+
+    t = xr; xr = yr; yr = t;
+    t = xi; xi = yi; yi = t;
+    n >>= 2;
+    s <<= 2;
+  }
+
+  if (n == 2)
+  {
+    for (q = 0; q < s; q ++)
+    {
+      yr[q] = fftv_add(xr[q],xr[s+q]);
+      yi[q] = fftv_add(xi[q],xi[s+q]);
+      yr[s+q] = fftv_sub(xr[q],xr[s+q]);
+      yi[s+q] = fftv_sub(xi[q],xi[s+q]);
+    }
+    t = xr; xr = yr; yr = t;
+    t = xi; xi = yi; yi = t;
+  }
+
+  if (xr != plan->work[0])
+  {
+    /* an odd number of passes leaves the result in work[2..3] */
+    plan->work[2] = plan->work[0];
+    plan->work[3] = plan->work[1];
+    plan->work[0] = xr;
+    plan->work[1] = xi;
+  }
+}
+
+void WDL_fft_batch(WDL_fft_plan *plan, WDL_FFT_COMPLEX **buf, int nch, int isInverse)
+{
+  const int *perm;
+  int len, c, k, ch;
+
+  if (!plan) return;
+  len = plan->len;
+  perm = plan->perm;
+
+  if (fft_batch_use_scalar(len,0))
+  {
+    for (ch = 0; ch < nch; ch ++) WDL_fft(buf[ch],len,isInverse);
+    return;
+  }
+
+  for (c = 0; c < nch; c += FFTV_LANES)
+  {
+    const int nl = nch-c < FFTV_LANES ? nch-c : FFTV_LANES;
+    WDL_FFT_REAL *xr = (WDL_FFT_REAL *)plan->work[0], *xi = (WDL_FFT_REAL *)plan->work[1];
+
+    if (nl < FFTV_LANES)
+    {
+      memset(xr,0,len*sizeof(fftv));
+      memset(xi,0,len*sizeof(fftv));
+    }
+
+    for (ch = 0; ch < nl; ch ++)
+    {
+      const WDL_FFT_COMPLEX *in = buf[c+ch];
+      if (isInverse && perm)
+        for (k = 0; k < len; k ++) { xr[k*FFTV_LANES+ch] = in[perm[k]].re; xi[k*FFTV_LANES+ch] = in[perm[k]].im; }
+      else
+        for (k = 0; k < len; k ++) { xr[k*FFTV_LANES+ch] = in[k].re; xi[k*FFTV_LANES+ch] = in[k].im; }
+    }
+
+    fft_batch_exec(plan,isInverse);
+
+    xr = (WDL_FFT_REAL *)plan->work[0];
+    xi = (WDL_FFT_REAL *)plan->work[1];
+    for (ch = 0; ch < nl; ch ++)
+    {
+      WDL_FFT_COMPLEX *out = buf[c+ch];
+      if (!isInverse && perm)
+        for (k = 0; k < len; k ++) { out[perm[k]].re = xr[k*FFTV_LANES+ch]; out[perm[k]].im = xi[k*FFTV_LANES+ch]; }
+      else
+        for (k = 0; k < len; k ++) { out[k].re = xr[k*FFTV_LANES+ch]; out[k].im = xi[k*FFTV_LANES+ch]; }
+    }
+  }
+}
+
+void WDL_fft_batch_split(WDL_fft_plan *plan, WDL_FFT_REAL **re, WDL_FFT_REAL **im, int nch, int isInverse)
+{
+  int len, c, k, ch;
+
+  if (!plan) return;
+  len = plan->len;
+
+  if (fft_batch_use_scalar(len,1))
+  {
+    /* work[0] holds len complex values, since fftv is at least 2 reals wide whenever this is used */
+    const int *perm = plan->perm;
+    WDL_FFT_COMPLEX *z = (WDL_FFT_COMPLEX *)plan->work[0];
+    for (ch = 0; ch < nch; ch ++)
+    {
+      WDL_FFT_REAL *r = re[ch], *i = im[ch];
+      if (isInverse && perm)
+        for (k = 0; k < len; k ++) { z[perm[k]].re = r[k]; z[perm[k]].im = i[k]; }
+      else
+        for (k = 0; k < len; k ++) { z[k].re = r[k]; z[k].im = i[k]; }
+
+      WDL_fft(z,len,isInverse);
+
+      if (!isInverse && perm)
+        for (k = 0; k < len; k ++) { r[k] = z[perm[k]].re; i[k] = z[perm[k]].im; }
+      else
+        for (k = 0; k < len; k ++) { r[k] = z[k].re; i[k] = z[k].im; }
+    }
+    return;
+  }
+
+  for (c = 0; c < nch; c += FFTV_LANES)
+  {
+    const int nl = nch-c < FFTV_LANES ? nch-c : FFTV_LANES;
+    WDL_FFT_REAL *xr = (WDL_FFT_REAL *)plan->work[0], *xi = (WDL_FFT_REAL *)plan->work[1];
+
+    if (nl < FFTV_LANES)
+    {
+      memset(xr,0,len*sizeof(fftv));
+      memset(xi,0,len*sizeof(fftv));
+    }
+
+    for (ch = 0; ch < nl; ch ++)
+    {
+      const WDL_FFT_REAL *inr = re[c+ch], *ini = im[c+ch];
+      for (k = 0; k < len; k ++) { xr[k*FFTV_LANES+ch] = inr[k]; xi[k*FFTV_LANES+ch] = ini[k]; }
+    }
+
+    fft_batch_exec(plan,isInverse);
+
+    xr = (WDL_FFT_REAL *)plan->work[0];
+    xi = (WDL_FFT_REAL *)plan->work[1];
+    for (ch = 0; ch < nl; ch ++)
+    {
+      WDL_FFT_REAL *outr = re[c+ch], *outi = im[c+ch];
+      for (k = 0; k < len; k ++) { outr[k] = xr[k*FFTV_LANES+ch]; outi[k] = xi[k*FFTV_LANES+ch]; }
+    }
+  }
+}
+
+void WDL_real_fft_batch(WDL_fft_plan *plan, WDL_FFT_REAL **buf, int nch, int isInverse)
+{
+  WDL_FFT_COMPLEX *cbuf[FFTV_LANES];
+  const WDL_FFT_COMPLEX *d;
+  int len, c, ch;
+
+  if (!plan || plan->len > 16384) return;
+  len = plan->len*2;
+
+  /* the split/join pass is per channel, which outweighs the batch gain from a real size of 16384 */
+  if (fft_batch_use_scalar(plan->len,0) || len >= 16384)
+  {
+    for (ch = 0; ch < nch; ch ++) WDL_real_fft(buf[ch],len,isInverse);
+    return;
+  }
+
+  d = real_fft_tw(len);
+  for (c = 0; c < nch; c += FFTV_LANES)
+  {
+    const int nl = nch-c < FFTV_LANES ? nch-c : FFTV_LANES;
+    for (ch = 0; ch < nl; ch ++) cbuf[ch] = (WDL_FFT_COMPLEX *)buf[c+ch];
+
+    if (!isInverse)
+    {
+      WDL_fft_batch(plan,cbuf,nl,0);
+      for (ch = 0; ch < nl; ch ++)
+      {
+        r2(buf[c+ch]);
+        two_for_one_tw(buf[c+ch],d,len,0);
+      }
+    }
+    else
+    {
+      for (ch = 0; ch < nl; ch ++)
+      {
+        v2(buf[c+ch]);
+        two_for_one_tw(buf[c+ch],d,len,1);
+      }
+      WDL_fft_batch(plan,cbuf,nl,1);
+    }
+  }
+}
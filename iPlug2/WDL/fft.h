@@ -70,6 +70,44 @@ extern void WDL_real_fft(WDL_FFT_REAL *, int len, int isInverse);
 extern int WDL_fft_permute(int fftsize, int idx);
 extern int *WDL_fft_permute_tab(int fftsize);
 
+
+/* Batched complex FFTs, which transform several channels of the same size
+in one call. The channels are processed WDL_fft_batch_lanes() at a time, with
+their samples interleaved so that each SIMD lane holds one channel, which
+makes every butterfly one vector operation.
+
+A plan holds the twiddles, permutation and work buffers for one size (a power
+of 2, 2..WDL_FFT_PLAN_MAXSIZE), so it should not be used by two threads at
+once. Transforms are unscaled, with the same sign convention as WDL_fft().
+
+Where the batch is slower than WDL_fft() on each channel, these call WDL_fft()
+instead: for double (WDL_FFT_REALSIZE 8, 2 lanes) at every size up to 32768,
+for float at 32768 except in WDL_fft_batch_split(), and for real transforms of
+16384 or more. See fft_test.c. */
+
+#define WDL_FFT_PLAN_MAXSIZE 65536
+
+typedef struct WDL_fft_plan WDL_fft_plan;
+
+extern WDL_fft_plan *WDL_fft_plan_create(int len); /* returns NULL if len is not supported */
+extern void WDL_fft_plan_destroy(WDL_fft_plan *plan);
+extern int WDL_fft_plan_size(const WDL_fft_plan *plan);
+extern int WDL_fft_batch_lanes(void);
+
+/* Same input and output order as WDL_fft(), so a forward transform returns
+buf[c][0..len-1] ordered by WDL_fft_permute(len), and an inverse transform
+expects that order. For len > 32768 the permutation extends WDL_fft_permute()
+in the same way. If WDL_FFT_NO_PERMUTE is defined, the order is natural. */
+extern void WDL_fft_batch(WDL_fft_plan *plan, WDL_FFT_COMPLEX **buf, int nch, int isInverse);
+
+/* Split complex input and output re[c][0..len-1], im[c][0..len-1], both in
+natural order, which skips the permutation. */
+extern void WDL_fft_batch_split(WDL_fft_plan *plan, WDL_FFT_REAL **re, WDL_FFT_REAL **im, int nch, int isInverse);
+
+/* Same as WDL_real_fft(buf[c], len, isInverse) on each channel, with the same packed
+input and output order, for len = 2*WDL_fft_plan_size(plan), up to 32768. */
+extern void WDL_real_fft_batch(WDL_fft_plan *plan, WDL_FFT_REAL **buf, int nch, int isInverse);
+
 #ifdef __cplusplus
 };
 #endif
@@ -0,0 +1,235 @@
+/*
+  test and benchmark the batched FFTs against WDL_fft() and WDL_real_fft()
+
+  gcc -O2 fft_test.c fft.c -lm -o fft_test
+  gcc -O2 -DWDL_FFT_REALSIZE=8 fft_test.c fft.c -lm -o fft_test_double
+  gcc -O2 -DWDL_FFT_NO_SSE fft_test.c fft.c -lm -o fft_test_nosse
+
+  returns 0 if all batched transforms match
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "fft.h"
+
+#define NCH 6
+#define BENCH_NCH 8
+
+static double rnd(void)
+{
+  return rand() / (double) RAND_MAX - 0.5;
+}
+
+static double tolerance(int len)
+{
+  return (WDL_FFT_REALSIZE == 4 ? 1e-5 : 1e-12) * sqrt((double) len) * log((double) len + 1.0);
+}
+
+static int test_complex(int len, int isInverse)
+{
+  WDL_fft_plan *plan = WDL_fft_plan_create(len);
+  WDL_FFT_COMPLEX *ref[NCH], *buf[NCH];
+  double maxdiff = 0.0;
+  int c, k;
+
+  for (c = 0; c < NCH; c ++)
+  {
+    ref[c] = (WDL_FFT_COMPLEX *) malloc(len * sizeof(WDL_FFT_COMPLEX));
+    buf[c] = (WDL_FFT_COMPLEX *) malloc(len * sizeof(WDL_FFT_COMPLEX));
+    for (k = 0; k < len; k ++) { ref[c][k].re = rnd(); ref[c][k].im = rnd(); }
+    memcpy(buf[c], ref[c], len * sizeof(WDL_FFT_COMPLEX));
+    WDL_fft(ref[c], len, isInverse);
+  }
+
+  WDL_fft_batch(plan, buf, NCH, isInverse);
+
+  for (c = 0; c < NCH; c ++)
+  {
+    for (k = 0; k < len; k ++)
+    {
+      maxdiff = fmax(maxdiff, fabs(ref[c][k].re - buf[c][k].re));
+      maxdiff = fmax(maxdiff, fabs(ref[c][k].im - buf[c][k].im));
+    }
+    free(ref[c]);
+    free(buf[c]);
+  }
+  WDL_fft_plan_destroy(plan);
+
+  if (maxdiff > tolerance(len))
+  {
+    printf("FAIL WDL_fft_batch len %d %s: max diff %g\n", len, isInverse ? "inverse" : "forward", maxdiff);
+    return 1;
+  }
+  return 0;
+}
+
+static int test_split(int len)
+{
+  WDL_fft_plan *plan = WDL_fft_plan_create(len);
+  WDL_FFT_REAL *re[NCH], *im[NCH], *orig = (WDL_FFT_REAL *) malloc(len * sizeof(WDL_FFT_REAL));
+  WDL_FFT_COMPLEX *ref = (WDL_FFT_COMPLEX *) malloc(len * sizeof(WDL_FFT_COMPLEX));
+  double maxdiff = 0.0, roundtrip = 0.0;
+  int c, k, errors = 0;
+
+  for (c = 0; c < NCH; c ++)
+  {
+    re[c] = (WDL_FFT_REAL *) malloc(len * sizeof(WDL_FFT_REAL));
+    im[c] = (WDL_FFT_REAL *) malloc(len * sizeof(WDL_FFT_REAL));
+    for (k = 0; k < len; k ++) { re[c][k] = rnd(); im[c][k] = rnd(); }
+  }
+  memcpy(orig, re[0], len * sizeof(WDL_FFT_REAL));
+  for (k = 0; k < len; k ++) { ref[k].re = re[1][k]; ref[k].im = im[1][k]; }
+
+  WDL_fft_batch_split(plan, re, im, NCH, 0);
+
+  /* natural order output, against WDL_fft()'s permuted order */
+  if (len <= 32768)
+  {
+    WDL_fft(ref, len, 0);
+    for (k = 0; k < len; k ++)
+    {
+      const int p = WDL_fft_permute(len, k);
+      maxdiff = fmax(maxdiff, fabs(ref[p].re - re[1][k]));
+      maxdiff = fmax(maxdiff, fabs(ref[p].im - im[1][k]));
+    }
+  }
+
+  WDL_fft_batch_split(plan, re, im, NCH, 1);
+  for (k = 0; k < len; k ++) roundtrip = fmax(roundtrip, fabs(re[0][k] / len - orig[k]));
+
+  if (maxdiff > tolerance(len) || roundtrip > tolerance(len) / len * 4.0)
+  {
+    printf("FAIL WDL_fft_batch_split len %d: max diff %g, roundtrip error %g\n", len, maxdiff, roundtrip);
+    errors++;
+  }
+
+  for (c = 0; c < NCH; c ++) { free(re[c]); free(im[c]); }
+  free(orig);
+  free(ref);
+  WDL_fft_plan_destroy(plan);
+  return errors;
+}
+
+static int test_real(int len, int isInverse)
+{
+  WDL_fft_plan *plan = WDL_fft_plan_create(len / 2);
+  WDL_FFT_REAL *ref[NCH], *buf[NCH];
+  double maxdiff = 0.0;
+  int c, k;
+
+  for (c = 0; c < NCH; c ++)
+  {
+    ref[c] = (WDL_FFT_REAL *) malloc(len * sizeof(WDL_FFT_REAL));
+    buf[c] = (WDL_FFT_REAL *) malloc(len * sizeof(WDL_FFT_REAL));
+    for (k = 0; k < len; k ++) ref[c][k] = rnd();
+    memcpy(buf[c], ref[c], len * sizeof(WDL_FFT_REAL));
+    WDL_real_fft(ref[c], len, isInverse);
+  }
+
+  WDL_real_fft_batch(plan, buf, NCH, isInverse);
+
+  for (c = 0; c < NCH; c ++)
+  {
+    for (k = 0; k < len; k ++) maxdiff = fmax(maxdiff, fabs(ref[c][k] - buf[c][k]));
+    free(ref[c]);
+    free(buf[c]);
+  }
+  WDL_fft_plan_destroy(plan);
+
+  if (maxdiff > tolerance(len) * 2.0)
+  {
+    printf("FAIL WDL_real_fft_batch len %d %s: max diff %g\n", len, isInverse ? "inverse" : "forward", maxdiff);
+    return 1;
+  }
+  return 0;
+}
+
+static double us_per_call(clock_t start, int iters)
+{
+  return (double) (clock() - start) / CLOCKS_PER_SEC / iters * 1e6;
+}
+
+static void bench(int len)
+{
+  WDL_fft_plan *plan = WDL_fft_plan_create(len), *rplan = len <= 32768 ? WDL_fft_plan_create(len / 2) : NULL;
+  WDL_FFT_COMPLEX *buf[BENCH_NCH];
+  WDL_FFT_REAL *re[BENCH_NCH], *im[BENCH_NCH];
+  double t_loop = 0.0, t_batch, t_split, t_rloop = 0.0, t_rbatch = 0.0;
+  int iters = (1 << 24) / len / BENCH_NCH, c, i;
+  clock_t start;
+
+  if (iters < 4) iters = 4;
+
+  for (c = 0; c < BENCH_NCH; c ++)
+  {
+    buf[c] = (WDL_FFT_COMPLEX *) calloc(len, sizeof(WDL_FFT_COMPLEX));
+    re[c] = (WDL_FFT_REAL *) calloc(len, sizeof(WDL_FFT_REAL));
+    im[c] = (WDL_FFT_REAL *) calloc(len, sizeof(WDL_FFT_REAL));
+    buf[c][1].re = re[c][1] = 1.0;
+  }
+
+  /* alternate directions, so that the values stay bounded */
+  if (len <= 32768)
+  {
+    start = clock();
+    for (i = 0; i < iters; i ++) for (c = 0; c < BENCH_NCH; c ++) WDL_fft(buf[c], len, i & 1);
+    t_loop = us_per_call(start, iters);
+
+    start = clock();
+    for (i = 0; i < iters; i ++) for (c = 0; c < BENCH_NCH; c ++) WDL_real_fft(re[c], len, i & 1);
+    t_rloop = us_per_call(start, iters);
+
+    start = clock();
+    for (i = 0; i < iters; i ++) WDL_real_fft_batch(rplan, re, BENCH_NCH, i & 1);
+    t_rbatch = us_per_call(start, iters);
+  }
+
+  start = clock();
+  for (i = 0; i < iters; i ++) WDL_fft_batch(plan, buf, BENCH_NCH, i & 1);
+  t_batch = us_per_call(start, iters);
+
+  start = clock();
+  for (i = 0; i < iters; i ++) WDL_fft_batch_split(plan, re, im, BENCH_NCH, i & 1);
+  t_split = us_per_call(start, iters);
+
+  if (len <= 32768)
+    printf("%6d: WDL_fft %8.1f, batch %8.1f, split %8.1f | WDL_real_fft %8.1f, real batch %8.1f\n", len, t_loop, t_batch, t_split, t_rloop, t_rbatch);
+  else
+    printf("%6d: WDL_fft      n/a, batch %8.1f, split %8.1f | WDL_real_fft      n/a, real batch      n/a\n", len, t_batch, t_split);
+
+  for (c = 0; c < BENCH_NCH; c ++) { free(buf[c]); free(re[c]); free(im[c]); }
+  WDL_fft_plan_destroy(plan);
+  WDL_fft_plan_destroy(rplan);
+}
+
+int main(int argc, char **argv)
+{
+  int len, errors = 0;
+
+  WDL_fft_init();
+  srand(1);
+
+  for (len = 2; len <= 32768; len *= 2)
+  {
+    errors += test_complex(len, 0);
+    errors += test_complex(len, 1);
+  }
+  for (len = 4; len <= WDL_FFT_PLAN_MAXSIZE; len *= 2) errors += test_split(len);
+  for (len = 4; len <= 32768; len *= 2)
+  {
+    errors += test_real(len, 0);
+    errors += test_real(len, 1);
+  }
+  printf("%d errors\n", errors);
+
+  if (argc < 2 || strcmp(argv[1], "-nobench"))
+  {
+    printf("\n%d channels, %d lanes, us per call:\n", BENCH_NCH, WDL_fft_batch_lanes());
+    for (len = 64; len <= WDL_FFT_PLAN_MAXSIZE; len *= 2) bench(len);
+  }
+
+  return errors ? 1 : 0;
+}
@@ -297,4 +297,325 @@ private:
 };
 
 
+
+#if !defined(WDL_VERB_NO_SSE) && !defined(WDL_VERB_USE_SSE)
+  #if defined(__SSE2__) || _M_IX86_FP >= 2 || defined(_M_X64)
+    #define WDL_VERB_USE_SSE
+  #endif
+#endif
+
+#ifdef WDL_VERB_USE_SSE
+  #include <xmmintrin.h>
+#endif
+
+// WDL_ReverbEngine in single precision, for running many instances. Sounds the same as WDL_ReverbEngine::ProcessSampleBlock()
+// to within float precision. The combs of both channels are processed side by side, one per SSE lane, and each filter processes
+// a block of samples at a time rather than one sample: a block shorter than a filter's delay only reads samples written before the block,
+// so only the comb's damping filter has to run sample by sample. Input and output may be the same buffers.
+// The SSE path is only used on x86/x64 with SSE2. Other targets, including ARM (no NEON path), and builds with WDL_VERB_NO_SSE,
+// get the scalar version of the same algorithm, which still gains from the block processing but not from the lanes.
+// See verbengine_test.cpp for a comparison against WDL_ReverbEngine.
+class WDL_ReverbEngine_SIMD
+{
+public:
+  WDL_ReverbEngine_SIMD()
+  {
+    m_srate=44100.0;
+    m_roomsize=0.5;
+    m_damp=0.5;
+    memset(m_comb_size,0,sizeof(m_comb_size));
+    memset(m_ap_size,0,sizeof(m_ap_size));
+    SetWidth(1.0);
+    Reset(false);
+  }
+  ~WDL_ReverbEngine_SIMD()
+  {
+  }
+  void SetSampleRate(double srate)
+  {
+    if (m_srate!=srate)
+    {
+      m_srate=srate;
+      Reset(true);
+    }
+  }
+
+  void ProcessSampleBlock(const double *spl0, const double *spl1, double *outp0, double *outp1, int ns) { ProcessBlockT(spl0,spl1,outp0,outp1,ns); }
+  void ProcessSampleBlock(const float *spl0, const float *spl1, float *outp0, float *outp1, int ns) { ProcessBlockT(spl0,spl1,outp0,outp1,ns); }
+
+  void Reset(bool doclear=false) // call this after changing roomsize or dampening
+  {
+    int x, ch;
+    const double sc=m_srate / 44100.0;
+    bool resized=false;
+
+    for (ch = 0; ch < 2; ch ++)
+    {
+      for (x = 0; x < NCOMBS; x ++)
+      {
+        int size=(int) ((wdl_verb__combtunings[x] + (ch ? wdl_verb__stereospread : 0)) * sc);
+        if (size<1) size=1;
+        if (m_comb_size[ch*NCOMBS+x]!=size) resized=true;
+        m_comb_size[ch*NCOMBS+x]=size;
+      }
+      for (x = 0; x < NALLPASSES; x ++)
+      {
+        int size=(int) ((wdl_verb__allpasstunings[x] + (ch ? wdl_verb__stereospread : 0)) * sc);
+        if (size<1) size=1;
+        if (m_ap_size[ch][x]!=size) resized=true;
+        m_ap_size[ch][x]=size;
+      }
+    }
+
+    if (resized)
+    {
+      int tot=0;
+      for (x = 0; x < NLANES; x ++) { m_comb_offs[x]=tot; tot+=m_comb_size[x]; }
+      m_combbuf.Resize(tot,false);
+
+      tot=0;
+      for (ch = 0; ch < 2; ch ++)
+        for (x = 0; x < NALLPASSES; x ++) { m_ap_offs[ch][x]=tot; tot+=m_ap_size[ch][x]; }
+      m_apbuf.Resize(tot,false);
+    }
+
+    if (resized || doclear)
+    {
+      memset(m_combbuf.Get(),0,m_combbuf.GetSize()*sizeof(float));
+      memset(m_apbuf.Get(),0,m_apbuf.GetSize()*sizeof(float));
+      memset(m_comb_pos,0,sizeof(m_comb_pos));
+      memset(m_comb_fs,0,sizeof(m_comb_fs));
+      memset(m_ap_pos,0,sizeof(m_ap_pos));
+    }
+
+    m_comb_feedback=(float) m_roomsize;
+    m_comb_damp=(float) (m_damp*0.4);
+  }
+
+  void SetRoomSize(double sz) { m_roomsize=sz;; } // 0.3..0.99 or so
+  void SetDampening(double dmp) { m_damp=dmp; } // 0..1
+  void SetWidth(double wid) 
+  {  
+    if (wid<-1) wid=-1; 
+    else if (wid>1) wid=1; 
+    wid*=0.5;
+    if (wid>=0.0) wid+=0.5;
+    else wid-=0.5;
+    m_wid=wid;
+  } // -1..1
+
+private:
+  enum
+  {
+    NCOMBS=sizeof(wdl_verb__combtunings)/sizeof(wdl_verb__combtunings[0]),
+    NALLPASSES=sizeof(wdl_verb__allpasstunings)/sizeof(wdl_verb__allpasstunings[0]),
+    NLANES=NCOMBS*2, // combs of the left channel, then of the right channel
+    BLOCKSIZE=256
+  };
+  typedef char lanes_fill_sse_registers[NLANES%4 ? -1 : 1];
+
+  template<class T> void ProcessBlockT(const T *spl0, const T *spl1, T *outp0, T *outp1, int ns)
+  {
+#ifdef WDL_VERB_USE_SSE
+    const unsigned int csr=_mm_getcsr();
+    _mm_setcsr(csr|0x8040); // flush denormals to zero, rather than filtering each state variable
+#endif
+    float *in0=m_work[0], *in1=m_work[1], *out0=m_work[2], *out1=m_work[3];
+    while (ns>0)
+    {
+      const int n=ns<BLOCKSIZE ? ns : BLOCKSIZE;
+      int i;
+      for (i = 0; i < n; i ++)
+      {
+        in0[i]=(float)spl0[i];
+        in1[i]=(float)spl1[i];
+      }
+      memset(out0,0,n*sizeof(float));
+      memset(out1,0,n*sizeof(float));
+
+      ProcessCombs(n);
+      ProcessAllpasses(out0,0,n);
+      ProcessAllpasses(out1,1,n);
+
+      const double m=m_wid<0 ? -m_wid : m_wid;
+      for (i = 0; i < n; i ++)
+      {
+        const double a=out0[i]*0.015, b=out1[i]*0.015;
+        if (m_wid<0)
+        {
+          outp0[i] = (T) (b*m + a*(1.0-m));
+          outp1[i] = (T) (a*m + b*(1.0-m));
+        }
+        else
+        {
+          outp0[i] = (T) (a*m + b*(1.0-m));
+          outp1[i] = (T) (b*m + a*(1.0-m));
+        }
+      }
+
+      spl0+=n;
+      spl1+=n;
+      outp0+=n;
+      outp1+=n;
+      ns-=n;
+    }
+#ifdef WDL_VERB_USE_SSE
+    _mm_setcsr(csr);
+#endif
+  }
+
+  // adds the output of the combs to m_work[2] and m_work[3], for input in m_work[0] and m_work[1]
+  void ProcessCombs(int n)
+  {
+    int done=0;
+    while (done<n)
+    {
+      // process up to the first delay line wraparound
+      int len=n-done, x;
+      for (x = 0; x < NLANES; x ++)
+        if (m_comb_size[x]-m_comb_pos[x] < len) len=m_comb_size[x]-m_comb_pos[x];
+
+      ProcessCombChunk(done,len);
+
+      for (x = 0; x < NLANES; x ++)
+        if ((m_comb_pos[x]+=len) >= m_comb_size[x]) m_comb_pos[x]=0;
+      done+=len;
+    }
+  }
+
+  void ProcessCombChunk(int offs, int len)
+  {
+    const float damp=m_comb_damp, damp1=1.0f-m_comb_damp, feedback=m_comb_feedback;
+    float *bufs[NLANES];
+    int x, i=0;
+    for (x = 0; x < NLANES; x ++) bufs[x]=m_combbuf.Get()+m_comb_offs[x]+m_comb_pos[x];
+    const float *in0=m_work[0]+offs, *in1=m_work[1]+offs;
+    float *out0=m_work[2]+offs, *out1=m_work[3]+offs;
+
+#ifdef WDL_VERB_USE_SSE
+    const __m128 vdamp=_mm_set1_ps(damp), vdamp1=_mm_set1_ps(damp1), vfeedback=_mm_set1_ps(feedback);
+    __m128 fs[NLANES/4];
+    for (x = 0; x < NLANES/4; x ++) fs[x]=_mm_loadu_ps(m_comb_fs+x*4);
+
+    // the groups of 4 lanes are interleaved, so that their damping filters run in parallel
+    for (; i+4 <= len; i += 4)
+    {
+      __m128 s0=_mm_setzero_ps(), s1=_mm_setzero_ps(), in[2][4];
+      for (x = 0; x < 4; x ++)
+      {
+        in[0][x]=_mm_set1_ps(in0[i+x]);
+        in[1][x]=_mm_set1_ps(in1[i+x]);
+      }
+
+      for (int g = 0; g < NLANES/4; g ++)
+      {
+        // 4 samples of each lane's delay line, which are also the comb outputs
+        float **b=bufs+g*4;
+        __m128 r0=_mm_loadu_ps(b[0]+i), r1=_mm_loadu_ps(b[1]+i), r2=_mm_loadu_ps(b[2]+i), r3=_mm_loadu_ps(b[3]+i);
+
+        if (g*4 < NCOMBS) s0=_mm_add_ps(s0,r0); else s1=_mm_add_ps(s1,r0);
+        if (g*4+1 < NCOMBS) s0=_mm_add_ps(s0,r1); else s1=_mm_add_ps(s1,r1);
+        if (g*4+2 < NCOMBS) s0=_mm_add_ps(s0,r2); else s1=_mm_add_ps(s1,r2);
+        if (g*4+3 < NCOMBS) s0=_mm_add_ps(s0,r3); else s1=_mm_add_ps(s1,r3);
+
+        // one sample of each lane per register
+        _MM_TRANSPOSE4_PS(r0,r1,r2,r3);
+
+        __m128 inp[4];
+        if (g*4+3 < NCOMBS) { for (x = 0; x < 4; x ++) inp[x]=in[0][x]; }
+        else if (g*4 >= NCOMBS) { for (x = 0; x < 4; x ++) inp[x]=in[1][x]; }
+        else
+        {
+          const __m128 left=_mm_set_ps(g*4+3 < NCOMBS ? 1.0f : 0.0f, g*4+2 < NCOMBS ? 1.0f : 0.0f, g*4+1 < NCOMBS ? 1.0f : 0.0f, 1.0f);
+          const __m128 lmask=_mm_cmpeq_ps(left,_mm_set1_ps(1.0f));
+          for (x = 0; x < 4; x ++) inp[x]=_mm_or_ps(_mm_and_ps(lmask,in[0][x]),_mm_andnot_ps(lmask,in[1][x]));
+        }
+
+        __m128 f=fs[g];
+        f=_mm_add_ps(_mm_mul_ps(r0,vdamp1),_mm_mul_ps(f,vdamp)); r0=_mm_add_ps(inp[0],_mm_mul_ps(f,vfeedback));
+        f=_mm_add_ps(_mm_mul_ps(r1,vdamp1),_mm_mul_ps(f,vdamp)); r1=_mm_add_ps(inp[1],_mm_mul_ps(f,vfeedback));
+        f=_mm_add_ps(_mm_mul_ps(r2,vdamp1),_mm_mul_ps(f,vdamp)); r2=_mm_add_ps(inp[2],_mm_mul_ps(f,vfeedback));
+        f=_mm_add_ps(_mm_mul_ps(r3,vdamp1),_mm_mul_ps(f,vdamp)); r3=_mm_add_ps(inp[3],_mm_mul_ps(f,vfeedback));
+        fs[g]=f;
+
+        _MM_TRANSPOSE4_PS(r0,r1,r2,r3);
+        _mm_storeu_ps(b[0]+i,r0);
+        _mm_storeu_ps(b[1]+i,r1);
+        _mm_storeu_ps(b[2]+i,r2);
+        _mm_storeu_ps(b[3]+i,r3);
+      }
+
+      _mm_storeu_ps(out0+i,_mm_add_ps(_mm_loadu_ps(out0+i),s0));
+      _mm_storeu_ps(out1+i,_mm_add_ps(_mm_loadu_ps(out1+i),s1));
+    }
+
+    for (x = 0; x < NLANES/4; x ++) _mm_storeu_ps(m_comb_fs+x*4,fs[x]);
+#endif
+
+    for (x = 0; x < NLANES; x ++)
+    {
+      const float *in=x < NCOMBS ? in0 : in1;
+      float *out=x < NCOMBS ? out0 : out1;
+      float *buf=bufs[x];
+      float fsx=m_comb_fs[x];
+      for (int j = i; j < len; j ++)
+      {
+        const float output=buf[j];
+        out[j]+=output;
+        fsx=denormal_filter_float((output*damp1) + (fsx*damp));
+        buf[j]=in[j] + (fsx*feedback);
+      }
+      m_comb_fs[x]=fsx;
+    }
+  }
+
+  void ProcessAllpasses(float *io, int ch, int n)
+  {
+    for (int x = 0; x < NALLPASSES; x ++)
+    {
+      float *buf=m_apbuf.Get()+m_ap_offs[ch][x];
+      const int size=m_ap_size[ch][x];
+      int pos=m_ap_pos[ch][x], done=0;
+      while (done<n)
+      {
+        const int len=n-done < size-pos ? n-done : size-pos;
+        float *b=buf+pos, *p=io+done;
+        int i=0;
+#ifdef WDL_VERB_USE_SSE
+        const __m128 feedback=_mm_set1_ps(0.5f);
+        for (; i+4 <= len; i += 4)
+        {
+          const __m128 bufout=_mm_loadu_ps(b+i), inp=_mm_loadu_ps(p+i);
+          _mm_storeu_ps(p+i,_mm_sub_ps(bufout,inp));
+          _mm_storeu_ps(b+i,_mm_add_ps(inp,_mm_mul_ps(bufout,feedback)));
+        }
+#endif
+        for (; i < len; i ++)
+        {
+          const float bufout=b[i], inp=p[i];
+          p[i]=bufout - inp;
+          b[i]=denormal_filter_float(inp + (bufout*0.5f));
+        }
+        if ((pos+=len) >= size) pos=0;
+        done+=len;
+      }
+      m_ap_pos[ch][x]=pos;
+    }
+  }
+
+  double m_wid;
+  double m_roomsize;
+  double m_damp;
+  double m_srate;
+
+  float m_comb_feedback, m_comb_damp;
+  float m_comb_fs[NLANES]; // damping filter state
+  int m_comb_offs[NLANES], m_comb_size[NLANES], m_comb_pos[NLANES];
+  int m_ap_offs[2][NALLPASSES], m_ap_size[2][NALLPASSES], m_ap_pos[2][NALLPASSES];
+  WDL_TypedBuf<float> m_combbuf; // all comb delay lines
+  WDL_TypedBuf<float> m_apbuf; // all allpass delay lines
+  float m_work[4][BLOCKSIZE]; // input and output of each channel
+};
+
+
 #endif
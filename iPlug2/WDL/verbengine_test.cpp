@@ -0,0 +1,94 @@
+/*
+  test WDL_ReverbEngine_SIMD against WDL_ReverbEngine
+
+  g++ -O2 verbengine_test.cpp -o verbengine_test
+  g++ -O2 -DWDL_VERB_NO_SSE verbengine_test.cpp -o verbengine_test_nosse
+
+  returns 0 if the outputs match to within float precision
+*/
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include "verbengine.h"
+
+#define MAX_DIFF 1e-5
+
+static double test(double srate, int blocksize, bool use_float)
+{
+  const int len=(int) srate * 4;
+  WDL_TypedBuf<double> in0, in1, ref0, ref1, out0, out1;
+  WDL_TypedBuf<float> fbuf;
+  in0.Resize(len); in1.Resize(len); ref0.Resize(len); ref1.Resize(len); out0.Resize(len); out1.Resize(len);
+  float *f0=fbuf.Resize(len*4), *f1=f0+len, *fo0=f1+len, *fo1=fo0+len;
+
+  // bursts of noise and a sine, with silence between them for the tail
+  unsigned int seed=1;
+  int x;
+  for (x = 0; x < len; x ++)
+  {
+    const double env = (x % (int) srate) < srate/10 ? 1.0 : 0.0;
+    seed = seed*1664525 + 1013904223;
+    in0.Get()[x] = env * ((seed>>8) / (double) (1<<24) - 0.5);
+    in1.Get()[x] = env * sin(x * 0.05);
+    f0[x] = (float) in0.Get()[x];
+    f1[x] = (float) in1.Get()[x];
+  }
+
+  WDL_ReverbEngine ref;
+  WDL_ReverbEngine_SIMD simd;
+  ref.SetSampleRate(srate); simd.SetSampleRate(srate);
+  ref.SetRoomSize(0.9); simd.SetRoomSize(0.9);
+  ref.SetDampening(0.3); simd.SetDampening(0.3);
+  ref.SetWidth(0.7); simd.SetWidth(0.7);
+  ref.Reset(true); simd.Reset(true);
+
+  for (x = 0; x < len; x += blocksize)
+  {
+    const int n = len-x < blocksize ? len-x : blocksize;
+    ref.ProcessSampleBlock(in0.Get()+x,in1.Get()+x,ref0.Get()+x,ref1.Get()+x,n);
+    if (use_float) simd.ProcessSampleBlock(f0+x,f1+x,fo0+x,fo1+x,n);
+    else simd.ProcessSampleBlock(in0.Get()+x,in1.Get()+x,out0.Get()+x,out1.Get()+x,n);
+  }
+
+  double maxdiff=0.0;
+  for (x = 0; x < len; x ++)
+  {
+    const double d0 = fabs(ref0.Get()[x] - (use_float ? fo0[x] : out0.Get()[x]));
+    const double d1 = fabs(ref1.Get()[x] - (use_float ? fo1[x] : out1.Get()[x]));
+    if (d0 > maxdiff) maxdiff=d0;
+    if (d1 > maxdiff) maxdiff=d1;
+  }
+  return maxdiff;
+}
+
+int main(int argc, char **argv)
+{
+  static const double srates[] = { 22050.0, 44100.0, 96000.0 };
+  static const int blocksizes[] = { 1, 7, 64, 512 };
+  int errors=0;
+
+#ifdef WDL_VERB_USE_SSE
+  printf("WDL_ReverbEngine_SIMD with SSE\n");
+#else
+  printf("WDL_ReverbEngine_SIMD without SSE\n");
+#endif
+
+  for (int s = 0; s < (int) (sizeof(srates)/sizeof(srates[0])); s ++)
+  {
+    for (int b = 0; b < (int) (sizeof(blocksizes)/sizeof(blocksizes[0])); b ++)
+    {
+      for (int f = 0; f < 2; f ++)
+      {
+        const double d = test(srates[s],blocksizes[b],f==1);
+        const bool ok = d <= MAX_DIFF;
+        if (!ok) errors++;
+        printf("%s %gHz, %d sample blocks, %s: max diff %g\n",ok ? "ok  " : "FAIL",srates[s],blocksizes[b],f ? "float" : "double",d);
+      }
+    }
+  }
+
+  printf("%d errors\n",errors);
+  return errors ? 1 : 0;
+}